@@ -0,0 +1,135 @@
+#include <sqlite_containers/KeyDB.hpp>
+#include <sqlite_containers/KeyValueDB.hpp>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <map>
+#include <set>
+
+// Compares the per-row write loop (bind, execute, reset, clear_bindings for every element)
+// with the multi-row bulk path used by append() and reconcile().
+// Usage: bench-append [rows]
+
+template<typename Func>
+double measure_rows_per_sec(std::size_t rows, Func func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto stop = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(stop - start).count();
+    return seconds > 0 ? static_cast<double>(rows) / seconds : 0.0;
+}
+
+void print_result(const std::string& name, double per_row, double bulk) {
+    std::cout << std::left << std::setw(28) << name
+              << std::right << std::setw(14) << std::fixed << std::setprecision(0) << per_row
+              << std::setw(14) << bulk
+              << std::setw(10) << std::setprecision(2) << (per_row > 0 ? bulk / per_row : 0.0) << "x"
+              << std::endl;
+}
+
+// Opens a separate connection used by the per-row baseline.
+sqlite3* open_baseline_db(const std::string& path) {
+    sqlite3* sqlite_db = nullptr;
+    if (sqlite3_open_v2(path.c_str(), &sqlite_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) {
+        throw sqlite_containers::sqlite_exception("Cannot open baseline database.");
+    }
+    sqlite_containers::execute(sqlite_db, "PRAGMA journal_mode = WAL;");
+    sqlite_containers::execute(sqlite_db, "PRAGMA synchronous = NORMAL;");
+    return sqlite_db;
+}
+
+// Writes rows one by one in a single transaction, as db_append() did before the bulk path.
+template<typename ContainerT, typename BindFunc>
+void per_row_loop(sqlite3* sqlite_db, const std::string& query, const ContainerT& container, BindFunc bind_row) {
+    sqlite_containers::SqliteStmt stmt(sqlite_db, query);
+    sqlite_containers::execute(sqlite_db, "BEGIN IMMEDIATE TRANSACTION");
+    for (const auto& item : container) {
+        bind_row(stmt, item);
+        stmt.execute();
+        stmt.reset();
+        stmt.clear_bindings();
+    }
+    sqlite_containers::execute(sqlite_db, "COMMIT");
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t rows = argc > 1 ? std::stoul(argv[1]) : 100000;
+    try {
+        sqlite_containers::Config config;
+        config.db_path = "bench-append.db";
+        config.journal_mode = sqlite_containers::JournalMode::WAL;
+        config.synchronous = sqlite_containers::SynchronousMode::NORMAL;
+
+        std::map<int64_t, std::string> map_data;
+        std::set<int64_t> set_data;
+        for (std::size_t i = 0; i < rows; ++i) {
+            map_data.emplace(static_cast<int64_t>(i), "value" + std::to_string(i));
+            set_data.insert(static_cast<int64_t>(i));
+        }
+
+        std::cout << "rows: " << rows << std::endl;
+        std::cout << std::left << std::setw(28) << "operation"
+                  << std::right << std::setw(14) << "per-row/s"
+                  << std::setw(14) << "bulk/s"
+                  << std::setw(11) << "speedup" << std::endl;
+
+        {
+            config.table_name = "bench_kv";
+            sqlite_containers::KeyValueDB<int64_t, std::string> kv_db(config);
+            kv_db.connect();
+
+            kv_db.clear();
+            sqlite3* baseline_db = open_baseline_db(config.db_path);
+            const double per_row = measure_rows_per_sec(rows, [&] {
+                per_row_loop(baseline_db, "REPLACE INTO bench_kv (key, value) VALUES (?, ?);", map_data,
+                        [](sqlite_containers::SqliteStmt& stmt, const std::pair<const int64_t, std::string>& pair) {
+                    stmt.bind_value<int64_t>(1, pair.first);
+                    stmt.bind_value<std::string>(2, pair.second);
+                });
+            });
+            sqlite3_close_v2(baseline_db);
+
+            kv_db.clear();
+            const double bulk = measure_rows_per_sec(rows, [&] {
+                kv_db.append(map_data, sqlite_containers::TransactionMode::IMMEDIATE);
+            });
+            print_result("KeyValueDB append", per_row, bulk);
+
+            const double reconcile = measure_rows_per_sec(rows, [&] {
+                kv_db.reconcile(map_data, sqlite_containers::TransactionMode::IMMEDIATE);
+            });
+            print_result("KeyValueDB reconcile", per_row, reconcile);
+        }
+
+        {
+            config.table_name = "bench_keys";
+            sqlite_containers::KeyDB<int64_t> key_db(config);
+            key_db.connect();
+
+            key_db.clear();
+            sqlite3* baseline_db = open_baseline_db(config.db_path);
+            const double per_row = measure_rows_per_sec(rows, [&] {
+                per_row_loop(baseline_db, "REPLACE INTO bench_keys (key) VALUES (?);", set_data,
+                        [](sqlite_containers::SqliteStmt& stmt, const int64_t& key) {
+                    stmt.bind_value<int64_t>(1, key);
+                });
+            });
+            sqlite3_close_v2(baseline_db);
+
+            key_db.clear();
+            const double bulk = measure_rows_per_sec(rows, [&] {
+                key_db.append(set_data, sqlite_containers::TransactionMode::IMMEDIATE);
+            });
+            print_result("KeyDB append", per_row, bulk);
+
+            const double reconcile = measure_rows_per_sec(rows, [&] {
+                key_db.reconcile(set_data, sqlite_containers::TransactionMode::IMMEDIATE);
+            });
+            print_result("KeyDB reconcile", per_row, reconcile);
+        }
+    } catch (const sqlite_containers::sqlite_exception& e) {
+        std::cerr << "SQLite error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,442 @@
+#include <sqlite_containers/KeyDB.hpp>
+#include <sqlite_containers/KeyValueDB.hpp>
+#include <sqlite_containers/KeyMultiValueDB.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Measures insert, find, remove, append, load, reconcile and count of KeyDB, KeyValueDB and KeyMultiValueDB
+// for several key/value types, dataset sizes and journal/synchronous mode combinations.
+// Usage: bench-containers [--json] [--sizes 1000,10000,...] [--journal DELETE,WAL,...] [--sync OFF,NORMAL,...]
+//                         [--types int,string,pod,blob] [--containers key,kv,kmv] [--path bench.db]
+// The default sweep is small enough for a quick run; pass e.g. --sizes 1000,100000,1000000,10000000 for the full one.
+// With --json the results are printed as one JSON document, for comparison between releases.
+
+// Trivially copyable structure stored as a BLOB.
+struct BenchStruct {
+    int64_t id;
+    double  weight;
+    int32_t flags[4];
+
+    bool operator<(const BenchStruct& other) const {
+        return id < other.id;
+    }
+};
+
+using Blob = std::vector<uint8_t>;
+
+// Keys and values derived from a row number, spread so that they are not inserted in table order.
+inline uint64_t scramble(std::size_t i) {
+    return (static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ull) >> 16;
+}
+
+template<typename T> T make_item(std::size_t i);
+
+template<> int64_t make_item<int64_t>(std::size_t i) {
+    return static_cast<int64_t>(scramble(i));
+}
+
+template<> std::string make_item<std::string>(std::size_t i) {
+    return "item-" + std::to_string(scramble(i));
+}
+
+template<> BenchStruct make_item<BenchStruct>(std::size_t i) {
+    BenchStruct item;
+    item.id = static_cast<int64_t>(scramble(i));
+    item.weight = static_cast<double>(i) * 0.5;
+    for (int j = 0; j < 4; ++j) item.flags[j] = static_cast<int32_t>(i + j);
+    return item;
+}
+
+template<> Blob make_item<Blob>(std::size_t i) {
+    Blob item(64);
+    const uint64_t seed = scramble(i);
+    std::memcpy(item.data(), &seed, sizeof(seed));
+    for (std::size_t j = sizeof(seed); j < item.size(); ++j) item[j] = static_cast<uint8_t>(i + j);
+    return item;
+}
+
+struct Options {
+    bool json = false;
+    std::vector<std::size_t> sizes = {1000, 10000, 100000};
+    std::vector<sqlite_containers::JournalMode> journal_modes = {sqlite_containers::JournalMode::DELETE_MODE, sqlite_containers::JournalMode::WAL};
+    std::vector<sqlite_containers::SynchronousMode> sync_modes = {sqlite_containers::SynchronousMode::NORMAL, sqlite_containers::SynchronousMode::FULL};
+    std::vector<std::string> types = {"int", "string", "pod", "blob"};
+    std::vector<std::string> containers = {"key", "kv", "kmv"};
+    std::string path = "bench-containers.db";
+};
+
+struct Record {
+    std::string container;
+    std::string type;
+    std::string journal;
+    std::string sync;
+    std::size_t rows;
+    std::string operation;
+    std::size_t ops;
+    double      seconds;
+};
+
+template<typename Func>
+double measure_seconds(Func func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+// Collects the results of one configuration.
+class Recorder {
+public:
+    Recorder(std::vector<Record>& records, const Options& options, Record base) :
+        m_records(records), m_options(options), m_base(std::move(base)) {}
+
+    template<typename Func>
+    void run(const std::string& operation, std::size_t ops, Func func) {
+        Record record = m_base;
+        record.operation = operation;
+        record.ops = ops;
+        record.seconds = measure_seconds(func);
+        if (!m_options.json) print(record);
+        m_records.push_back(record);
+    }
+
+    static void print_header() {
+        std::cout << std::left << std::setw(8) << "db" << std::setw(8) << "type" << std::setw(10) << "journal"
+                  << std::setw(8) << "sync" << std::right << std::setw(10) << "rows" << "  "
+                  << std::left << std::setw(11) << "operation" << std::right << std::setw(14) << "ops/s"
+                  << std::setw(12) << "seconds" << std::endl;
+    }
+
+private:
+    std::vector<Record>& m_records;
+    const Options&       m_options;
+    Record               m_base;
+
+    static void print(const Record& record) {
+        const double rate = record.seconds > 0 ? static_cast<double>(record.ops) / record.seconds : 0.0;
+        std::cout << std::left << std::setw(8) << record.container << std::setw(8) << record.type
+                  << std::setw(10) << record.journal << std::setw(8) << record.sync
+                  << std::right << std::setw(10) << record.rows << "  "
+                  << std::left << std::setw(11) << record.operation
+                  << std::right << std::setw(14) << std::fixed << std::setprecision(0) << rate
+                  << std::setw(12) << std::setprecision(4) << record.seconds << std::endl;
+    }
+};
+
+// Reconcile input: every tenth row dropped and every third row changed.
+template<typename KeyT, typename ValueT>
+std::map<KeyT, ValueT> make_reconcile_map(std::size_t rows) {
+    std::map<KeyT, ValueT> data;
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (i % 10 == 9) continue;
+        data.emplace(make_item<KeyT>(i), make_item<ValueT>(i % 3 == 0 ? i + rows : i));
+    }
+    return data;
+}
+
+template<typename T>
+void bench_key_db(const sqlite_containers::Config& config, std::size_t rows, Recorder& recorder) {
+    using namespace sqlite_containers;
+    KeyDB<T> db(config);
+    db.connect();
+    db.clear();
+    std::vector<T> keys;
+    keys.reserve(rows);
+    for (std::size_t i = 0; i < rows; ++i) keys.push_back(make_item<T>(i));
+    std::set<T> data(keys.begin(), keys.end());
+    std::set<T> reconciled;
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (i % 10 != 9) reconciled.insert(keys[i]);
+    }
+
+    recorder.run("insert", rows, [&] {
+        db.begin(TransactionMode::IMMEDIATE);
+        for (const auto& key : keys) db.insert(key);
+        db.commit();
+    });
+    recorder.run("find", rows, [&] {
+        std::size_t found = 0;
+        for (const auto& key : keys) found += db.find(key) ? 1 : 0;
+        if (found != data.size()) throw sqlite_exception("KeyDB lost keys.");
+    });
+    recorder.run("count", 100, [&] {
+        for (int i = 0; i < 100; ++i) db.count();
+    });
+    recorder.run("load", rows, [&] {
+        std::set<T> loaded;
+        db.load(loaded);
+    });
+    recorder.run("reconcile", rows, [&] {
+        db.reconcile(reconciled, TransactionMode::IMMEDIATE);
+    });
+    db.clear();
+    recorder.run("append", rows, [&] {
+        db.append(data, TransactionMode::IMMEDIATE);
+    });
+    recorder.run("remove", rows, [&] {
+        db.begin(TransactionMode::IMMEDIATE);
+        for (const auto& key : keys) db.remove(key);
+        db.commit();
+    });
+    db.disconnect();
+}
+
+template<typename T>
+void bench_key_value_db(const sqlite_containers::Config& config, std::size_t rows, Recorder& recorder) {
+    using namespace sqlite_containers;
+    KeyValueDB<T, T> db(config);
+    db.connect();
+    db.clear();
+    std::vector<std::pair<T, T>> pairs;
+    pairs.reserve(rows);
+    for (std::size_t i = 0; i < rows; ++i) pairs.emplace_back(make_item<T>(i), make_item<T>(i + 1));
+    std::map<T, T> data(pairs.begin(), pairs.end());
+    const std::map<T, T> reconciled = make_reconcile_map<T, T>(rows);
+
+    recorder.run("insert", rows, [&] {
+        db.begin(TransactionMode::IMMEDIATE);
+        for (const auto& pair : pairs) db.insert(pair.first, pair.second);
+        db.commit();
+    });
+    recorder.run("find", rows, [&] {
+        std::size_t found = 0;
+        T value;
+        for (const auto& pair : pairs) found += db.find(pair.first, value) ? 1 : 0;
+        if (found != pairs.size()) throw sqlite_exception("KeyValueDB lost pairs.");
+    });
+    recorder.run("count", 100, [&] {
+        for (int i = 0; i < 100; ++i) db.count();
+    });
+    recorder.run("load", rows, [&] {
+        std::map<T, T> loaded;
+        db.load(loaded);
+    });
+    recorder.run("reconcile", rows, [&] {
+        db.reconcile(reconciled, TransactionMode::IMMEDIATE);
+    });
+    db.clear();
+    recorder.run("append", rows, [&] {
+        db.append(data, TransactionMode::IMMEDIATE);
+    });
+    recorder.run("remove", rows, [&] {
+        db.begin(TransactionMode::IMMEDIATE);
+        for (const auto& pair : pairs) db.remove(pair.first);
+        db.commit();
+    });
+    db.disconnect();
+}
+
+template<typename T>
+void bench_key_multi_value_db(const sqlite_containers::Config& config, std::size_t rows, Recorder& recorder) {
+    using namespace sqlite_containers;
+    KeyMultiValueDB<T, T> db(config);
+    db.connect();
+    db.clear();
+    // Four values per key
+    const std::size_t key_count = std::max<std::size_t>(rows / 4, 1);
+    std::vector<std::pair<T, T>> pairs;
+    pairs.reserve(rows);
+    for (std::size_t i = 0; i < rows; ++i) pairs.emplace_back(make_item<T>(i % key_count), make_item<T>(i));
+    std::multimap<T, T> data(pairs.begin(), pairs.end());
+    std::multimap<T, T> reconciled;
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (i % 10 != 9) reconciled.emplace(pairs[i]);
+    }
+
+    recorder.run("insert", rows, [&] {
+        db.begin(TransactionMode::IMMEDIATE);
+        for (const auto& pair : pairs) db.insert(pair.first, pair.second);
+        db.commit();
+    });
+    recorder.run("find", key_count, [&] {
+        std::vector<T> values;
+        for (std::size_t i = 0; i < key_count; ++i) {
+            values.clear();
+            db.find(pairs[i].first, values);
+        }
+    });
+    recorder.run("count", 100, [&] {
+        for (int i = 0; i < 100; ++i) db.count();
+    });
+    recorder.run("load", rows, [&] {
+        std::multimap<T, T> loaded;
+        db.load(loaded);
+    });
+    recorder.run("reconcile", rows, [&] {
+        db.reconcile(reconciled, TransactionMode::IMMEDIATE);
+    });
+    db.clear();
+    recorder.run("append", rows, [&] {
+        db.append(data, TransactionMode::IMMEDIATE);
+    });
+    recorder.run("remove", key_count, [&] {
+        db.begin(TransactionMode::IMMEDIATE);
+        for (std::size_t i = 0; i < key_count; ++i) db.remove(pairs[i].first);
+        db.commit();
+    });
+    db.disconnect();
+}
+
+template<typename T>
+void bench_type(const Options& options, const sqlite_containers::Config& config, std::size_t rows, Record base, std::vector<Record>& records) {
+    for (const auto& container : options.containers) {
+        base.container = container;
+        Recorder recorder(records, options, base);
+        sqlite_containers::Config table_config = config;
+        table_config.table_name = "bench_" + container + "_" + base.type;
+        if (container == "key") {
+            bench_key_db<T>(table_config, rows, recorder);
+        } else
+        if (container == "kv") {
+            bench_key_value_db<T>(table_config, rows, recorder);
+        } else
+        if (container == "kmv") {
+            bench_key_multi_value_db<T>(table_config, rows, recorder);
+        }
+    }
+}
+
+std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::string to_upper(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return text;
+}
+
+template<typename EnumT>
+std::vector<EnumT> parse_modes(const std::string& text, int mode_count) {
+    std::vector<EnumT> modes;
+    for (const auto& name : split_list(text)) {
+        bool found = false;
+        for (int i = 0; i < mode_count; ++i) {
+            if (sqlite_containers::to_string(static_cast<EnumT>(i)) == to_upper(name)) {
+                modes.push_back(static_cast<EnumT>(i));
+                found = true;
+            }
+        }
+        if (!found) throw std::invalid_argument("Unknown mode: " + name);
+    }
+    return modes;
+}
+
+Options parse_options(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--json") {
+            options.json = true;
+            continue;
+        }
+        if (i + 1 >= argc) throw std::invalid_argument("Missing value of " + arg);
+        const std::string value = argv[++i];
+        if (arg == "--sizes") {
+            options.sizes.clear();
+            for (const auto& size : split_list(value)) options.sizes.push_back(std::stoul(size));
+        } else
+        if (arg == "--journal") {
+            options.journal_modes = parse_modes<sqlite_containers::JournalMode>(value, 6);
+        } else
+        if (arg == "--sync") {
+            options.sync_modes = parse_modes<sqlite_containers::SynchronousMode>(value, 4);
+        } else
+        if (arg == "--types") {
+            options.types = split_list(value);
+        } else
+        if (arg == "--containers") {
+            options.containers = split_list(value);
+        } else
+        if (arg == "--path") {
+            options.path = value;
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    return options;
+}
+
+void print_json(const std::vector<Record>& records) {
+    std::cout << "{\n  \"sqlite_version\": \"" << sqlite3_libversion() << "\",\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const Record& record = records[i];
+        const double rate = record.seconds > 0 ? static_cast<double>(record.ops) / record.seconds : 0.0;
+        std::cout << "    {\"container\": \"" << record.container << "\", \"type\": \"" << record.type
+                  << "\", \"journal_mode\": \"" << record.journal << "\", \"synchronous\": \"" << record.sync
+                  << "\", \"rows\": " << record.rows << ", \"operation\": \"" << record.operation
+                  << "\", \"ops\": " << record.ops << ", \"seconds\": " << std::setprecision(9) << record.seconds
+                  << ", \"ops_per_sec\": " << std::fixed << std::setprecision(1) << rate << std::defaultfloat << "}"
+                  << (i + 1 < records.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n}" << std::endl;
+}
+
+void remove_database(const std::string& path) {
+    for (const char* suffix : {"", "-wal", "-shm", "-journal"}) {
+        std::remove((path + suffix).c_str());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        const Options options = parse_options(argc, argv);
+        std::vector<Record> records;
+        if (!options.json) Recorder::print_header();
+        for (const auto& journal_mode : options.journal_modes) {
+            for (const auto& sync_mode : options.sync_modes) {
+                for (const auto& rows : options.sizes) {
+                    remove_database(options.path);
+                    sqlite_containers::Config config;
+                    config.db_path = options.path;
+                    config.journal_mode = journal_mode;
+                    config.synchronous = sync_mode;
+                    Record base;
+                    base.journal = sqlite_containers::to_string(journal_mode);
+                    base.sync = sqlite_containers::to_string(sync_mode);
+                    base.rows = rows;
+                    for (const auto& type : options.types) {
+                        base.type = type;
+                        if (type == "int") {
+                            bench_type<int64_t>(options, config, rows, base, records);
+                        } else
+                        if (type == "string") {
+                            bench_type<std::string>(options, config, rows, base, records);
+                        } else
+                        if (type == "pod") {
+                            bench_type<BenchStruct>(options, config, rows, base, records);
+                        } else
+                        if (type == "blob") {
+                            bench_type<Blob>(options, config, rows, base, records);
+                        } else {
+                            throw std::invalid_argument("Unknown type: " + type);
+                        }
+                    }
+                }
+            }
+        }
+        remove_database(options.path);
+        if (options.json) print_json(records);
+    } catch (const sqlite_containers::sqlite_exception& e) {
+        std::cerr << "SQLite error: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
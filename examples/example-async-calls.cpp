@@ -0,0 +1,47 @@
+#include <sqlite_containers/KeyValueDB.hpp>
+#include <iostream>
+#include <vector>
+
+int main() {
+    try {
+        sqlite_containers::Config config;
+        config.db_path = "example-async-calls.db";
+        config.journal_mode = sqlite_containers::JournalMode::WAL;
+        config.async_pipeline_size = 128;
+
+        sqlite_containers::KeyValueDB<int, std::string> map_db(config);
+        map_db.connect();
+        map_db.async_clear().get();
+
+        // The calls return at once and run in order on the I/O thread of the container;
+        // inserts queued together are committed in shared transactions
+        std::vector<sqlite_containers::AsyncResult<void>> writes;
+        for (int i = 0; i < 1000; ++i) {
+            writes.push_back(map_db.async_insert(i, "value" + std::to_string(i)));
+        }
+
+        // Submitted after the inserts, so it sees all of them
+        auto count = map_db.async_count();
+        auto value = map_db.async_find(999);
+
+        for (auto& write : writes) {
+            write.get();
+        }
+        std::cout << "count: " << count.get() << std::endl;
+        if (auto found = value.get()) {
+            std::cout << "Found value for key 999: " << *found << std::endl;
+        }
+
+        // Any blocking method can be run on the I/O thread as well
+        auto all = map_db.async_call([&map_db] {
+            return map_db.retrieve_all<std::map>();
+        });
+        std::cout << "retrieved: " << all.get().size() << std::endl;
+
+        map_db.disconnect();
+    } catch (const sqlite_containers::sqlite_exception& e) {
+        std::cerr << "SQLite error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
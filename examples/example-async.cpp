@@ -0,0 +1,46 @@
+#include <sqlite_containers/KeyValueDB.hpp>
+#include <iostream>
+#include <map>
+
+int main() {
+    try {
+        // Create a configuration with asynchronous writes enabled
+        sqlite_containers::Config config;
+        config.db_path = "example-async.db";
+        config.journal_mode = sqlite_containers::JournalMode::WAL;
+        config.use_async = true;
+        config.async_batch_size = 512;
+
+        sqlite_containers::KeyValueDB<int, std::string> map_db(config);
+        map_db.connect();
+        map_db.clear();
+
+        // Inserts are queued and committed by the background writer in batches
+        for (int i = 0; i < 10000; ++i) {
+            map_db.insert(i, "value" + std::to_string(i));
+        }
+
+        // Wait until every queued write is committed
+        map_db.flush();
+        std::cout << "count after flush: " << map_db.count() << std::endl;
+
+        // Removals are queued as well
+        for (int i = 0; i < 10000; i += 2) {
+            map_db.remove(i);
+        }
+        map_db.flush();
+        std::cout << "count after removing even keys: " << map_db.count() << std::endl;
+
+        std::string value;
+        if (map_db.find(9999, value)) {
+            std::cout << "Found value for key 9999: " << value << std::endl;
+        }
+
+        // Disconnect commits anything still in the queue
+        map_db.disconnect();
+    } catch (const sqlite_containers::sqlite_exception& e) {
+        std::cerr << "SQLite error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <sqlite_containers/KeyValueDB.hpp>
+#include <sqlite_containers/KeyMultiValueDB.hpp>
+#include <iostream>
+#include <map>
+
+int main() {
+    try {
+        sqlite_containers::Config config;
+        config.db_path = "example-cursor.db";
+
+        sqlite_containers::KeyValueDB<int, std::string> map_db(config);
+        map_db.connect();
+        map_db.clear();
+
+        std::map<int, std::string> data;
+        for (int i = 0; i < 1000; ++i) {
+            data.emplace(i, "value" + std::to_string(i));
+        }
+        map_db.append(data, sqlite_containers::TransactionMode::IMMEDIATE);
+
+        // Stream rows one by one instead of loading the whole table into a container
+        std::size_t total_length = 0;
+        {
+            auto cursor = map_db.cursor();
+            for (const auto& [key, value] : cursor) {
+                total_length += value.size();
+            }
+        } // The cursor releases the database here
+        std::cout << "Total length of all values: " << total_length << std::endl;
+
+        // A visitor returning false stops the iteration early
+        map_db.for_each([](const int& key, const std::string& value) {
+            std::cout << "Key: " << key << ", Value: " << value << std::endl;
+            return key < 2;
+        });
+
+        config.table_name = "cursor_multimap";
+        sqlite_containers::KeyMultiValueDB<int, std::string> multimap_db(config);
+        multimap_db.connect();
+        multimap_db.clear();
+        multimap_db.insert(1, "a");
+        multimap_db.insert(1, "a");
+        multimap_db.insert(2, "b");
+
+        multimap_db.for_each([](const int& key, const std::string& value, std::size_t value_count) {
+            std::cout << "Key: " << key << ", Value: " << value << ", Count: " << value_count << std::endl;
+        });
+    } catch (const sqlite_containers::sqlite_exception& e) {
+        std::cerr << "SQLite error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
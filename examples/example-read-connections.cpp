@@ -0,0 +1,40 @@
+#include <sqlite_containers/KeyValueDB.hpp>
+#include <iostream>
+#include <map>
+
+int main() {
+    try {
+        // Reads are served by read-only connections in WAL mode, while single-row writes share group commits
+        sqlite_containers::Config config;
+        config.db_path = "example-read-connections.db";
+        config.journal_mode = sqlite_containers::JournalMode::WAL;
+        config.read_connections = 4;
+        config.group_commit = true;
+        config.group_commit_latency_ms = 1000;
+
+        sqlite_containers::KeyValueDB<int, std::string> map_db(config);
+        map_db.connect();
+        map_db.clear();
+
+        // The write is held by the open group commit, so the reads below use the main connection
+        map_db.insert(1, "one");
+        std::string value;
+        if (!map_db.find(1, value) || map_db.count() != 1) {
+            std::cerr << "The pending write is not visible" << std::endl;
+            return 1;
+        }
+        std::cout << "Found value before the commit: " << value << std::endl;
+
+        // Once the group is committed, the reads go back to the read-only connections
+        map_db.flush();
+        std::map<int, std::string> pairs;
+        map_db.load(pairs);
+        std::cout << "pairs after flush: " << pairs.size() << std::endl;
+
+        map_db.disconnect();
+    } catch (const sqlite_containers::sqlite_exception& e) {
+        std::cerr << "SQLite error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <sqlite_containers/KeyValueDB.hpp>
+#include <filesystem>
+#include <iostream>
+#include <map>
+
+int main() {
+    try {
+        // An in-memory container is saved to disk with a snapshot and a backup
+        sqlite_containers::Config config;
+        config.in_memory = true;
+
+        sqlite_containers::KeyValueDB<int, std::string> map_db(config);
+        map_db.connect();
+        for (int i = 0; i < 100; ++i) {
+            map_db.insert(i, "value " + std::to_string(i));
+        }
+
+        // The parent directories of the target files are created if they do not exist
+        std::filesystem::remove_all("example-snapshot");
+        map_db.snapshot_to("example-snapshot/snapshots/data.db");
+        map_db.backup_to("example-snapshot/replica/data.db");
+        map_db.disconnect();
+
+        for (const char* path : {"example-snapshot/snapshots/data.db", "example-snapshot/replica/data.db"}) {
+            sqlite_containers::Config file_config;
+            file_config.db_path = path;
+            sqlite_containers::KeyValueDB<int, std::string> file_db(file_config);
+            file_db.connect();
+            std::map<int, std::string> pairs;
+            file_db.load(pairs);
+            if (pairs.size() != 100 || pairs[42] != "value 42") {
+                std::cerr << "The copy in " << path << " does not hold the rows" << std::endl;
+                return 1;
+            }
+            std::cout << path << ": " << pairs.size() << " pairs" << std::endl;
+            file_db.disconnect();
+        }
+    } catch (const sqlite_containers::sqlite_exception& e) {
+        std::cerr << "SQLite error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
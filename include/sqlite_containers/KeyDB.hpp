@@ -26,8 +26,20 @@ namespace sqlite_containers {
             set_config(config);
         }
 
+        /// \brief Constructor for a table on the shared connection of a Database.
+        /// \param database The database whose connection is used; it must outlive the container.
+        /// \param config Table settings; the connection settings are taken from the database.
+        KeyDB(Database& database, const Config& config) : BaseDB(database) {
+            set_config(config);
+        }
+
         /// \brief Destructor.
-        ~KeyDB() override final = default;
+        /// Stops the background writer while the prepared statements are still alive.
+        ~KeyDB() override final {
+            try {
+                disconnect();
+            } catch (...) {}
+        }
 
         // --- Operators ---
 
@@ -37,8 +49,8 @@ namespace sqlite_containers {
         /// \return Reference to this KeyDB.
         /// \throws sqlite_exception if an SQLite error occurs.
         /// \note The transaction mode is taken from the database configuration.
-        template<template <class...> class ContainerT>
-        KeyDB& operator=(const ContainerT<KeyT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        KeyDB& operator=(const ContainerT<KeyT, ContainerArgs...>& container) {
             // Get the default transaction mode from the configuration
             auto txn_mode = get_config().default_txn_mode;
 
@@ -60,7 +72,7 @@ namespace sqlite_containers {
             auto txn_mode = get_config().default_txn_mode;
 
             execute_in_transaction([this, &container]() {
-                db_load(container);
+                db_load_all(m_stmt_load, m_stmt_load_sorted, m_stmt_count, container);
             }, txn_mode);  // Use transaction mode from the configuration
             return container;
         }
@@ -71,10 +83,14 @@ namespace sqlite_containers {
         /// \tparam ContainerT Template for the container type (vector, deque, list, set or unordered_set).
         /// \param container Container to be synchronized with database content.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void load(ContainerT<KeyT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void load(ContainerT<KeyT, ContainerArgs...>& container) {
+            if (auto reader = db_acquire_reader()) {
+                db_load_all(reader->stmts.load, reader->stmts.load_sorted, reader->stmts.count, container);
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_load(container);
+            db_load_all(m_stmt_load, m_stmt_load_sorted, m_stmt_count, container);
         }
 
         /// \brief Loads data from the database into the container with a transaction.
@@ -82,14 +98,15 @@ namespace sqlite_containers {
         /// \param container Container to be synchronized with database content.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
+        template<template <class...> class ContainerT, class... ContainerArgs>
         void load(
-                ContainerT<KeyT>& container,
+                ContainerT<KeyT, ContainerArgs...>& container,
                 const TransactionMode& mode) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_group_commit();
             try {
                 db_begin(mode);
-                db_load(container);
+                db_load_all(m_stmt_load, m_stmt_load_sorted, m_stmt_count, container);
                 db_commit();
             } catch(const sqlite_exception &e) {
                 db_rollback();
@@ -110,9 +127,19 @@ namespace sqlite_containers {
         template<template <class...> class ContainerT>
         ContainerT<KeyT> retrieve_all() {
             ContainerT<KeyT> container;
-            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
-            db_load(container);
-            locker.unlock();
+            load(container);
+            return container;
+        }
+
+        /// \brief Retrieves all keys into a container of the given type, which may use a custom allocator.
+        /// \tparam ContainerT Complete container type, e.g. `std::pmr::set<KeyT>`.
+        /// \param allocator Allocator of the container, e.g. one drawing from a `std::pmr::monotonic_buffer_resource`.
+        /// \return A container with all keys.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<class ContainerT>
+        ContainerT retrieve_all(const typename ContainerT::allocator_type& allocator = typename ContainerT::allocator_type()) {
+            ContainerT container(allocator);
+            load(container);
             return container;
         }
 
@@ -125,9 +152,10 @@ namespace sqlite_containers {
         ContainerT<KeyT> retrieve_all(const TransactionMode& mode) {
             ContainerT<KeyT> container;
             std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            db_group_commit();
             try {
                 db_begin(mode);
-                db_load(container);
+                db_load_all(m_stmt_load, m_stmt_load_sorted, m_stmt_count, container);
                 db_commit();
                 locker.unlock();
             } catch(const sqlite_exception &e) {
@@ -144,13 +172,95 @@ namespace sqlite_containers {
             return container;
         }
 
+        /// \brief Opens a cursor that streams all keys from the database one row at a time.
+        /// The cursor holds the connection lock until it is destroyed (see Cursor).
+        /// \return Cursor over all keys.
+        Cursor<KeyT> cursor() {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            return Cursor<KeyT>(std::move(locker), m_sqlite_db, m_stmt_load, &decode_row);
+        }
+
+        /// \brief Calls a visitor for every key in the database without materializing a container.
+        /// \tparam Func Callable `void(const KeyT&)` or `bool(const KeyT&)`; returning false stops the iteration.
+        /// \param visitor Function called for every key.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<typename Func>
+        void for_each(Func visitor) {
+            auto keys = cursor();
+            for (const KeyT& key : keys) {
+                if (!invoke_visitor(visitor, key)) break;
+            }
+        }
+
+        /// \brief Opens a cursor over the keys in `[from, to)`, in key order.
+        /// The range is read with an index seek, so only the returned rows are visited. Keys are ordered as
+        /// SQLite compares their column: numerically for INTEGER and REAL, bytewise for TEXT and BLOB (see
+        /// OrderedCodec for structures and composite keys). The cursor holds the connection lock until it is
+        /// destroyed (see Cursor).
+        /// \param from Smallest key of the range.
+        /// \param to Key past the end of the range.
+        /// \param limit Maximum number of keys; 0 returns all keys of the range.
+        /// \return Cursor over the keys of the range.
+        Cursor<KeyT> range(const KeyT& from, const KeyT& to, const std::size_t& limit = 0) {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            return db_open_range(std::move(locker), m_stmt_range, from, &to, limit);
+        }
+
+        /// \brief Opens a cursor over the keys not less than `key`, in key order.
+        /// \param key Smallest key to return.
+        /// \param limit Maximum number of keys; 0 returns all keys up to the end of the table.
+        /// \return Cursor over the keys.
+        Cursor<KeyT> lower_bound(const KeyT& key, const std::size_t& limit = 0) {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            return db_open_range(std::move(locker), m_stmt_lower_bound, key, nullptr, limit);
+        }
+
+        /// \brief Opens a cursor over the keys greater than `key`, in key order.
+        /// \param key Key preceding the first key to return.
+        /// \param limit Maximum number of keys; 0 returns all keys up to the end of the table.
+        /// \return Cursor over the keys.
+        Cursor<KeyT> upper_bound(const KeyT& key, const std::size_t& limit = 0) {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            return db_open_range(std::move(locker), m_stmt_upper_bound, key, nullptr, limit);
+        }
+
+        /// \brief Finds the smallest key.
+        /// \param key Receives the smallest key.
+        /// \return True if the table is not empty, false otherwise.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        bool first(KeyT& key) {
+            return read_edge(false, key);
+        }
+
+        /// \brief Finds the largest key.
+        /// \param key Receives the largest key.
+        /// \return True if the table is not empty, false otherwise.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        bool last(KeyT& key) {
+            return read_edge(true, key);
+        }
+
+        /// \brief Removes the keys in `[from, to)` with one `DELETE` statement.
+        /// \param from Smallest key of the range.
+        /// \param to Key past the end of the range.
+        /// \return Number of removed keys.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        std::size_t range_remove(const KeyT& from, const KeyT& to) {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
+            return db_range_remove(from, to);
+        }
+
         /// \brief Appends the content of the container to the database.
         /// \tparam ContainerT Template for the container type (vector, deque, list, set or unordered_set).
         /// \param container Container with content to be synchronized to the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void append(const ContainerT<KeyT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void append(const ContainerT<KeyT, ContainerArgs...>& container) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             db_append(container);
         }
 
@@ -159,9 +269,11 @@ namespace sqlite_containers {
         /// \param container Container with content to be synchronized to the database.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void append(const ContainerT<KeyT>& container, const TransactionMode& mode) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void append(const ContainerT<KeyT, ContainerArgs...>& container, const TransactionMode& mode) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             try {
                 db_begin(mode);
                 db_append(container);
@@ -179,35 +291,51 @@ namespace sqlite_containers {
         }
 
         /// \brief Reconciles the database with the container.
+        /// Only the differences are written: missing keys are inserted and keys that are not in the container are removed.
         /// \tparam ContainerT Container type (e.g., std::set, std::unordered_set, std::vector, or std::list).
         /// \param container Container to be reconciled with the database.
+        /// \return Numbers of inserted and removed keys.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void reconcile(const ContainerT<KeyT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        ReconcileStats reconcile(const ContainerT<KeyT, ContainerArgs...>& container) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_reconcile(container);
+            db_flush_async();
+            db_group_commit();
+            return db_reconcile(container);
         }
 
         /// \brief Reconciles the database with the container using a transaction.
         /// \tparam ContainerT Container type (e.g., std::set, std::unordered_set, std::vector, or std::list).
         /// \param container Container to be reconciled with the database.
         /// \param mode Transaction mode.
+        /// \return Numbers of inserted and removed keys.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void reconcile(
-                const ContainerT<KeyT>& container,
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        ReconcileStats reconcile(
+                const ContainerT<KeyT, ContainerArgs...>& container,
                 const TransactionMode& mode) {
-            execute_in_transaction([this, &container]() {
-                db_reconcile(container);
+            ReconcileStats stats;
+            execute_in_transaction([this, &container, &stats]() {
+                stats = db_reconcile(container);
             }, mode);
+            return stats;
         }
 
         /// \brief Inserts a key into the database.
+        /// With `Config::use_async` the key is queued and written by the background writer.
         /// \param key The key to be inserted.
         /// \throws sqlite_exception if an SQLite error occurs.
         void insert(const KeyT &key) {
+            if (m_async_writes) {
+                async_enqueue([this, key]() {
+                    db_insert(key);
+                });
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_insert(key);
+            db_group_write([this, &key]() {
+                db_insert(key);
+            }, get_byte_size(key));
         }
 
         /// \brief Finds if a key exists in the database.
@@ -215,63 +343,284 @@ namespace sqlite_containers {
         /// \return True if the key was found, false otherwise.
         /// \throws sqlite_exception if an SQLite error occurs.
         bool find(const KeyT &key) {
+            if (auto reader = db_acquire_reader()) {
+                return db_find(reader->stmts.find, key);
+            }
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            return db_find(m_stmt_find, key);
+        }
+
+        /// \brief Finds which of several keys exist in the database.
+        /// Keys are looked up with `WHERE key IN (...)` statements of up to `SQLITE_CONTAINERS_BULK_MAX_ROWS` keys,
+        /// and the connection lock is taken once for the whole batch.
+        /// \tparam KeyContainerT Container type of the keys to search for (e.g., std::vector or std::set).
+        /// \tparam ContainerT Container type receiving the found keys (vector, deque, list, set or unordered_set).
+        /// \param keys The keys to search for.
+        /// \param container Container receiving the keys that were found.
+        /// \return The number of rows found.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class KeyContainerT, template <class...> class ContainerT, class... KeyArgs, class... ContainerArgs>
+        std::size_t find_many(const KeyContainerT<KeyT, KeyArgs...>& keys, ContainerT<KeyT, ContainerArgs...>& container) {
+            if (auto reader = db_acquire_reader()) {
+                return db_find_many(reader->stmts.find_many, keys, container);
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            return db_find(key);
+            return db_find_many(m_bulk_find, keys, container);
         }
 
         /// \brief Returns the number of keys in the database.
         /// \return The number of keys in the database.
         /// \throws sqlite_exception if an SQLite error occurs.
         std::size_t count() const {
+            if (auto reader = db_acquire_reader()) {
+                return db_count(reader->stmts.count);
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            return db_count();
+            return db_count(m_stmt_count);
         }
 
         /// \brief Checks if the database is empty (no keys present).
         /// \return True if the database is empty, false otherwise.
         /// \throws sqlite_exception if an SQLite error occurs.
         bool empty() const {
-            return (db_count() == 0);
+            return (count() == 0);
         }
 
         /// \brief Removes a key from the database.
+        /// With `Config::use_async` the removal is queued and executed by the background writer.
         /// \param key The key to be removed.
         /// \throws sqlite_exception if an SQLite error occurs.
         void remove(const KeyT &key) {
+            if (m_async_writes) {
+                async_enqueue([this, key]() {
+                    db_remove(key);
+                });
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_remove(key);
+            db_group_write([this, &key]() {
+                db_remove(key);
+            }, get_byte_size(key));
         }
 
         /// \brief Clears all keys from the database.
         /// \throws sqlite_exception if an SQLite error occurs.
         void clear() {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             db_clear();
         }
 
+        // --- Asynchronous methods ---
+
+        /// \brief Inserts a key on the I/O thread of the container (see `async_call()`).
+        /// Consecutive `async_insert()` and `async_remove()` calls queued together share one transaction.
+        /// With `Config::use_async` the call runs insert() instead.
+        /// \param key The key to be inserted.
+        /// \return Future completing once the key is written.
+        AsyncResult<void> async_insert(const KeyT &key) {
+            if (m_async_writes) {
+                return async_call([this, key]() {
+                    insert(key);
+                });
+            }
+            return async_write([this, key]() {
+                db_group_write([this, &key]() {
+                    db_insert(key);
+                }, get_byte_size(key));
+            });
+        }
+
+        /// \brief Removes a key on the I/O thread of the container.
+        /// Shares a transaction with neighbouring `async_insert()` and `async_remove()` calls.
+        /// \param key The key to be removed.
+        /// \return Future completing once the key is removed.
+        AsyncResult<void> async_remove(const KeyT &key) {
+            if (m_async_writes) {
+                return async_call([this, key]() {
+                    remove(key);
+                });
+            }
+            return async_write([this, key]() {
+                db_group_write([this, &key]() {
+                    db_remove(key);
+                }, get_byte_size(key));
+            });
+        }
+
+        /// \brief Finds if a key exists on the I/O thread of the container.
+        /// \param key The key to search for.
+        /// \return Future receiving true if the key was found.
+        AsyncResult<bool> async_find(const KeyT &key) {
+            return async_call([this, key]() {
+                return find(key);
+            });
+        }
+
+        /// \brief Returns the number of keys on the I/O thread of the container.
+        /// \return Future receiving the number of keys.
+        AsyncResult<std::size_t> async_count() {
+            return async_call([this]() {
+                return count();
+            });
+        }
+
+        /// \brief Loads data from the database into the container on the I/O thread of the container.
+        /// \param container Container receiving the keys; it must stay alive and untouched until the future is ready.
+        /// \return Future completing once the container is filled.
+        template<class ContainerT>
+        AsyncResult<void> async_load(ContainerT& container) {
+            return async_call([this, &container]() {
+                load(container);
+            });
+        }
+
+        /// \brief Retrieves all keys on the I/O thread of the container.
+        /// \tparam ContainerT Container type (vector, deque, list, set or unordered_set).
+        /// \return Future receiving the container with all keys.
+        template<template <class...> class ContainerT = std::set>
+        AsyncResult<ContainerT<KeyT>> async_retrieve_all() {
+            return async_call([this]() {
+                return retrieve_all<ContainerT>();
+            });
+        }
+
+        /// \brief Appends the content of the container on the I/O thread of the container.
+        /// \param container Container with content to be appended; it is copied into the call.
+        /// \return Future completing once the keys are written.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        AsyncResult<void> async_append(ContainerT<KeyT, ContainerArgs...> container) {
+            return async_call([this, container = std::move(container)]() {
+                append(container);
+            });
+        }
+
+        /// \brief Reconciles the database with the container on the I/O thread of the container.
+        /// \param container Container to be reconciled with the database; it is copied into the call.
+        /// \return Future receiving the numbers of inserted and removed keys.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        AsyncResult<ReconcileStats> async_reconcile(ContainerT<KeyT, ContainerArgs...> container) {
+            return async_call([this, container = std::move(container)]() {
+                return reconcile(container);
+            });
+        }
+
+        /// \brief Clears all keys on the I/O thread of the container.
+        /// \return Future completing once the table is cleared.
+        AsyncResult<void> async_clear() {
+            return async_call([this]() {
+                clear();
+            });
+        }
+
     private:
         SqliteStmt m_stmt_load;         ///< Statement for loading data from the database.
+        SqliteStmt m_stmt_load_sorted;  ///< Statement for loading data in key order.
         SqliteStmt m_stmt_replace;      ///< Statement for replacing key-value pairs in the database.
         SqliteStmt m_stmt_find;         ///< Statement for finding a key.
         mutable SqliteStmt m_stmt_count;///< Statement for counting the number of keys in the database.
         SqliteStmt m_stmt_remove;       ///< Statement for removing a key.
         SqliteStmt m_stmt_clear;        ///< Statement for clearing the table.
+        SqliteStmt m_stmt_range;        ///< Statement for reading the keys of a range in key order.
+        SqliteStmt m_stmt_lower_bound;  ///< Statement for reading the keys from a key on, in key order.
+        SqliteStmt m_stmt_upper_bound;  ///< Statement for reading the keys after a key, in key order.
+        SqliteStmt m_stmt_first;        ///< Statement for reading the smallest key.
+        SqliteStmt m_stmt_last;         ///< Statement for reading the largest key.
+        SqliteStmt m_stmt_range_remove; ///< Statement for removing the keys of a range.
+        std::pair<KeyT, KeyT> m_range_bounds; ///< Copies of the bounds bound to the statement of an open range cursor.
 
-        SqliteStmt m_stmt_insert_temp;  ///< Statement for inserting data into the temporary table.
         SqliteStmt m_stmt_purge_main;   ///< Statement for purging stale data from the main table.
-        SqliteStmt m_stmt_merge_temp;   ///< Statement for merging data from the temporary table into the main table.
+        SqliteStmt m_stmt_merge_temp;   ///< Statement for inserting keys of the temporary table missing from the main table.
         SqliteStmt m_stmt_clear_temp;   ///< Statement for clearing the temporary table.
 
+        ChunkedStmt m_bulk_replace;     ///< Multi-row statement for replacing keys in the main table.
+        ChunkedStmt m_bulk_insert_temp; ///< Multi-row statement for inserting keys into the temporary table.
+        ChunkedStmt m_bulk_find;        ///< Multi-key statement for finding keys.
+
+        /// \brief Prepared statements of a read-only connection.
+        struct ReadStmts {
+            SqliteStmt  load;           ///< Statement for loading data from the database.
+            SqliteStmt  load_sorted;    ///< Statement for loading data in key order.
+            SqliteStmt  find;           ///< Statement for finding a key.
+            SqliteStmt  count;          ///< Statement for counting the number of keys.
+            ChunkedStmt find_many;      ///< Multi-key statement for finding keys.
+            SqliteStmt  first;          ///< Statement for reading the smallest key.
+            SqliteStmt  last;           ///< Statement for reading the largest key.
+        };
+
+        mutable ReaderPool<ReadStmts> m_readers; ///< Read-only connections (see `Config::read_connections`).
+
+        /// \brief Leases a read-only connection if reads may bypass the main connection.
+        /// \return Lease over a reader, or an empty lease if reads must use the main connection.
+        typename ReaderPool<ReadStmts>::Lease db_acquire_reader() const {
+            if (!db_can_use_readers()) return typename ReaderPool<ReadStmts>::Lease();
+            return m_readers.acquire();
+        }
+
+        /// \brief Returns the name of the main table.
+        static std::string get_table_name(const Config &config) {
+            return config.table_name.empty() ? "key_store" : config.table_name;
+        }
+
+        /// \brief Decodes a row of `m_stmt_load`.
+        static KeyT decode_row(SqliteStmt& stmt) {
+            return stmt.extract_column<KeyT>(0);
+        }
+
+        /// \brief Binds the bounds and the limit of a range statement and opens a cursor over it.
+        /// The bounds are copied into `m_range_bounds`, which stays unchanged while the cursor holds the lock,
+        /// so the cursor does not depend on the lifetime of the arguments.
+        /// \param locker Lock of the connection, moved into the cursor.
+        /// \param stmt Range statement taking one or two bounds followed by the limit.
+        /// \param from First bound.
+        /// \param to Second bound, or nullptr if the statement takes one bound.
+        /// \param limit Maximum number of keys; 0 means no limit.
+        /// \return Cursor over the keys of the range.
+        Cursor<KeyT> db_open_range(
+                std::unique_lock<std::mutex> locker,
+                SqliteStmt& stmt,
+                const KeyT& from,
+                const KeyT* to,
+                const std::size_t& limit) {
+            int index = 1;
+            m_range_bounds.first = from;
+            stmt.bind_value<KeyT>(index++, m_range_bounds.first);
+            if (to) {
+                m_range_bounds.second = *to;
+                stmt.bind_value<KeyT>(index++, m_range_bounds.second);
+            }
+            stmt.bind_value<int64_t>(index, to_sql_limit(limit));
+            return Cursor<KeyT>(std::move(locker), m_sqlite_db, stmt, &decode_row);
+        }
+
+        /// \brief Reads the smallest or the largest key.
+        /// \param last True for the largest key, false for the smallest.
+        /// \param key Receives the key.
+        /// \return True if the table is not empty, false otherwise.
+        bool read_edge(const bool& last, KeyT& key) {
+            std::vector<KeyT> keys;
+            if (auto reader = db_acquire_reader()) {
+                db_load(last ? reader->stmts.last : reader->stmts.first, keys);
+            } else {
+                std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+                db_load(last ? m_stmt_last : m_stmt_first, keys);
+            }
+            if (keys.empty()) return false;
+            key = std::move(keys.front());
+            return true;
+        }
+
         /// \brief Creates the table in the database.
         /// \param config Configuration settings.
         void db_create_table(const Config &config) override final {
-            const std::string table_name = config.table_name.empty() ? "key_store" : config.table_name;
+            const std::string table_name = get_table_name(config);
             const std::string temp_table_name = config.table_name.empty() ? "key_temp_store" : config.table_name + "_temp";
 
             // Create table if they do not exist
             const std::string create_table_sql =
                 "CREATE TABLE IF NOT EXISTS " + table_name + " ("
-                "key " + get_sqlite_type<KeyT>() + " PRIMARY KEY NOT NULL);";
+                "key " + get_sqlite_type<KeyT>() + " PRIMARY KEY NOT NULL)" + to_table_options(config.table_layout) + ";";
             execute(m_sqlite_db, create_table_sql);
 
             // Create the temporary table for synchronization if it does not exist
@@ -281,131 +630,217 @@ namespace sqlite_containers {
             execute(m_sqlite_db, create_temp_table_sql);
 
             // Initialize prepared statements
-            m_stmt_load.init(m_sqlite_db, "SELECT key FROM " + table_name + ";");
-            m_stmt_replace.init(m_sqlite_db, "REPLACE INTO " + table_name + " (key) VALUES (?);");
-            m_stmt_find.init(m_sqlite_db, "SELECT EXISTS(SELECT 1 FROM " + table_name + " WHERE key = ?);");
-            m_stmt_count.init(m_sqlite_db, "SELECT COUNT(*) FROM " + table_name + ";");
-            m_stmt_remove.init(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key = ?;");
-            m_stmt_clear.init(m_sqlite_db, "DELETE FROM " + table_name);
+            m_stmt_load.init(m_sqlite_db, "SELECT key FROM " + table_name + ";", true);
+            m_stmt_load_sorted.defer(m_sqlite_db, "SELECT key FROM " + table_name + " ORDER BY key;", true);
+            m_stmt_replace.init(m_sqlite_db, "REPLACE INTO " + table_name + " (key) VALUES (?);", true);
+            m_stmt_find.init(m_sqlite_db, "SELECT EXISTS(SELECT 1 FROM " + table_name + " WHERE key = ?);", true);
+            m_stmt_count.init(m_sqlite_db, "SELECT COUNT(*) FROM " + table_name + ";", true);
+            m_stmt_remove.init(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key = ?;", true);
+            m_stmt_clear.defer(m_sqlite_db, "DELETE FROM " + table_name, true);
+            m_stmt_range.defer(m_sqlite_db, "SELECT key FROM " + table_name + " WHERE key >= ? AND key < ? ORDER BY key LIMIT ?;", true);
+            m_stmt_lower_bound.defer(m_sqlite_db, "SELECT key FROM " + table_name + " WHERE key >= ? ORDER BY key LIMIT ?;", true);
+            m_stmt_upper_bound.defer(m_sqlite_db, "SELECT key FROM " + table_name + " WHERE key > ? ORDER BY key LIMIT ?;", true);
+            m_stmt_first.defer(m_sqlite_db, "SELECT key FROM " + table_name + " ORDER BY key LIMIT 1;", true);
+            m_stmt_last.defer(m_sqlite_db, "SELECT key FROM " + table_name + " ORDER BY key DESC LIMIT 1;", true);
+            m_stmt_range_remove.defer(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key >= ? AND key < ?;", true);
 
             // Initialize prepared statements for temporary table operations
-            m_stmt_insert_temp.init(m_sqlite_db, "INSERT OR REPLACE INTO " + temp_table_name + " (key) VALUES (?);");
-            m_stmt_purge_main.init(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key NOT IN (SELECT key FROM " + temp_table_name + ");");
-            m_stmt_merge_temp.init(m_sqlite_db, "INSERT OR REPLACE INTO " + table_name + " (key) SELECT key FROM " + temp_table_name + ";");
-            m_stmt_clear_temp.init(m_sqlite_db, "DELETE FROM " + temp_table_name + ";");
+            m_stmt_purge_main.defer(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key NOT IN (SELECT key FROM " + temp_table_name + ");", true);
+            m_stmt_merge_temp.defer(m_sqlite_db, "INSERT OR IGNORE INTO " + table_name + " (key) SELECT key FROM " + temp_table_name + ";", true);
+            m_stmt_clear_temp.defer(m_sqlite_db, "DELETE FROM " + temp_table_name + ";", true);
+
+            // Initialize multi-row statements for bulk operations
+            m_bulk_replace.init(m_sqlite_db, "REPLACE INTO " + table_name + " (key) VALUES ", "(?)", ", ", ";", 1);
+            m_bulk_insert_temp.init(m_sqlite_db, "INSERT OR REPLACE INTO " + temp_table_name + " (key) VALUES ", "(?)", ", ", ";", 1);
+            m_bulk_find.init(m_sqlite_db, "SELECT key FROM " + table_name + " WHERE key IN (", "?", ", ", ");", 1);
+        }
+
+        /// \brief Opens the read-only connections and prepares their statements.
+        /// \param config Configuration settings.
+        void db_open_readers(const Config &config) override final {
+            const std::string table_name = get_table_name(config);
+            m_readers.open(config, [&table_name](sqlite3* sqlite_db, ReadStmts& stmts) {
+                stmts.load.init(sqlite_db, "SELECT key FROM " + table_name + ";", true);
+                stmts.load_sorted.defer(sqlite_db, "SELECT key FROM " + table_name + " ORDER BY key;", true);
+                stmts.find.init(sqlite_db, "SELECT EXISTS(SELECT 1 FROM " + table_name + " WHERE key = ?);", true);
+                stmts.count.init(sqlite_db, "SELECT COUNT(*) FROM " + table_name + ";", true);
+                stmts.find_many.init(sqlite_db, "SELECT key FROM " + table_name + " WHERE key IN (", "?", ", ", ");", 1);
+                stmts.first.defer(sqlite_db, "SELECT key FROM " + table_name + " ORDER BY key LIMIT 1;", true);
+                stmts.last.defer(sqlite_db, "SELECT key FROM " + table_name + " ORDER BY key DESC LIMIT 1;", true);
+            });
+        }
+
+        /// \brief Closes the read-only connections.
+        void db_close_readers() override final {
+            m_readers.close();
+        }
+
+        /// \brief Binds a key to a statement parameter.
+        /// \param stmt The statement to bind to.
+        /// \param index Index of the parameter.
+        /// \param key The key.
+        static void bind_key(SqliteStmt& stmt, const int& index, const KeyT& key) {
+            stmt.bind_value<KeyT>(index, key);
+        }
+
+        /// \brief Loads all keys into a container, choosing the statement by the container.
+        /// Sequences and flat sorted containers (see is_sorted_load_target) read the rows in key order; containers
+        /// with `reserve()` first reserve room for the counted rows.
+        /// \param load Statement reading the table in storage order.
+        /// \param load_sorted Statement reading the table in key order.
+        /// \param count Statement counting the rows.
+        /// \param container Container to load the data into.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<class ContainerT>
+        void db_load_all(SqliteStmt& load, SqliteStmt& load_sorted, SqliteStmt& count, ContainerT& container) {
+            if constexpr (has_reserve<ContainerT>::value) {
+                reserve_capacity(container, container.size() + db_count(count));
+            }
+            db_load(is_sorted_load_target<ContainerT>::value ? load_sorted : load, container);
         }
 
         /// \brief Loads data from the database into the container.
         /// \tparam ContainerT Template for the container type (vector, deque, list, set or unordered_set).
+        /// \param stmt Load statement of the connection to read from.
         /// \param set Container to be synchronized with database content.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void db_load(ContainerT<KeyT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void db_load(SqliteStmt& stmt, ContainerT<KeyT, ContainerArgs...>& container) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::LOAD);
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
             int err;
             try {
                 for (;;) {
-                    while ((err = m_stmt_load.step()) == SQLITE_ROW) {
-                        KeyT key = m_stmt_load.extract_column<KeyT>(0);
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        KeyT key = stmt.extract_column<KeyT>(0);
                         add_value(container, key);
                     }
                     if (err == SQLITE_DONE) {
-                        m_stmt_load.reset();
+                        stmt.reset();
                         return;
                     }
                     if (err == SQLITE_BUSY) {
                         // Handle busy database, retry reading
-                        m_stmt_load.reset();
-                        sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
                         continue;
                     }
                     // Handle SQLite errors
                     std::string err_msg = "SQLite error: ";
                     err_msg += std::to_string(err);
                     err_msg += ", ";
-                    err_msg += sqlite3_errmsg(m_sqlite_db);
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
                     throw sqlite_exception(err_msg, err);
                 }
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(),
-                    {&m_stmt_load},
+                    {&stmt},
                     "Unknown error occurred while loading data from database.");
             }
         }
 
+        /// \brief Finds which of several keys exist in the database.
+        /// \tparam KeyContainerT Container type of the keys.
+        /// \tparam ContainerT Container type receiving the found keys.
+        /// \param bulk_find Multi-key statement of the connection to read from.
+        /// \param keys The keys to search for.
+        /// \param container Container receiving the keys that were found.
+        /// \return The number of rows found.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class KeyContainerT, template <class...> class ContainerT, class... KeyArgs, class... ContainerArgs>
+        std::size_t db_find_many(ChunkedStmt& bulk_find, const KeyContainerT<KeyT, KeyArgs...>& keys, ContainerT<KeyT, ContainerArgs...>& container) {
+            std::size_t found = 0;
+            try {
+                bulk_find.query(keys.begin(), keys.size(), bind_key, [&container, &found](SqliteStmt& stmt) {
+                    KeyT key = stmt.extract_column<KeyT>(0);
+                    add_value(container, key);
+                    ++found;
+                });
+            } catch (...) {
+                db_handle_exception(std::current_exception(), {}, "Unknown error occurred while finding keys.");
+            }
+            return found;
+        }
+
         /// \brief Finds if a key exists in the database.
+        /// \param stmt Lookup statement of the connection to read from.
         /// \param key The key to search for.
         /// \return True if the key was found, false otherwise.
         /// \throws sqlite_exception if an SQLite error occurs.
-        bool db_find(const KeyT& key) {
+        bool db_find(SqliteStmt& stmt, const KeyT& key) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::FIND);
             bool is_found = false;
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
             int err;
             try {
                 for (;;) {
-                    m_stmt_find.bind_value<KeyT>(1, key);
-                    while ((err = m_stmt_find.step()) == SQLITE_ROW) {
-                        is_found = static_cast<bool>(m_stmt_find.extract_column<int>(0));
+                    stmt.bind_value<KeyT>(1, key);
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        is_found = static_cast<bool>(stmt.extract_column<int>(0));
                     }
                     if (err == SQLITE_DONE) {
-                        m_stmt_find.reset();
-                        m_stmt_find.clear_bindings();
+                        stmt.reset();
+                        stmt.clear_bindings();
                         break;
                     }
                     if (err == SQLITE_BUSY) {
                         // Handle busy database, retry reading
-                        m_stmt_find.reset();
-                        m_stmt_find.clear_bindings();
-                        sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                        sqlite3_reset(stmt.get_stmt());
+                        stmt.clear_bindings();
+                        busy_retry.wait();
                         continue;
                     }
                     // Handle SQLite errors
                     std::string err_msg = "SQLite error: ";
                     err_msg += std::to_string(err);
                     err_msg += ", ";
-                    err_msg += sqlite3_errmsg(m_sqlite_db);
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
                     throw sqlite_exception(err_msg, err);
                 }
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(),
-                    {&m_stmt_find},
+                    {&stmt},
                      "Unknown error occurred while retrieving value for the provided key.");
             }
             return is_found;
         }
 
         /// \brief Returns the total number of keys stored in the database.
+        /// \param stmt Count statement of the connection to read from.
         /// \return The number of keys stored in the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        std::size_t db_count() const {
+        std::size_t db_count(SqliteStmt& stmt) const {
             std::size_t count = 0;
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
             int err;
             try {
                 for (;;) {
-                    while ((err = m_stmt_count.step()) == SQLITE_ROW) {
-                        count = m_stmt_count.extract_column<std::size_t>(0);
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        count = stmt.extract_column<std::size_t>(0);
                     }
                     if (err == SQLITE_DONE) {
-                        m_stmt_count.reset();
+                        stmt.reset();
                         break;
                     }
                     if (err == SQLITE_BUSY) {
                         // Handle busy database, retry reading
-                        m_stmt_count.reset();
-                        sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
                         continue;
                     }
                     // Handle SQLite errors
                     std::string err_msg = "SQLite error: ";
                     err_msg += std::to_string(err);
                     err_msg += ", ";
-                    err_msg += sqlite3_errmsg(m_sqlite_db);
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
                     throw sqlite_exception(err_msg, err);
                 }
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(),
-                    {&m_stmt_count},
+                    {&stmt},
                     "Unknown error occurred while counting keys in the database.");
             }
             return count;
@@ -413,31 +848,31 @@ namespace sqlite_containers {
 
         /// \brief Reconciles the content of the database with the container.
         /// Synchronizes the main table with the content of the container by using a temporary table.
-        /// Clears old data, inserts new data, and updates existing records in the main table.
+        /// Removes stale keys and inserts missing ones; keys that are already present are not rewritten.
         /// \tparam ContainerT Template for the container type (e.g., std::set, std::unordered_set, std::vector, or std::list).
         /// \param container Container with keys to be reconciled with the database.
+        /// \return Numbers of inserted and removed keys.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void db_reconcile(const ContainerT<KeyT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        ReconcileStats db_reconcile(const ContainerT<KeyT, ContainerArgs...>& container) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::RECONCILE);
+            ReconcileStats stats;
             try {
                 // Clear the temporary table
                 m_stmt_clear_temp.execute();
                 m_stmt_clear_temp.reset();
 
                 // Insert all new data from the container into the temporary table
-                for (const auto& item : container) {
-                    m_stmt_insert_temp.bind_value<KeyT>(1, item);
-                    m_stmt_insert_temp.execute();
-                    m_stmt_insert_temp.reset();
-                    m_stmt_insert_temp.clear_bindings();
-                }
+                m_bulk_insert_temp.execute(container.begin(), container.size(), bind_key);
                 // Remove old data from the main table that is not in the temporary table
                 m_stmt_purge_main.execute();
                 m_stmt_purge_main.reset();
+                stats.removed = static_cast<std::size_t>(sqlite3_changes(m_sqlite_db));
 
-                // Insert or update records from the temporary table into the main table
+                // Insert the keys that are missing from the main table; existing keys are not rewritten
                 m_stmt_merge_temp.execute();
                 m_stmt_merge_temp.reset();
+                stats.inserted = static_cast<std::size_t>(sqlite3_changes(m_sqlite_db));
 
                 // Clear the temporary table
                 m_stmt_clear_temp.execute();
@@ -447,29 +882,25 @@ namespace sqlite_containers {
                 db_handle_exception(
                     std::current_exception(), {
                         &m_stmt_purge_main, &m_stmt_merge_temp,
-                        &m_stmt_clear_temp, &m_stmt_insert_temp
+                        &m_stmt_clear_temp
                     },
                     "Unknown error occurred while reconciling data.");
             }
+            return stats;
         }
 
         /// \brief Appends the content of the container to the database.
+        /// Keys are written in chunks by multi-row `REPLACE INTO` statements.
         /// \tparam ContainerT Template for the container type (vector, deque, list, set or unordered_set).
         /// \param container Container with content to be synchronized to the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void db_append(const ContainerT<KeyT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void db_append(const ContainerT<KeyT, ContainerArgs...>& container) {
             try {
-                for (const auto& item : container) {
-                    m_stmt_replace.bind_value<KeyT>(1, item);
-                    m_stmt_replace.execute();
-                    m_stmt_replace.reset();
-                    m_stmt_replace.clear_bindings();
-                }
+                m_bulk_replace.execute(container.begin(), container.size(), bind_key);
             } catch (...) {
                 db_handle_exception(
-                    std::current_exception(),
-                    {&m_stmt_replace},
+                    std::current_exception(), {},
                      "Unknown error occurred while appending key-value pairs to the database.");
             }
         }
@@ -478,6 +909,7 @@ namespace sqlite_containers {
         /// \param key The key to be inserted.
         /// \throws sqlite_exception if an SQLite error occurs.
         void db_insert(const KeyT &key) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::INSERT);
             try {
                 m_stmt_replace.bind_value<KeyT>(1, key);
                 m_stmt_replace.execute();
@@ -522,6 +954,28 @@ namespace sqlite_containers {
             }
         }
 
+        /// \brief Removes the keys of a range from the database.
+        /// \param from Smallest key of the range.
+        /// \param to Key past the end of the range.
+        /// \return Number of removed keys.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        std::size_t db_range_remove(const KeyT& from, const KeyT& to) {
+            try {
+                m_stmt_range_remove.bind_value<KeyT>(1, from);
+                m_stmt_range_remove.bind_value<KeyT>(2, to);
+                m_stmt_range_remove.execute();
+                m_stmt_range_remove.reset();
+                m_stmt_range_remove.clear_bindings();
+                return static_cast<std::size_t>(sqlite3_changes(m_sqlite_db));
+            } catch (...) {
+                db_handle_exception(
+                    std::current_exception(),
+                    {&m_stmt_range_remove},
+                    "Unknown error occurred while removing a key range.");
+            }
+            return 0;
+        }
+
     }; // KeyDB
 
 }; // namespace sqlite_containers
@@ -4,7 +4,15 @@
 /// \brief Template class for managing key-value pairs in a SQLite database.
 
 #include "parts/BaseDB.hpp"
+#include "parts/ChangeLog.hpp"
 #include <algorithm>
+#include <memory_resource>
+#include <tuple>
+
+/// \brief Maximum number of cached key IDs and value IDs; a full cache is cleared and refilled on demand.
+#ifndef SQLITE_CONTAINERS_ID_CACHE_SIZE
+#define SQLITE_CONTAINERS_ID_CACHE_SIZE 65536
+#endif
 
 namespace sqlite_containers {
 
@@ -31,8 +39,20 @@ namespace sqlite_containers {
             set_config(config);
         }
 
+        /// \brief Constructor for a table on the shared connection of a Database.
+        /// \param database The database whose connection is used; it must outlive the container.
+        /// \param config Table settings; the connection settings are taken from the database.
+        KeyMultiValueDB(Database& database, const Config& config) : BaseDB(database) {
+            set_config(config);
+        }
+
         /// \brief Destructor.
-        ~KeyMultiValueDB() override final = default;
+        /// Stops the background writer while the prepared statements are still alive.
+        ~KeyMultiValueDB() override final {
+            try {
+                disconnect();
+            } catch (...) {}
+        }
 
         // --- Operators ---
 
@@ -42,8 +62,8 @@ namespace sqlite_containers {
         /// \return Reference to this KeyMultiValueDB.
         /// \throws sqlite_exception if an SQLite error occur.
         /// \note This method uses the default transaction mode from the database configuration.
-        template<template <class...> class ContainerT>
-        KeyMultiValueDB& operator=(const ContainerT<KeyT, ValueT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        KeyMultiValueDB& operator=(const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
             // Get the default transaction mode from the configuration
             auto txn_mode = get_config().default_txn_mode;
 
@@ -60,8 +80,8 @@ namespace sqlite_containers {
         /// \return Reference to this KeyMultiValueDB.
         /// \throws sqlite_exception if an SQLite error occurs.
         /// \note This method uses the default transaction mode from the database configuration.
-        template<template <class...> class ContainerT, template <class...> class ValueContainerT>
-        KeyMultiValueDB& operator=(const ContainerT<KeyT, ValueContainerT<ValueT>>& container) {
+        template<template <class...> class ContainerT, template <class...> class ValueContainerT, class... ContainerArgs, class... ValueArgs>
+        KeyMultiValueDB& operator=(const ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container) {
             // Get the default transaction mode from the configuration
             auto txn_mode = get_config().default_txn_mode;
 
@@ -83,7 +103,7 @@ namespace sqlite_containers {
             auto txn_mode = get_config().default_txn_mode;
 
             execute_in_transaction([this, &container]() {
-                db_load(container);
+                db_load(m_stmt_load, container);
             }, txn_mode);  // Use transaction mode from the configuration
             return container;
         }
@@ -101,7 +121,7 @@ namespace sqlite_containers {
             auto txn_mode = get_config().default_txn_mode;
 
             execute_in_transaction([this, &container]() {
-                db_load(container);
+                db_load(m_stmt_load, container);
             }, txn_mode);  // Use transaction mode from the configuration
             return container;
         }
@@ -113,12 +133,12 @@ namespace sqlite_containers {
         /// \param container Container to load the data into.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
+        template<template <class...> class ContainerT, class... ContainerArgs>
         void load(
-                ContainerT<KeyT, ValueT>& container,
+                ContainerT<KeyT, ValueT, ContainerArgs...>& container,
                 const TransactionMode& mode) {
             execute_in_transaction([this, &container]() {
-                db_load(container);
+                db_load(m_stmt_load, container);
             }, mode);
         }
 
@@ -126,11 +146,15 @@ namespace sqlite_containers {
         /// \tparam ContainerT Template for the container type (e.g., std::map, std::unordered_map, std::multimap, std::unordered_multimap).
         /// \param container Container to load the data into.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
+        template<template <class...> class ContainerT, class... ContainerArgs>
         void load(
-                ContainerT<KeyT, ValueT>& container) {
+                ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            if (auto reader = db_acquire_reader()) {
+                db_load(reader->stmts.load, container);
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_load(container);
+            db_load(m_stmt_load, container);
         }
 
         /// \brief Loads data from the database into the container.
@@ -139,12 +163,12 @@ namespace sqlite_containers {
         /// \param container Container to load the data into.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT, template <class...> class ValueContainerT>
+        template<template <class...> class ContainerT, template <class...> class ValueContainerT, class... ContainerArgs, class... ValueArgs>
         void load(
-                ContainerT<KeyT, ValueContainerT<ValueT>>& container,
+                ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container,
                 const TransactionMode& mode) {
             execute_in_transaction([this, &container]() {
-                db_load(container);
+                db_load(m_stmt_load, container);
             }, mode);
         }
 
@@ -153,11 +177,15 @@ namespace sqlite_containers {
         /// \tparam ValueContainerT Template for the container type used for values (e.g., std::vector, std::set).
         /// \param container Container to load the data into.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT, template <class...> class ValueContainerT>
+        template<template <class...> class ContainerT, template <class...> class ValueContainerT, class... ContainerArgs, class... ValueArgs>
         void load(
-                ContainerT<KeyT, ValueContainerT<ValueT>>& container) {
+                ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container) {
+            if (auto reader = db_acquire_reader()) {
+                db_load(reader->stmts.load, container);
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_load(container);
+            db_load(m_stmt_load, container);
         }
 
         /// \brief Retrieves all key-value pairs from the database with a transaction.
@@ -170,7 +198,7 @@ namespace sqlite_containers {
                 const TransactionMode& mode) {
             ContainerT<KeyT, ValueT> container;
             execute_in_transaction([this, &container]() {
-                db_load(container);
+                db_load(m_stmt_load, container);
             }, mode);
             return container;
         }
@@ -182,8 +210,7 @@ namespace sqlite_containers {
         template<template <class...> class ContainerT>
         ContainerT<KeyT, ValueT> retrieve_all() {
             ContainerT<KeyT, ValueT> container;
-            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_load(container);
+            load(container);
             return container;
         }
 
@@ -198,7 +225,7 @@ namespace sqlite_containers {
                 const TransactionMode& mode) {
             ContainerT<KeyT, ValueContainerT<ValueT>> container;
             execute_in_transaction([this, &container]() {
-                db_load(container);
+                db_load(m_stmt_load, container);
             }, mode);
             return container;
         }
@@ -211,19 +238,51 @@ namespace sqlite_containers {
         template<template <class...> class ContainerT, template <class...> class ValueContainerT>
         ContainerT<KeyT, ValueContainerT<ValueT>> retrieve_all() {
             ContainerT<KeyT, ValueContainerT<ValueT>> container;
-            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_load(container);
+            load(container);
             return container;
         }
 
+        /// \brief Retrieves all key-value pairs into a container of the given type, which may use a custom allocator.
+        /// \tparam ContainerT Complete container type, e.g. `std::pmr::multimap<KeyT, ValueT>`.
+        /// \param allocator Allocator of the container, e.g. one drawing from a `std::pmr::monotonic_buffer_resource`.
+        /// \return A container with all key-value pairs.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<class ContainerT>
+        ContainerT retrieve_all(const typename ContainerT::allocator_type& allocator = typename ContainerT::allocator_type()) {
+            ContainerT container(allocator);
+            load(container);
+            return container;
+        }
+
+        /// \brief Opens a cursor that streams all key-value pairs with their counts one row at a time.
+        /// Each row is a `(key, value, value_count)` tuple. The cursor holds the connection lock until it is destroyed (see Cursor).
+        /// \return Cursor over all key-value pairs.
+        Cursor<std::tuple<KeyT, ValueT, std::size_t>> cursor() {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            return Cursor<std::tuple<KeyT, ValueT, std::size_t>>(std::move(locker), m_sqlite_db, m_stmt_load, &decode_row);
+        }
+
+        /// \brief Calls a visitor for every key-value pair in the database without materializing a container.
+        /// \tparam Func Callable `void(const KeyT&, const ValueT&, std::size_t value_count)`, or the same returning bool;
+        /// returning false stops the iteration.
+        /// \param visitor Function called for every pair.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<typename Func>
+        void for_each(Func visitor) {
+            auto rows = cursor();
+            for (const auto& row : rows) {
+                if (!invoke_visitor(visitor, std::get<0>(row), std::get<1>(row), std::get<2>(row))) break;
+            }
+        }
+
         /// \brief Appends the content of the container to the database with a transaction.
         /// \tparam ContainerT Template for the container type (std::map, std::unordered_map, std::multimap or std::unordered_multimap).
         /// \param container Container with content to be appended to the database.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
+        template<template <class...> class ContainerT, class... ContainerArgs>
         void append(
-                const ContainerT<KeyT, ValueT>& container,
+                const ContainerT<KeyT, ValueT, ContainerArgs...>& container,
                 const TransactionMode& mode) {
             execute_in_transaction([this, &container]() {
                 db_append(container);
@@ -234,10 +293,12 @@ namespace sqlite_containers {
         /// \tparam ContainerT Template for the container type (std::map, std::unordered_map, std::multimap or std::unordered_multimap).
         /// \param container Container with content to be appended to the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
+        template<template <class...> class ContainerT, class... ContainerArgs>
         void append(
-                const ContainerT<KeyT, ValueT>& container) {
+                const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             db_append(container);
         }
 
@@ -247,9 +308,9 @@ namespace sqlite_containers {
         /// \param container Container with content to be appended to the database.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT, template <class...> class ValueContainerT>
+        template<template <class...> class ContainerT, template <class...> class ValueContainerT, class... ContainerArgs, class... ValueArgs>
         void append(
-                const ContainerT<KeyT, ValueContainerT<ValueT>>& container,
+                const ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container,
                 const TransactionMode& mode) {
             execute_in_transaction([this, &container]() {
                 db_append(container);
@@ -261,10 +322,12 @@ namespace sqlite_containers {
         /// \tparam ValueContainerT Template for the container type used for values (e.g., std::vector, std::set).
         /// \param container Container with content to be appended to the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT, template <class...> class ValueContainerT>
+        template<template <class...> class ContainerT, template <class...> class ValueContainerT, class... ContainerArgs, class... ValueArgs>
         void append(
-                const ContainerT<KeyT, ValueContainerT<ValueT>>& container) {
+                const ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             db_append(container);
         }
 
@@ -273,9 +336,9 @@ namespace sqlite_containers {
         /// \param container Container with content to be reconciled with the database.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
+        template<template <class...> class ContainerT, class... ContainerArgs>
         void reconcile(
-                const ContainerT<KeyT, ValueT>& container,
+                const ContainerT<KeyT, ValueT, ContainerArgs...>& container,
                 const TransactionMode& mode) {
             execute_in_transaction([this, &container]() {
                 db_reconcile(container);
@@ -286,10 +349,12 @@ namespace sqlite_containers {
         /// \tparam ContainerT Template for the container type (std::map, std::unordered_map, std::multimap or std::unordered_multimap).
         /// \param container Container with content to be reconciled with the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
+        template<template <class...> class ContainerT, class... ContainerArgs>
         void reconcile(
-                const ContainerT<KeyT, ValueT>& container) {
+                const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             db_reconcile(container);
         }
 
@@ -299,9 +364,9 @@ namespace sqlite_containers {
         /// \param container Container with content to be reconciled with the database.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT, template <class...> class ValueContainerT>
+        template<template <class...> class ContainerT, template <class...> class ValueContainerT, class... ContainerArgs, class... ValueArgs>
         void reconcile(
-                const ContainerT<KeyT, ValueContainerT<ValueT>>& container,
+                const ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container,
                 const TransactionMode& mode) {
             execute_in_transaction([this, &container]() {
                 db_reconcile(container);
@@ -313,12 +378,39 @@ namespace sqlite_containers {
         /// \tparam ValueContainerT Template for the container type used for values.
         /// \param container Container with content to be reconciled with the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT, template <class...> class ValueContainerT>
-        void reconcile(const ContainerT<KeyT, ValueContainerT<ValueT>>& container) {
+        template<template <class...> class ContainerT, template <class...> class ValueContainerT, class... ContainerArgs, class... ValueArgs>
+        void reconcile(const ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             db_reconcile(container);
         }
 
+        /// \brief Applies recorded changes to the database in one transaction.
+        /// Only the pairs and keys in the log are written. Joins the transaction opened by `begin()` if there is
+        /// one; otherwise a transaction with `Config::default_txn_mode` is used.
+        /// \param log Changes to apply; the log is not cleared.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void apply_delta(const MultiChangeLog<KeyT, ValueT>& log) {
+            if (log.empty()) return;
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
+            db_write_in_transaction([this, &log]() {
+                db_apply_delta(log);
+            });
+        }
+
+        /// \brief Applies recorded changes to the database using a transaction.
+        /// \param log Changes to apply; the log is not cleared.
+        /// \param mode Transaction mode.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void apply_delta(const MultiChangeLog<KeyT, ValueT>& log, const TransactionMode& mode) {
+            execute_in_transaction([this, &log]() {
+                db_apply_delta(log);
+            }, mode);
+        }
+
         /// \brief Inserts a key-value pair into the database with a transaction.
         /// \param key The key to be inserted.
         /// \param value The value to be inserted.
@@ -334,15 +426,23 @@ namespace sqlite_containers {
         }
 
         /// \brief Inserts a key-value pair into the database.
+        /// With `Config::use_async` the pair is queued and written by the background writer.
         /// \param key The key to be inserted.
         /// \param value The value to be inserted.
-        /// \param mode Transaction mode (defaults to the mode from the configuration).
         /// \throws sqlite_exception if an SQLite error occurs.
         void insert(
                 const KeyT &key,
                 const ValueT &value) {
+            if (m_async_writes) {
+                async_enqueue([this, key, value]() {
+                    db_insert(key, value);
+                });
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_insert(key, value);
+            db_group_write([this, &key, &value]() {
+                db_insert(key, value);
+            }, get_byte_size(key) + get_byte_size(value));
         }
 
         /// \brief Inserts a key-value pair into the database with a transaction.
@@ -362,8 +462,7 @@ namespace sqlite_containers {
         /// \throws sqlite_exception if an SQLite error occurs.
         void insert(
                 const std::pair<KeyT, ValueT> &pair) {
-            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_insert(pair.first, pair.second);
+            insert(pair.first, pair.second);
         }
 
         /// \brief Sets the count of values associated with a specific key-value pair in the database.
@@ -375,8 +474,16 @@ namespace sqlite_containers {
                 const KeyT& key,
                 const ValueT& value,
                 const std::size_t& value_count) {
+            if (m_async_writes) {
+                async_enqueue([this, key, value, value_count]() {
+                    db_set_value_count_key_value(key, value, value_count);
+                });
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_set_value_count_key_value(key, value, value_count);
+            db_group_write([this, &key, &value, &value_count]() {
+                db_set_value_count_key_value(key, value, value_count);
+            }, get_byte_size(key) + get_byte_size(value));
         }
 
         /// \brief Alias for set_value_count().
@@ -389,8 +496,7 @@ namespace sqlite_containers {
                 const KeyT& key,
                 const ValueT& value,
                 const std::size_t& value_count) {
-            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_set_value_count_key_value(key, value, value_count);
+            set_value_count(key, value, value_count);
         }
 
         /// \brief Retrieves the count of values associated with a specific key-value pair from the database.
@@ -421,10 +527,54 @@ namespace sqlite_containers {
         /// \param values The container to store the values associated with the key.
         /// \return True if the key was found, false otherwise.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        bool find(const KeyT &key, ContainerT<ValueT>& values) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        bool find(const KeyT &key, ContainerT<ValueT, ContainerArgs...>& values) {
+            if (auto reader = db_acquire_reader()) {
+                return db_find(reader->stmts.find, key, values);
+            }
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            return db_find(m_stmt_find, key, values);
+        }
+
+        /// \brief Finds the values of several keys at once.
+        /// Keys are looked up with `WHERE key IN (...)` statements of up to `SQLITE_CONTAINERS_BULK_MAX_ROWS` keys,
+        /// and the connection lock is taken once for the whole batch. Keys that are not found are skipped.
+        /// \tparam KeyContainerT Container type of the keys (e.g., std::vector or std::set).
+        /// \tparam ContainerT Container type receiving the pairs (std::multimap or std::unordered_multimap).
+        /// \param keys The keys to search for.
+        /// \param container Container receiving the found key-value pairs.
+        /// \return The number of rows found.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class KeyContainerT, template <class...> class ContainerT, class... KeyArgs, class... ContainerArgs>
+        std::size_t find_many(const KeyContainerT<KeyT, KeyArgs...>& keys, ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            const auto on_pair = [&container](KeyT& key, ValueT& value, const std::size_t& value_count) {
+                add_value(container, key, value, value_count);
+            };
+            if (auto reader = db_acquire_reader()) {
+                return db_find_many(reader->stmts.find_many, keys, on_pair);
+            }
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            return db_find_many(m_bulk_find, keys, on_pair);
+        }
+
+        /// \brief Finds the values of several keys at once.
+        /// \tparam KeyContainerT Container type of the keys (e.g., std::vector or std::set).
+        /// \tparam ContainerT Template for the outer container type (e.g., std::map or std::unordered_map).
+        /// \tparam ValueContainerT Template for the container type used for values (e.g., std::vector, std::set).
+        /// \param keys The keys to search for.
+        /// \param container Container receiving the found values of each key.
+        /// \return The number of rows found.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class KeyContainerT, template <class...> class ContainerT, template <class...> class ValueContainerT, class... KeyArgs, class... ContainerArgs, class... ValueArgs>
+        std::size_t find_many(const KeyContainerT<KeyT, KeyArgs...>& keys, ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container) {
+            const auto on_pair = [&container](KeyT& key, ValueT& value, const std::size_t& value_count) {
+                add_value(container[key], value, value_count);
+            };
+            if (auto reader = db_acquire_reader()) {
+                return db_find_many(reader->stmts.find_many, keys, on_pair);
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            return db_find(key, values);
+            return db_find_many(m_bulk_find, keys, on_pair);
         }
 
         /// \brief Returns the number of elements in the database.
@@ -432,8 +582,11 @@ namespace sqlite_containers {
         /// \return The number of key-value pairs.
         /// \throws sqlite_exception if an SQLite error occurs.
         std::size_t count() const {
+            if (auto reader = db_acquire_reader()) {
+                return db_count_key(reader->stmts.count);
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            return db_count_key();
+            return db_count_key(m_stmt_count_key);
         }
 
         /// \brief Checks if the database is empty.
@@ -441,7 +594,7 @@ namespace sqlite_containers {
         /// \return True if the database is empty, false otherwise.
         /// \throws sqlite_exception if an SQLite error occurs.
         bool empty() const {
-            return (db_count_key() == 0);
+            return (count() == 0);
         }
 
         /// \brief Removes a specific key-value pair from the database.
@@ -449,16 +602,32 @@ namespace sqlite_containers {
         /// \param value The value of the pair to be removed.
         /// \throws sqlite_exception if an SQLite error occurs.
         void remove(const KeyT &key, const ValueT &value) {
+            if (m_async_writes) {
+                async_enqueue([this, key, value]() {
+                    db_remove_key_value(key, value);
+                });
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_remove_key_value(key, value);
+            db_group_write([this, &key, &value]() {
+                db_remove_key_value(key, value);
+            }, get_byte_size(key) + get_byte_size(value));
         }
 
         /// \brief Removes all values associated with a key from the database.
         /// \param key The key of the pairs to be removed.
         /// \throws sqlite_exception if an SQLite error occurs.
         void remove(const KeyT &key) {
+            if (m_async_writes) {
+                async_enqueue([this, key]() {
+                    db_remove_all_values(key);
+                });
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_remove_all_values(key);
+            db_group_write([this, &key]() {
+                db_remove_all_values(key);
+            }, get_byte_size(key));
         }
 
         /// \brief Clears all key-value pairs from the database with a transaction.
@@ -475,21 +644,181 @@ namespace sqlite_containers {
         /// \throws sqlite_exception if an SQLite error occurs.
         void clear() {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             db_clear();
         }
 
+        // --- Asynchronous methods ---
+
+        /// \brief Inserts a key-value pair on the I/O thread of the container (see `async_call()`).
+        /// Consecutive single-row `async_*` writes queued together share one transaction.
+        /// With `Config::use_async` the call runs insert() instead.
+        /// \param key The key to be inserted.
+        /// \param value The value to be inserted.
+        /// \return Future completing once the pair is written.
+        AsyncResult<void> async_insert(const KeyT &key, const ValueT &value) {
+            if (m_async_writes) {
+                return async_call([this, key, value]() {
+                    insert(key, value);
+                });
+            }
+            return async_write([this, key, value]() {
+                db_group_write([this, &key, &value]() {
+                    db_insert(key, value);
+                }, get_byte_size(key) + get_byte_size(value));
+            });
+        }
+
+        /// \brief Inserts a key-value pair on the I/O thread of the container.
+        /// \param pair The key-value pair to be inserted.
+        /// \return Future completing once the pair is written.
+        AsyncResult<void> async_insert(const std::pair<KeyT, ValueT> &pair) {
+            return async_insert(pair.first, pair.second);
+        }
+
+        /// \brief Sets the count of values of a key-value pair on the I/O thread of the container.
+        /// \param key The key of the pair.
+        /// \param value The value of the pair.
+        /// \param value_count The count to set.
+        /// \return Future completing once the count is written.
+        AsyncResult<void> async_set_value_count(const KeyT& key, const ValueT& value, const std::size_t& value_count) {
+            if (m_async_writes) {
+                return async_call([this, key, value, value_count]() {
+                    set_value_count(key, value, value_count);
+                });
+            }
+            return async_write([this, key, value, value_count]() {
+                db_group_write([this, &key, &value, &value_count]() {
+                    db_set_value_count_key_value(key, value, value_count);
+                }, get_byte_size(key) + get_byte_size(value));
+            });
+        }
+
+        /// \brief Removes a specific key-value pair on the I/O thread of the container.
+        /// \param key The key of the pair to be removed.
+        /// \param value The value of the pair to be removed.
+        /// \return Future completing once the pair is removed.
+        AsyncResult<void> async_remove(const KeyT &key, const ValueT &value) {
+            if (m_async_writes) {
+                return async_call([this, key, value]() {
+                    remove(key, value);
+                });
+            }
+            return async_write([this, key, value]() {
+                db_group_write([this, &key, &value]() {
+                    db_remove_key_value(key, value);
+                }, get_byte_size(key) + get_byte_size(value));
+            });
+        }
+
+        /// \brief Removes all values of a key on the I/O thread of the container.
+        /// \param key The key of the pairs to be removed.
+        /// \return Future completing once the pairs are removed.
+        AsyncResult<void> async_remove(const KeyT &key) {
+            if (m_async_writes) {
+                return async_call([this, key]() {
+                    remove(key);
+                });
+            }
+            return async_write([this, key]() {
+                db_group_write([this, &key]() {
+                    db_remove_all_values(key);
+                }, get_byte_size(key));
+            });
+        }
+
+        /// \brief Finds the values of a key on the I/O thread of the container.
+        /// \tparam ContainerT Container type of the values (e.g., std::vector or std::set).
+        /// \param key The key to search for.
+        /// \return Future receiving the values, empty if the key was not found.
+        template<template <class...> class ContainerT = std::vector>
+        AsyncResult<ContainerT<ValueT>> async_find(const KeyT &key) {
+            return async_call([this, key]() {
+                ContainerT<ValueT> values;
+                find(key, values);
+                return values;
+            });
+        }
+
+        /// \brief Returns the number of keys on the I/O thread of the container.
+        /// \return Future receiving the number of unique keys.
+        AsyncResult<std::size_t> async_count() {
+            return async_call([this]() {
+                return count();
+            });
+        }
+
+        /// \brief Loads data from the database into the container on the I/O thread of the container.
+        /// \param container Container receiving the pairs; it must stay alive and untouched until the future is ready.
+        /// \return Future completing once the container is filled.
+        template<class ContainerT>
+        AsyncResult<void> async_load(ContainerT& container) {
+            return async_call([this, &container]() {
+                load(container);
+            });
+        }
+
+        /// \brief Retrieves all key-value pairs on the I/O thread of the container.
+        /// \tparam ContainerT Container type (std::map, std::unordered_map, std::multimap or std::unordered_multimap).
+        /// \return Future receiving the container with all pairs.
+        template<template <class...> class ContainerT = std::multimap>
+        AsyncResult<ContainerT<KeyT, ValueT>> async_retrieve_all() {
+            return async_call([this]() {
+                return retrieve_all<ContainerT>();
+            });
+        }
+
+        /// \brief Appends the content of the container on the I/O thread of the container.
+        /// \tparam ContainerT Any container accepted by append().
+        /// \param container Container with content to be appended; it is copied into the call.
+        /// \return Future completing once the pairs are written.
+        template<class ContainerT>
+        AsyncResult<void> async_append(ContainerT container) {
+            return async_call([this, container = std::move(container)]() {
+                append(container);
+            });
+        }
+
+        /// \brief Reconciles the database with the container on the I/O thread of the container.
+        /// \tparam ContainerT Any container accepted by reconcile().
+        /// \param container Container to be reconciled with the database; it is copied into the call.
+        /// \return Future completing once the database matches the container.
+        template<class ContainerT>
+        AsyncResult<void> async_reconcile(ContainerT container) {
+            return async_call([this, container = std::move(container)]() {
+                reconcile(container);
+            });
+        }
+
+        /// \brief Applies recorded changes on the I/O thread of the container.
+        /// \param log Changes to apply; it is copied into the call.
+        /// \return Future completing once the changes are written.
+        AsyncResult<void> async_apply_delta(MultiChangeLog<KeyT, ValueT> log) {
+            return async_call([this, log = std::move(log)]() {
+                apply_delta(log);
+            });
+        }
+
+        /// \brief Clears all key-value pairs on the I/O thread of the container.
+        /// \return Future completing once the tables are cleared.
+        AsyncResult<void> async_clear() {
+            return async_call([this]() {
+                clear();
+            });
+        }
+
     private:
 
         // Statements for loading and managing keys, values, and key-value pairs
         SqliteStmt m_stmt_load;                    ///< Statement for loading data from the database.
 
-        SqliteStmt m_stmt_insert_key;              ///< Statement for inserting a key.
-        SqliteStmt m_stmt_insert_value;            ///< Statement for inserting a value.
-        SqliteStmt m_stmt_insert_key_value;        ///< Statement for inserting a key-value pair.
+        SqliteStmt m_stmt_insert_key;              ///< Statement for inserting a key and returning its ID.
+        SqliteStmt m_stmt_insert_value;            ///< Statement for inserting a value and returning its ID.
+        SqliteStmt m_stmt_increment_value_count;   ///< Statement for inserting a key-value pair or incrementing its count.
 
         SqliteStmt m_stmt_get_key_id;              ///< Statement for retrieving key ID.
         SqliteStmt m_stmt_get_value_id;            ///< Statement for retrieving value ID.
-        SqliteStmt m_stmt_get_value_count;         ///< Statement for retrieving the count of a value.
         mutable SqliteStmt m_stmt_get_value_count_kv; ///< Statement for retrieving the count of a value by key-value pair.
 
         mutable SqliteStmt m_stmt_count_key;       ///< Statement for counting the number of keys.
@@ -497,17 +826,21 @@ namespace sqlite_containers {
         // Statements for temporary tables
         SqliteStmt m_stmt_insert_key_temp;         ///< Statement for inserting keys into the temporary table.
         SqliteStmt m_stmt_insert_value_temp;       ///< Statement for inserting values into the temporary table.
+        SqliteStmt m_stmt_insert_key_value_temp;   ///< Statement for inserting key-value pair IDs into the temporary table.
 
         // Statements for purging old keys and values
         SqliteStmt m_stmt_purge_keys;              ///< Statement for purging old keys.
         SqliteStmt m_stmt_purge_values;            ///< Statement for purging old values.
+        SqliteStmt m_stmt_purge_key_values;        ///< Statement for purging old key-value pairs.
 
         // Statements for clearing temporary tables
         SqliteStmt m_stmt_clear_keys_temp;         ///< Statement for clearing the temporary keys table.
         SqliteStmt m_stmt_clear_values_temp;       ///< Statement for clearing the temporary values table.
+        SqliteStmt m_stmt_clear_key_values_temp;   ///< Statement for clearing the temporary key-value pairs table.
 
         // Statements for managing value counts
-        SqliteStmt m_stmt_set_value_count;         ///< Statement for setting value count for a key-value pair.
+        SqliteStmt m_stmt_set_value_count;         ///< Statement for inserting a key-value pair or setting its count.
+        SqliteStmt m_stmt_add_value_count;         ///< Statement for inserting a key-value pair or adding to its count.
         SqliteStmt m_stmt_set_value_count_kv;      ///< Statement for setting value count by key-value pair.
 
         SqliteStmt m_stmt_find;                    ///< Statement for finding values by key.
@@ -520,6 +853,35 @@ namespace sqlite_containers {
         SqliteStmt m_stmt_clear_values;            ///< Statement for clearing the values table.
         SqliteStmt m_stmt_clear_key_values;        ///< Statement for clearing the key-value pairs table.
 
+        ChunkedStmt m_bulk_find;                   ///< Multi-key statement for finding values by keys.
+
+        /// \brief Prepared statements of a read-only connection.
+        struct ReadStmts {
+            SqliteStmt  load;           ///< Statement for loading data from the database.
+            SqliteStmt  find;           ///< Statement for finding values by key.
+            SqliteStmt  count;          ///< Statement for counting the number of keys.
+            ChunkedStmt find_many;      ///< Multi-key statement for finding values by keys.
+        };
+
+        mutable ReaderPool<ReadStmts> m_readers;   ///< Read-only connections (see `Config::read_connections`).
+
+        /// \brief Leases a read-only connection if reads may bypass the main connection.
+        /// \return Lease over a reader, or an empty lease if reads must use the main connection.
+        typename ReaderPool<ReadStmts>::Lease db_acquire_reader() const {
+            if (!db_can_use_readers()) return typename ReaderPool<ReadStmts>::Lease();
+            return m_readers.acquire();
+        }
+
+        // Caches of row IDs, valid for the lifetime of the connection
+        std::unordered_map<KeyT, int64_t, Hash<KeyT>, EqualTo<KeyT>> m_key_ids;          ///< Cached key IDs.
+        std::unordered_map<ValueT, int64_t, Hash<ValueT>, EqualTo<ValueT>> m_value_ids;  ///< Cached value IDs.
+
+        /// \brief Decodes a row of `m_stmt_load`.
+        static std::tuple<KeyT, ValueT, std::size_t> decode_row(SqliteStmt& stmt) {
+            return std::tuple<KeyT, ValueT, std::size_t>(
+                stmt.extract_column<KeyT>(0), stmt.extract_column<ValueT>(1), stmt.extract_column<std::size_t>(2));
+        }
+
         /// \brief Creates the tables in the database.
         /// This method creates both the main and temporary tables for keys, values, and key-value pairs.
         /// \param config Configuration settings for the database, such as table names.
@@ -530,6 +892,9 @@ namespace sqlite_containers {
 
             const std::string keys_temp_table = config.table_name.empty() ? "keys_temp_store" : config.table_name + "_temp_keys";
             const std::string values_temp_table = config.table_name.empty() ? "values_temp_store" : config.table_name + "_temp_values";
+            const std::string key_value_temp_table = config.table_name.empty() ? "key_value_temp_store" : config.table_name + "_temp_key_value";
+
+            db_clear_id_cache();
 
             // Create main tables if they do not exist
             const std::string create_keys_table_sql =
@@ -551,9 +916,20 @@ namespace sqlite_containers {
                 "value_count INTEGER DEFAULT 1, "
                 "FOREIGN KEY(key_id) REFERENCES " + keys_table + "(id) ON DELETE CASCADE, "
                 "FOREIGN KEY(value_id) REFERENCES " + values_table + "(id) ON DELETE CASCADE, "
-                "PRIMARY KEY (key_id, value_id));";
+                "PRIMARY KEY (key_id, value_id))" + to_table_options(config.table_layout) + ";";
             execute(m_sqlite_db, create_key_value_table_sql);
 
+            // Index the pairs by value, so that removing a value does not scan the whole table for cascade deletes
+            execute(m_sqlite_db,
+                "CREATE INDEX IF NOT EXISTS " + key_value_table + "_value_id ON " + key_value_table + " (value_id);");
+
+            // A rowid pair table keeps the value counts outside its primary key index, so cover them with an index
+            if (config.table_layout == TableLayout::ROWID) {
+                execute(m_sqlite_db,
+                    "CREATE INDEX IF NOT EXISTS " + key_value_table + "_covering ON " + key_value_table +
+                    " (key_id, value_id, value_count);");
+            }
+
             // Create temporary tables for synchronization
             const std::string create_keys_temp_table_sql =
                 "CREATE TEMPORARY TABLE IF NOT EXISTS " + keys_temp_table + " ("
@@ -567,6 +943,13 @@ namespace sqlite_containers {
                 "value " + get_sqlite_type<ValueT>() + " NOT NULL UNIQUE);";
             execute(m_sqlite_db, create_values_temp_table_sql);
 
+            const std::string create_key_value_temp_table_sql =
+                "CREATE TEMPORARY TABLE IF NOT EXISTS " + key_value_temp_table + " ("
+                "key_id INTEGER NOT NULL, "
+                "value_id INTEGER NOT NULL, "
+                "PRIMARY KEY (key_id, value_id)) WITHOUT ROWID;";
+            execute(m_sqlite_db, create_key_value_temp_table_sql);
+
             // Enable foreign keys
             execute(m_sqlite_db, "PRAGMA foreign_keys = ON;");
 
@@ -575,41 +958,58 @@ namespace sqlite_containers {
                 "SELECT " + keys_table + ".key, " + values_table + ".value, " + key_value_table + ".value_count "
                 "FROM " + keys_table + " "
                 "JOIN " + key_value_table + " ON " + keys_table + ".id = " + key_value_table + ".key_id "
-                "JOIN " + values_table + " ON " + key_value_table + ".value_id = " + values_table + ".id;");
-
-            m_stmt_insert_key.init(m_sqlite_db, "INSERT OR IGNORE INTO " + keys_table + " (key) VALUES (?);");
-            m_stmt_insert_value.init(m_sqlite_db, "INSERT OR IGNORE INTO " + values_table + " (value) VALUES (?);");
-            m_stmt_insert_key_value.init(m_sqlite_db, "INSERT INTO " + key_value_table + " (key_id, value_id) VALUES (?, ?);");
-
-            m_stmt_get_key_id.init(m_sqlite_db, "SELECT id FROM " + keys_table + " WHERE key = ?;");
-            m_stmt_get_value_id.init(m_sqlite_db, "SELECT id FROM " + values_table + " WHERE value = ?;");
-            m_stmt_get_value_count.init(m_sqlite_db, "SELECT value_count FROM " + key_value_table + " WHERE key_id = ? AND value_id = ?;");
+                "JOIN " + values_table + " ON " + key_value_table + ".value_id = " + values_table + ".id;", true);
+
+#           if SQLITE_VERSION_NUMBER >= 3035000
+            m_stmt_insert_key.init(m_sqlite_db, "INSERT INTO " + keys_table + " (key) VALUES (?) ON CONFLICT(key) DO NOTHING RETURNING id;", true);
+            m_stmt_insert_value.init(m_sqlite_db, "INSERT INTO " + values_table + " (value) VALUES (?) ON CONFLICT(value) DO NOTHING RETURNING id;", true);
+#           else
+            m_stmt_insert_key.init(m_sqlite_db, "INSERT OR IGNORE INTO " + keys_table + " (key) VALUES (?);", true);
+            m_stmt_insert_value.init(m_sqlite_db, "INSERT OR IGNORE INTO " + values_table + " (value) VALUES (?);", true);
+#           endif
+            m_stmt_increment_value_count.init(m_sqlite_db,
+                "INSERT INTO " + key_value_table + " (key_id, value_id) VALUES (?, ?) "
+                "ON CONFLICT(key_id, value_id) DO UPDATE SET value_count = value_count + 1;", true);
+
+            m_stmt_get_key_id.init(m_sqlite_db, "SELECT id FROM " + keys_table + " WHERE key = ?;", true);
+            m_stmt_get_value_id.init(m_sqlite_db, "SELECT id FROM " + values_table + " WHERE value = ?;", true);
             m_stmt_get_value_count_kv.init(m_sqlite_db,
                 "SELECT value_count FROM " + key_value_table +
                 " WHERE key_id = (SELECT id FROM " + keys_table +
                 " WHERE key = ?) AND value_id = (SELECT id FROM " + values_table +
-                " WHERE value = ?);");
+                " WHERE value = ?);", true);
 
-            m_stmt_count_key.init(m_sqlite_db, "SELECT COUNT(*) FROM " + keys_table + ";");
+            m_stmt_count_key.init(m_sqlite_db, "SELECT COUNT(*) FROM " + keys_table + ";", true);
 
             // Initialize prepared statements for temporary tables
-            m_stmt_insert_key_temp.init(m_sqlite_db, "INSERT OR IGNORE INTO " + keys_temp_table + " (key) VALUES (?);");
-            m_stmt_insert_value_temp.init(m_sqlite_db, "INSERT OR IGNORE INTO " + values_temp_table + " (value) VALUES (?);");
+            m_stmt_insert_key_temp.defer(m_sqlite_db, "INSERT OR IGNORE INTO " + keys_temp_table + " (key) VALUES (?);", true);
+            m_stmt_insert_value_temp.defer(m_sqlite_db, "INSERT OR IGNORE INTO " + values_temp_table + " (value) VALUES (?);", true);
+            m_stmt_insert_key_value_temp.defer(m_sqlite_db, "INSERT OR IGNORE INTO " + key_value_temp_table + " (key_id, value_id) VALUES (?, ?);", true);
 
             // Statements for purging old data and clearing temporary tables
-            m_stmt_purge_keys.init(m_sqlite_db, "DELETE FROM " + keys_table + " WHERE key NOT IN (SELECT key FROM " + keys_temp_table + ");");
-            m_stmt_purge_values.init(m_sqlite_db, "DELETE FROM " + values_table + " WHERE value NOT IN (SELECT value FROM " + values_temp_table + ");");
+            m_stmt_purge_keys.defer(m_sqlite_db, "DELETE FROM " + keys_table + " WHERE key NOT IN (SELECT key FROM " + keys_temp_table + ");", true);
+            m_stmt_purge_values.defer(m_sqlite_db, "DELETE FROM " + values_table + " WHERE value NOT IN (SELECT value FROM " + values_temp_table + ");", true);
+            m_stmt_purge_key_values.defer(m_sqlite_db,
+                "DELETE FROM " + key_value_table + " WHERE NOT EXISTS (SELECT 1 FROM " + key_value_temp_table +
+                " WHERE " + key_value_temp_table + ".key_id = " + key_value_table + ".key_id AND " +
+                key_value_temp_table + ".value_id = " + key_value_table + ".value_id);", true);
 
-            m_stmt_clear_keys_temp.init(m_sqlite_db, "DELETE FROM " + keys_temp_table + ";");
-            m_stmt_clear_values_temp.init(m_sqlite_db, "DELETE FROM " + values_temp_table + ";");
+            m_stmt_clear_keys_temp.defer(m_sqlite_db, "DELETE FROM " + keys_temp_table + ";", true);
+            m_stmt_clear_values_temp.defer(m_sqlite_db, "DELETE FROM " + values_temp_table + ";", true);
+            m_stmt_clear_key_values_temp.defer(m_sqlite_db, "DELETE FROM " + key_value_temp_table + ";", true);
 
             // Statements for setting value counts
-            m_stmt_set_value_count.init(m_sqlite_db, "UPDATE " + key_value_table + " SET value_count = ? WHERE key_id = ? AND value_id = ?;");
-            m_stmt_set_value_count_kv.init(m_sqlite_db,
+            m_stmt_set_value_count.init(m_sqlite_db,
+                "INSERT INTO " + key_value_table + " (key_id, value_id, value_count) VALUES (?, ?, ?) "
+                "ON CONFLICT(key_id, value_id) DO UPDATE SET value_count = excluded.value_count;", true);
+            m_stmt_add_value_count.defer(m_sqlite_db,
+                "INSERT INTO " + key_value_table + " (key_id, value_id, value_count) VALUES (?, ?, ?) "
+                "ON CONFLICT(key_id, value_id) DO UPDATE SET value_count = value_count + excluded.value_count;", true);
+            m_stmt_set_value_count_kv.defer(m_sqlite_db,
                 "UPDATE " + key_value_table +
                 " SET value_count = ? WHERE key_id = (SELECT id FROM " + keys_table +
                 " WHERE key = ?) AND value_id = (SELECT id FROM " + values_table +
-                " WHERE value = ?);");
+                " WHERE value = ?);", true);
 
             // Statement for finding key-value pairs
             m_stmt_find.init(m_sqlite_db,
@@ -617,52 +1017,107 @@ namespace sqlite_containers {
                 "FROM " + values_table + " v "
                 "JOIN " + key_value_table + " kv ON v.id = kv.value_id "
                 "JOIN " + keys_table + " k ON kv.key_id = k.id "
-                "WHERE k.key = ?;");
+                "WHERE k.key = ?;", true);
 
             // Statements for removing key-value pairs and clearing tables
-            m_stmt_remove_key_value.init(m_sqlite_db, "DELETE FROM " + key_value_table + " WHERE key_id = (SELECT id FROM " + keys_table + " WHERE key = ?) AND value_id = (SELECT id FROM " + values_table + " WHERE value = ?);");
-            m_stmt_remove_all_values.init(m_sqlite_db, "DELETE FROM " + keys_table + " WHERE key = ?");
+            m_stmt_remove_key_value.init(m_sqlite_db, "DELETE FROM " + key_value_table + " WHERE key_id = (SELECT id FROM " + keys_table + " WHERE key = ?) AND value_id = (SELECT id FROM " + values_table + " WHERE value = ?);", true);
+            m_stmt_remove_all_values.init(m_sqlite_db, "DELETE FROM " + keys_table + " WHERE key = ?", true);
+
+            m_stmt_clear_keys.defer(m_sqlite_db, "DELETE FROM " + keys_table + ";", true);
+            m_stmt_clear_values.defer(m_sqlite_db, "DELETE FROM " + values_table + ";", true);
+            m_stmt_clear_key_values.defer(m_sqlite_db, "DELETE FROM " + key_value_table + ";", true);
+
+            // Multi-key statement for batched lookups
+            m_bulk_find.init(m_sqlite_db,
+                "SELECT k.key, v.value, kv.value_count "
+                "FROM " + keys_table + " k "
+                "JOIN " + key_value_table + " kv ON k.id = kv.key_id "
+                "JOIN " + values_table + " v ON kv.value_id = v.id "
+                "WHERE k.key IN (", "?", ", ", ");", 1);
+        }
+
+        /// \brief Opens the read-only connections and prepares their statements.
+        /// \param config Configuration settings for the database.
+        void db_open_readers(const Config &config) override final {
+            const std::string keys_table = config.table_name.empty() ? "keys_store" : config.table_name + "_keys";
+            const std::string values_table = config.table_name.empty() ? "values_store" : config.table_name + "_values";
+            const std::string key_value_table = config.table_name.empty() ? "key_value_store" : config.table_name + "_key_value";
+
+            m_readers.open(config, [&](sqlite3* sqlite_db, ReadStmts& stmts) {
+                stmts.load.init(sqlite_db,
+                    "SELECT " + keys_table + ".key, " + values_table + ".value, " + key_value_table + ".value_count "
+                    "FROM " + keys_table + " "
+                    "JOIN " + key_value_table + " ON " + keys_table + ".id = " + key_value_table + ".key_id "
+                    "JOIN " + values_table + " ON " + key_value_table + ".value_id = " + values_table + ".id;", true);
+                stmts.find.init(sqlite_db,
+                    "SELECT v.value, kv.value_count "
+                    "FROM " + values_table + " v "
+                    "JOIN " + key_value_table + " kv ON v.id = kv.value_id "
+                    "JOIN " + keys_table + " k ON kv.key_id = k.id "
+                    "WHERE k.key = ?;", true);
+                stmts.count.init(sqlite_db, "SELECT COUNT(*) FROM " + keys_table + ";", true);
+                stmts.find_many.init(sqlite_db,
+                    "SELECT k.key, v.value, kv.value_count "
+                    "FROM " + keys_table + " k "
+                    "JOIN " + key_value_table + " kv ON k.id = kv.key_id "
+                    "JOIN " + values_table + " v ON kv.value_id = v.id "
+                    "WHERE k.key IN (", "?", ", ", ");", 1);
+            });
+        }
+
+        /// \brief Closes the read-only connections.
+        void db_close_readers() override final {
+            m_readers.close();
+        }
+
+        /// \brief Drops the cached IDs, since rows inserted by the rolled back transaction no longer exist.
+        void on_db_rollback() override final {
+            db_clear_id_cache();
+        }
 
-            m_stmt_clear_keys.init(m_sqlite_db, "DELETE FROM " + keys_table + ";");
-            m_stmt_clear_values.init(m_sqlite_db, "DELETE FROM " + values_table + ";");
-            m_stmt_clear_key_values.init(m_sqlite_db, "DELETE FROM " + key_value_table + ";");
+        /// \brief Forgets the key and value ids of the replaced database.
+        void on_db_restore() override final {
+            db_clear_id_cache();
         }
 
         /// \brief Loads data from the database into the container.
         /// \tparam ContainerT Template for the container type.
+        /// \param stmt Load statement of the connection to read from.
         /// \param container Container to load the data into.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void db_load(ContainerT<KeyT, ValueT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void db_load(SqliteStmt& stmt, ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::LOAD);
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
             int err;
             try {
                 for (;;) {
-                    while ((err = m_stmt_load.step()) == SQLITE_ROW) {
-                        KeyT key = m_stmt_load.extract_column<KeyT>(0);
-                        ValueT value = m_stmt_load.extract_column<ValueT>(1);
-                        size_t value_count = m_stmt_load.extract_column<size_t>(2);
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        KeyT key = stmt.extract_column<KeyT>(0);
+                        ValueT value = stmt.extract_column<ValueT>(1);
+                        size_t value_count = stmt.extract_column<size_t>(2);
                         add_value(container, key, value, value_count);
                     }
                     if (err == SQLITE_DONE) {
-                        m_stmt_load.reset();
+                        stmt.reset();
                         return;
                     }
                     if (err == SQLITE_BUSY) {
                         // Handle busy database, retry reading
-                        m_stmt_load.reset();
-                        sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
                         continue;
                     }
                     // Handle SQLite errors
                     std::string err_msg = "SQLite error: ";
                     err_msg += std::to_string(err);
                     err_msg += ", ";
-                    err_msg += sqlite3_errmsg(m_sqlite_db);
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
                     throw sqlite_exception(err_msg, err);
                 }
             } catch (...) {
                 db_handle_exception(
-                    std::current_exception(), {&m_stmt_load},
+                    std::current_exception(), {&stmt},
                     "Unknown error occurred while loading data from database.");
             }
         }
@@ -670,39 +1125,42 @@ namespace sqlite_containers {
         /// \brief Loads data from the database into the container.
         /// \tparam ContainerT Template for the map container type.
         /// \tparam ValueContainerT Template for the container type used for values.
+        /// \param stmt Load statement of the connection to read from.
         /// \param container Container to load the data into.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT, template <class...> class ValueContainerT>
-        void db_load(ContainerT<KeyT, ValueContainerT<ValueT>>& container) {
+        template<template <class...> class ContainerT, template <class...> class ValueContainerT, class... ContainerArgs, class... ValueArgs>
+        void db_load(SqliteStmt& stmt, ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::LOAD);
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
             int err;
             try {
                 for (;;) {
-                    while ((err = m_stmt_load.step()) == SQLITE_ROW) {
-                        KeyT key = m_stmt_load.extract_column<KeyT>(0);
-                        ValueT value = m_stmt_load.extract_column<ValueT>(1);
-                        const size_t value_count = m_stmt_load.extract_column<size_t>(2);
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        KeyT key = stmt.extract_column<KeyT>(0);
+                        ValueT value = stmt.extract_column<ValueT>(1);
+                        const size_t value_count = stmt.extract_column<size_t>(2);
                         add_value(container[key], value, value_count);
                     }
                     if (err == SQLITE_DONE) {
-                        m_stmt_load.reset();
+                        stmt.reset();
                         return;
                     }
                     if (err == SQLITE_BUSY) {
                         // Handle busy database, retry reading
-                        m_stmt_load.reset();
-                        sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
                         continue;
                     }
                     // Handle SQLite errors
                     std::string err_msg = "SQLite error: ";
                     err_msg += std::to_string(err);
                     err_msg += ", ";
-                    err_msg += sqlite3_errmsg(m_sqlite_db);
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
                     throw sqlite_exception(err_msg, err);
                 }
             } catch (...) {
                 db_handle_exception(
-                    std::current_exception(), {&m_stmt_load},
+                    std::current_exception(), {&stmt},
                     "Unknown error occurred while loading data from database.");
             }
         }
@@ -711,35 +1169,18 @@ namespace sqlite_containers {
         /// \tparam ContainerT Template for the container type.
         /// \param container Container with content to be appended to the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void db_append(const ContainerT<KeyT, ValueT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void db_append(const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
             try {
                 for (const auto& pair : container) {
-                    // Insert the key if it doesn't already exist
-                    db_insert_key(pair.first);
-                    // Insert the value if it doesn't already exist
-                    db_insert_value(pair.second);
-                    // Get the key_id
-                    const int64_t key_id = db_get_key_id(pair.first);
-                    if (key_id == -1) continue;
-                    // Get the value_id
-                    const int64_t value_id = db_get_value_id(pair.second);
-                    if (value_id == -1) continue;
-                    // Get the value_count
-                    const size_t value_count = db_get_value_count(key_id, value_id);
-                    if (value_count) {
-                        // Update the value_count with the key_id and value_id
-                        db_set_value_count(key_id, value_id, value_count + 1);
-                    } else {
-                        // Insert the key-value pair
-                        db_insert_key_value(key_id, value_id);
-                    }
+                    db_upsert_pair(m_stmt_increment_value_count, pair.first, pair.second);
                 }
             } catch (...) {
+                db_clear_id_cache();
                 db_handle_exception(
                     std::current_exception(), {
                         &m_stmt_insert_key, &m_stmt_insert_value, &m_stmt_get_key_id,
-                        &m_stmt_get_value_id, &m_stmt_get_value_count, &m_stmt_set_value_count
+                        &m_stmt_get_value_id, &m_stmt_increment_value_count
                     },
                     "Unknown error occurred while appending key-value pairs to the database.");
             }
@@ -750,75 +1191,43 @@ namespace sqlite_containers {
         /// \tparam ValueContainerT Template for the container type used for values.
         /// \param container Container with content to be appended to the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT, template <class...> class ValueContainerT>
+        template<template <class...> class ContainerT, template <class...> class ValueContainerT, class... ContainerArgs, class... ValueArgs>
         void db_append(
-                const ContainerT<KeyT, ValueContainerT<ValueT>>& container) {
+                const ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container) {
             try {
                 for (const auto& pair : container) {
-                    // Insert the key if it doesn't already exist
-                    db_insert_key(pair.first);
-                    // Get the key_id
-                    const int64_t key_id = db_get_key_id(pair.first);
-                    if (key_id == -1) continue;
                     for (const auto& value : pair.second) {
-                        // Insert the value if it doesn't already exist
-                        db_insert_value(value);
-                        // Get the value_id
-                        const int64_t value_id = db_get_value_id(value);
-                        if (value_id == -1) continue;
-                        // Get the value_count
-                        const size_t value_count = db_get_value_count(key_id, value_id);
-                        if (value_count) {
-                            // Update the value_count with the key_id and value_id
-                            db_set_value_count(key_id, value_id, value_count + 1);
-                        } else {
-                            // Insert the key-value pair
-                            db_insert_key_value(key_id, value_id);
-                        }
+                        db_upsert_pair(m_stmt_increment_value_count, pair.first, value);
                     }
                 }
             } catch (...) {
+                db_clear_id_cache();
                 db_handle_exception(
                     std::current_exception(), {
                         &m_stmt_insert_key, &m_stmt_insert_value, &m_stmt_get_key_id,
-                        &m_stmt_get_value_id, &m_stmt_get_value_count, &m_stmt_set_value_count
+                        &m_stmt_get_value_id, &m_stmt_increment_value_count
                     },
                     "Unknown error occurred while appending key-value pairs to the database.");
             }
         }
 
         /// \brief Inserts a key-value pair into the database.
+        /// Increments the count of the pair if it already exists.
         /// \param key The key to be inserted.
         /// \param value The value to be inserted.
         /// \throws sqlite_exception if an SQLite error occurs.
         void db_insert(
                 const KeyT &key,
                 const ValueT &value) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::INSERT);
             try {
-                // Insert the key if it doesn't already exist
-                db_insert_key(key);
-                // Insert the value if it doesn't already exist
-                db_insert_value(value);
-                // Get the key_id
-                const int64_t key_id = db_get_key_id(key);
-                if (key_id == -1) throw sqlite_exception("Key ID not found.");
-                // Get the value_id
-                const int64_t value_id = db_get_value_id(value);
-                if (value_id == -1) throw sqlite_exception("Value ID not found.");
-                // Get the value_count
-                const size_t value_count = db_get_value_count(key_id, value_id);
-                if (value_count) {
-                    // Update the value_count with the key_id and value_id
-                    db_set_value_count(key_id, value_id, value_count + 1);
-                } else {
-                    // Insert the key-value pair
-                    db_insert_key_value(key_id, value_id);
-                }
+                db_upsert_pair(m_stmt_increment_value_count, key, value);
             } catch (...) {
+                db_clear_id_cache();
                 db_handle_exception(
                     std::current_exception(), {
                         &m_stmt_insert_key, &m_stmt_insert_value, &m_stmt_get_key_id,
-                        &m_stmt_get_value_id, &m_stmt_get_value_count, &m_stmt_set_value_count
+                        &m_stmt_get_value_id, &m_stmt_increment_value_count
                     },
                     "Unknown error occurred while inserting key-value pair.");
             }
@@ -831,12 +1240,14 @@ namespace sqlite_containers {
         /// \tparam ContainerT Template for the container type (e.g., std::map, std::unordered_map).
         /// \param container The container with key-value pairs to reconcile with the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
+        template<template <class...> class ContainerT, class... ContainerArgs>
         void db_reconcile(
-                const ContainerT<KeyT, ValueT>& container) {
+                const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::RECONCILE);
             try {
-                // Collect value repetitions
-                std::unordered_map<KeyT, std::vector<std::pair<ValueT, int>>> temp_container;
+                // Collect value repetitions in an arena released at once when the reconcile ends
+                std::pmr::monotonic_buffer_resource arena;
+                std::pmr::unordered_map<KeyT, std::pmr::vector<std::pair<ValueT, int>>, Hash<KeyT>, EqualTo<KeyT>> temp_container(&arena);
                 for (const auto& pair : container) {
                     auto& vec = temp_container[pair.first];
                     auto it = find_or_insert(vec, pair.second);
@@ -845,42 +1256,25 @@ namespace sqlite_containers {
 
                 db_clear_temp_tables();
                 for (const auto& item : temp_container) {
-                    db_insert_key(item.first);
                     db_insert_key_temp(item.first);
                     for (const auto& pair : item.second) {
-                        db_insert_value(pair.first);
                         db_insert_value_temp(pair.first);
+                        const std::size_t value_count = pair.second;
+                        db_upsert_pair(m_stmt_set_value_count, item.first, pair.first, &value_count);
+                        db_insert_key_value_temp(item.first, pair.first);
                     }
                 }
-                for (const auto& pair : container) {
-                    const int64_t key_id = db_get_key_id(pair.first);
-                    if (key_id == -1) throw sqlite_exception("Failed to retrieve key ID for the provided key during reconciliation.");
-                    const int64_t value_id = db_get_value_id(pair.second);
-                    if (value_id == -1) throw sqlite_exception("Failed to retrieve value ID for the provided value during reconciliation.");
-                    const size_t value_count = db_get_value_count(key_id, value_id);
-                    if (!value_count) {
-                        db_insert_key_value(key_id, value_id);
-                    }
-                }
-
                 db_purge_old_data();
                 db_clear_temp_tables();
-                for (const auto& item : temp_container) {
-                    const int64_t key_id = db_get_key_id(item.first);
-                    if (key_id == -1) continue;
-                    for (const auto& pair : item.second) {
-                        const int64_t value_id = db_get_value_id(pair.first);
-                        if (value_id == -1) continue;
-                        db_set_value_count(key_id, value_id, pair.second);
-                    }
-                }
             } catch (...) {
+                db_clear_id_cache();
                 db_handle_exception(
                     std::current_exception(), {
                         &m_stmt_insert_key, &m_stmt_insert_value, &m_stmt_get_key_id,
-                        &m_stmt_get_value_id, &m_stmt_get_value_count, &m_stmt_set_value_count,
-                        &m_stmt_insert_key_temp, &m_stmt_insert_value_temp,
-                        &m_stmt_purge_keys, &m_stmt_purge_values, &m_stmt_clear_keys_temp, &m_stmt_clear_values_temp
+                        &m_stmt_get_value_id, &m_stmt_set_value_count,
+                        &m_stmt_insert_key_temp, &m_stmt_insert_value_temp, &m_stmt_insert_key_value_temp,
+                        &m_stmt_purge_keys, &m_stmt_purge_values, &m_stmt_purge_key_values,
+                        &m_stmt_clear_keys_temp, &m_stmt_clear_values_temp, &m_stmt_clear_key_values_temp
                     },
                     "Unknown error occurred while reconciling data.");
             }
@@ -889,52 +1283,21 @@ namespace sqlite_containers {
         // Helper function to find or insert value in a sorted vector
 
         /// \brief Finds or inserts a value into a sorted vector.
-        /// This method finds a value in the vector, or inserts it if it is not present. It uses
-        /// a specialized comparison depending on the type of value.
+        /// This method finds a value in the vector, or inserts it if it is not present. Values are
+        /// compared with `EqualTo<T>`.
+        /// \tparam VectorT The type of the vector of value counts, with any allocator.
         /// \tparam T The type of the value.
         /// \param vec The vector where the value will be searched or inserted.
         /// \param value The value to search or insert.
         /// \return Iterator to the position of the value in the vector.
-        template<typename T>
-        typename std::vector<std::pair<T, int>>::iterator find_or_insert(std::vector<std::pair<T, int>>& vec, const T& value,
-            typename std::enable_if<
-                    !std::is_integral<T>::value &&
-                    !std::is_floating_point<T>::value &&
-                    !std::is_same<T, std::string>::value &&
-                    !std::is_same<T, std::vector<char>>::value &&
-                    !std::is_same<T, std::vector<uint8_t>>::value &&
-                    std::is_trivially_copyable<T>::value
-                >::type* = 0) {
-            auto it = std::find_if(vec.begin(), vec.end(), [&value](const std::pair<T, int>& element) {
-                return byte_compare(element.first, value);
-            });
-            if (it == vec.end()) {
-                //it = vec.insert(it, {value, 0});
-                it = vec.emplace(it, std::make_pair(value, 0));
-            }
-            return it;
-        }
-
-        /// \brief Finds or inserts a value into a sorted vector.
-        /// This method finds a value in the vector, or inserts it if it is not present. It uses
-        /// a specialized comparison depending on the type of value.
-        /// \tparam T The type of the value.
-        /// \param vec The vector where the value will be searched or inserted.
-        /// \param value The value to search or insert.
-        /// \return Iterator to the position of the value in the vector.
-        template<typename T>
-        typename std::vector<std::pair<T, int>>::iterator find_or_insert(std::vector<std::pair<T, int>>& vec, const T& value,
-            typename std::enable_if<
-                    std::is_integral<T>::value ||
-                    std::is_floating_point<T>::value ||
-                    std::is_same<T, std::string>::value ||
-                    std::is_same<T, std::vector<char>>::value ||
-                    std::is_same<T, std::vector<uint8_t>>::value>::type* = 0) {
-            auto it = std::find_if(vec.begin(), vec.end(), [&value](const std::pair<T, int>& element) {
-                return element.first == value;
+        template<typename VectorT, typename T>
+        typename VectorT::iterator find_or_insert(VectorT& vec, const T& value) {
+            const EqualTo<T> equal_to;
+            auto it = std::find_if(vec.begin(), vec.end(), [&value, &equal_to](const std::pair<T, int>& element) {
+                return equal_to(element.first, value);
             });
             if (it == vec.end()) {
-                it = vec.insert(it, {value, 0});
+                it = vec.emplace(it, value, 0);
             }
             return it;
         }
@@ -944,12 +1307,14 @@ namespace sqlite_containers {
         /// \param container Container with content to reconcile with the database.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT, template <class...> class ValueContainerT>
+        template<template <class...> class ContainerT, template <class...> class ValueContainerT, class... ContainerArgs, class... ValueArgs>
         void db_reconcile(
-                const ContainerT<KeyT, ValueContainerT<ValueT>>& container) {
+                const ContainerT<KeyT, ValueContainerT<ValueT, ValueArgs...>, ContainerArgs...>& container) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::RECONCILE);
             try {
-                // Collect value repetitions
-                std::unordered_map<KeyT, std::unordered_map<ValueT, int>> temp_container;
+                // Collect value repetitions in an arena released at once when the reconcile ends
+                std::pmr::monotonic_buffer_resource arena;
+                std::pmr::unordered_map<KeyT, std::pmr::unordered_map<ValueT, int>> temp_container(&arena);
                 for (const auto& pair : container) {
                     auto it_key = temp_container.find(pair.first);
                     for (const ValueT& value : pair.second) {
@@ -968,70 +1333,86 @@ namespace sqlite_containers {
 
                 db_clear_temp_tables();
                 for (const auto& item : temp_container) {
-                    db_insert_key(item.first);
                     db_insert_key_temp(item.first);
                     for (const auto& pair : item.second) {
-                        db_insert_value(pair.first);
                         db_insert_value_temp(pair.first);
+                        const std::size_t value_count = pair.second;
+                        db_upsert_pair(m_stmt_set_value_count, item.first, pair.first, &value_count);
+                        db_insert_key_value_temp(item.first, pair.first);
                     }
                 }
-
-                for (const auto& pair : container) {
-                    const int64_t key_id = db_get_key_id(pair.first);
-                    if (key_id == -1) continue;
-                    for (const ValueT& value : pair.second) {
-                        const int64_t value_id = db_get_value_id(value);
-                        if (value_id == -1) continue;
-                        const size_t value_count = db_get_value_count(key_id, value_id);
-                        if (value_count) continue;
-                        db_insert_key_value(key_id, value_id);
-                    }
-                }
-
                 db_purge_old_data();
                 db_clear_temp_tables();
-                for (const auto& item : temp_container) {
-                    const int64_t key_id = db_get_key_id(item.first);
-                    if (key_id == -1) continue;
-                    for (const auto& pair : item.second) {
-                        const int64_t value_id = db_get_value_id(pair.first);
-                        if (value_id == -1) continue;
-                        db_set_value_count(key_id, value_id, pair.second);
-                    }
-                }
             } catch (...) {
+                db_clear_id_cache();
                 db_handle_exception(
                     std::current_exception(), {
                         &m_stmt_insert_key, &m_stmt_insert_value, &m_stmt_get_key_id,
-                        &m_stmt_get_value_id, &m_stmt_get_value_count, &m_stmt_set_value_count,
-                        &m_stmt_insert_key_temp, &m_stmt_insert_value_temp,
-                        &m_stmt_purge_keys, &m_stmt_purge_values, &m_stmt_clear_keys_temp, &m_stmt_clear_values_temp
+                        &m_stmt_get_value_id, &m_stmt_set_value_count,
+                        &m_stmt_insert_key_temp, &m_stmt_insert_value_temp, &m_stmt_insert_key_value_temp,
+                        &m_stmt_purge_keys, &m_stmt_purge_values, &m_stmt_purge_key_values,
+                        &m_stmt_clear_keys_temp, &m_stmt_clear_values_temp, &m_stmt_clear_key_values_temp
                     },
                     "Unknown error occurred while reconciling data.");
             }
         }
 
+        /// \brief Finds the values of several keys in the database.
+        /// \tparam KeyContainerT Container type of the keys.
+        /// \tparam Func Callable `void(KeyT&, ValueT&, const std::size_t& value_count)` called for every found pair.
+        /// \param bulk_find Multi-key statement of the connection to read from.
+        /// \param keys The keys to search for.
+        /// \param on_pair Function receiving the found pairs.
+        /// \return The number of rows found.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class KeyContainerT, typename Func, class... KeyArgs>
+        std::size_t db_find_many(ChunkedStmt& bulk_find, const KeyContainerT<KeyT, KeyArgs...>& keys, Func on_pair) {
+            std::size_t found = 0;
+            try {
+                bulk_find.query(keys.begin(), keys.size(), bind_key, [&on_pair, &found](SqliteStmt& stmt) {
+                    KeyT key = stmt.extract_column<KeyT>(0);
+                    ValueT value = stmt.extract_column<ValueT>(1);
+                    const std::size_t value_count = stmt.extract_column<std::size_t>(2);
+                    on_pair(key, value, value_count);
+                    ++found;
+                });
+            } catch (...) {
+                db_handle_exception(std::current_exception(), {}, "Unknown error occurred while finding values by keys.");
+            }
+            return found;
+        }
+
+        /// \brief Binds a key to a statement parameter.
+        /// \param stmt The statement to bind to.
+        /// \param index Index of the parameter.
+        /// \param key The key to bind.
+        static void bind_key(SqliteStmt& stmt, const int& index, const KeyT& key) {
+            stmt.bind_value<KeyT>(index, key);
+        }
+
         /// \brief Finds values by key in the database.
         /// \tparam ContainerT Template for the container type.
+        /// \param stmt Lookup statement of the connection to read from.
         /// \param key The key to search for.
         /// \param values The container to store the values associated with the key.
         /// \return True if the key was found, false otherwise.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        bool db_find(const KeyT &key, ContainerT<ValueT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        bool db_find(SqliteStmt& stmt, const KeyT &key, ContainerT<ValueT, ContainerArgs...>& container) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::FIND);
             int err;
             try {
-                m_stmt_find.bind_value<KeyT>(1, key);
-                while ((err = m_stmt_find.step()) == SQLITE_ROW) {
-                    ValueT value = m_stmt_find.extract_column<ValueT>(0);
-                    const size_t value_count = m_stmt_find.extract_column<size_t>(1);
+                stmt.bind_value<KeyT>(1, key);
+                while ((err = stmt.step()) == SQLITE_ROW) {
+                    ValueT value = stmt.extract_column<ValueT>(0);
+                    const size_t value_count = stmt.extract_column<size_t>(1);
                     add_value(container, value, value_count);
                 }
-                m_stmt_find.reset();
+                stmt.reset();
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(),
-                    {&m_stmt_find},
+                    {&stmt},
                     "Unknown error occurred while finding key-value pairs.");
             }
             return !container.empty();
@@ -1086,6 +1467,7 @@ namespace sqlite_containers {
                 m_stmt_remove_all_values.execute();
                 m_stmt_remove_all_values.reset();
                 m_stmt_remove_all_values.clear_bindings();
+                m_key_ids.erase(key);
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(),
@@ -1094,6 +1476,39 @@ namespace sqlite_containers {
             }
         }
 
+        /// \brief Applies recorded changes to the database.
+        /// Keys erased by the log are removed first, then the changes of individual pairs are written. An absolute
+        /// count inserts the pair if it does not exist; an absolute count of 0 removes it.
+        /// \param log Changes to apply.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void db_apply_delta(const MultiChangeLog<KeyT, ValueT>& log) {
+            try {
+                for (const auto& key_change : log.changes()) {
+                    const KeyT& key = key_change.first;
+                    if (key_change.second.erase_all) db_remove_all_values(key);
+                    for (const auto& value_change : key_change.second.values) {
+                        const ValueT& value = value_change.first;
+                        const auto& change = value_change.second;
+                        if (change.absolute && change.count == 0) {
+                            db_remove_key_value(key, value);
+                            continue;
+                        }
+                        if (change.count == 0) continue;
+                        SqliteStmt& stmt = change.absolute ? m_stmt_set_value_count : m_stmt_add_value_count;
+                        db_upsert_pair(stmt, key, value, &change.count);
+                    }
+                }
+            } catch (...) {
+                db_clear_id_cache();
+                db_handle_exception(
+                    std::current_exception(), {
+                        &m_stmt_insert_key, &m_stmt_insert_value, &m_stmt_get_key_id,
+                        &m_stmt_get_value_id, &m_stmt_set_value_count, &m_stmt_add_value_count
+                    },
+                    "Unknown error occurred while applying changes to the database.");
+            }
+        }
+
         /// \brief Retrieves the count of a specific value associated with a key in the database.
         /// \param key The key.
         /// \param value The value.
@@ -1117,39 +1532,42 @@ namespace sqlite_containers {
                     {&m_stmt_get_value_count_kv},
                     "Unknown error occurred while retrieving value count for key-value pair.");
             }
+            return 0;
         }
 
         /// \brief Returns the number of elements in the database.
+        /// \param stmt Count statement of the connection to read from.
         /// \return The number of key-value pairs in the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        std::size_t db_count_key() const {
+        std::size_t db_count_key(SqliteStmt& stmt) const {
             std::size_t count = 0;
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
             int err;
             try {
                 for (;;) {
-                    while ((err = m_stmt_count_key.step()) == SQLITE_ROW) {
-                        count = m_stmt_count_key.extract_column<std::size_t>(0);
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        count = stmt.extract_column<std::size_t>(0);
                     }
                     if (err == SQLITE_DONE) {
-                        m_stmt_count_key.reset();
+                        stmt.reset();
                         break;
                     }
                     if (err == SQLITE_BUSY) {
                         // Handle busy database, retry reading
-                        m_stmt_count_key.reset();
-                        sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
                         continue;
                     }
                     // Handle SQLite errors
                     std::string err_msg = "SQLite error: ";
                     err_msg += std::to_string(err);
                     err_msg += ", ";
-                    err_msg += sqlite3_errmsg(m_sqlite_db);
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
                     throw sqlite_exception(err_msg, err);
                 }
             } catch (...) {
                 db_handle_exception(std::current_exception(),
-                    {&m_stmt_count_key}, "Unknown error occurred while counting the number of unique keys.");
+                    {&stmt}, "Unknown error occurred while counting the number of unique keys.");
             }
             return count;
         }
@@ -1157,6 +1575,7 @@ namespace sqlite_containers {
         /// \brief Clears all key-value pairs from the database.
         /// \throws sqlite_exception if an SQLite error occurs.
         void db_clear() {
+            db_clear_id_cache();
             try {
                 std::vector<SqliteStmt*> stmts = {&m_stmt_clear_keys, &m_stmt_clear_values, &m_stmt_clear_key_values};
                 for (auto* stmt : stmts) {
@@ -1172,54 +1591,80 @@ namespace sqlite_containers {
             }
         }
 
-        /// \brief Inserts a key into the database.
-        /// \param key The key to be inserted.
-        /// \throws sqlite_exception if an SQLite error occurs.
-        void db_insert_key(const KeyT& key) {
-            m_stmt_insert_key.bind_value<KeyT>(1, key);
-            m_stmt_insert_key.execute();
-            m_stmt_insert_key.reset();
-            m_stmt_insert_key.clear_bindings();
-        }
-
-        /// \brief Retrieves the ID of a key from the database.
+        /// \brief Returns the ID of a key, inserting the key if it does not exist.
+        /// IDs are cached and looked up in the database only on a cache miss.
         /// \param key The key whose ID is to be retrieved.
-        /// \return The ID of the key, or -1 if the key is not found.
+        /// \return The ID of the key.
         /// \throws sqlite_exception if an SQLite error occurs.
-        int64_t db_get_key_id(const KeyT& key) {
-            m_stmt_get_key_id.bind_value<KeyT>(1, key);
-            int64_t key_id = -1;
-            if (m_stmt_get_key_id.step() == SQLITE_ROW) {
-                key_id = m_stmt_get_key_id.extract_column<int64_t>(0);
-            }
-            m_stmt_get_key_id.reset();
-            m_stmt_get_key_id.clear_bindings();
+        int64_t db_get_or_insert_key_id(const KeyT& key) {
+            auto it = m_key_ids.find(key);
+            if (it != m_key_ids.end()) return it->second;
+            const int64_t key_id = db_insert_and_get_id(m_stmt_insert_key, m_stmt_get_key_id, key);
+            if (key_id == -1) throw sqlite_exception("Key ID not found.");
+            if (m_key_ids.size() >= SQLITE_CONTAINERS_ID_CACHE_SIZE) m_key_ids.clear();
+            m_key_ids.emplace(key, key_id);
             return key_id;
         }
 
-        /// \brief Inserts a value into the database.
-        /// \param value The value to be inserted.
+        /// \brief Returns the ID of a value, inserting the value if it does not exist.
+        /// IDs are cached and looked up in the database only on a cache miss.
+        /// \param value The value whose ID is to be retrieved.
+        /// \return The ID of the value.
         /// \throws sqlite_exception if an SQLite error occurs.
-        void db_insert_value(const ValueT& value) {
-            m_stmt_insert_value.bind_value<ValueT>(1, value);
-            m_stmt_insert_value.execute();
-            m_stmt_insert_value.reset();
-            m_stmt_insert_value.clear_bindings();
+        int64_t db_get_or_insert_value_id(const ValueT& value) {
+            auto it = m_value_ids.find(value);
+            if (it != m_value_ids.end()) return it->second;
+            const int64_t value_id = db_insert_and_get_id(m_stmt_insert_value, m_stmt_get_value_id, value);
+            if (value_id == -1) throw sqlite_exception("Value ID not found.");
+            if (m_value_ids.size() >= SQLITE_CONTAINERS_ID_CACHE_SIZE) m_value_ids.clear();
+            m_value_ids.emplace(value, value_id);
+            return value_id;
         }
 
-        /// \brief Retrieves the ID of a value from the database.
-        /// \param value The value whose ID is to be retrieved.
-        /// \return The ID of the value, or -1 if the value is not found.
+        /// \brief Inserts a key or value if it does not exist and returns its ID.
+        /// The new ID is taken from `RETURNING` (or `sqlite3_last_insert_rowid` on SQLite older than 3.35),
+        /// so the ID is selected separately only for rows that already exist.
+        /// \tparam T Type of the key or value.
+        /// \param stmt_insert Statement inserting the key or value.
+        /// \param stmt_get_id Statement selecting the ID of an existing key or value.
+        /// \param data The key or value.
+        /// \return The ID of the key or value, or -1 if it is not found.
         /// \throws sqlite_exception if an SQLite error occurs.
-        int64_t db_get_value_id(const ValueT& value) {
-            m_stmt_get_value_id.bind_value<ValueT>(1, value);
-            int64_t value_id = -1;
-            if (m_stmt_get_value_id.step() == SQLITE_ROW) {
-                value_id = m_stmt_get_value_id.extract_column<int64_t>(0);
+        template<typename T>
+        int64_t db_insert_and_get_id(SqliteStmt& stmt_insert, SqliteStmt& stmt_get_id, const T& data) {
+            int64_t id = -1;
+            stmt_insert.bind_value<T>(1, data);
+#           if SQLITE_VERSION_NUMBER >= 3035000
+            int err;
+            while ((err = stmt_insert.step()) == SQLITE_ROW) {
+                id = stmt_insert.extract_column<int64_t>(0);
             }
-            m_stmt_get_value_id.reset();
-            m_stmt_get_value_id.clear_bindings();
-            return value_id;
+            if (err != SQLITE_DONE) {
+                throw sqlite_exception("SQLite error: " + std::string(sqlite3_errmsg(m_sqlite_db)) + ". Error code: " + std::to_string(err), err);
+            }
+#           else
+            stmt_insert.execute();
+            if (sqlite3_changes(m_sqlite_db) > 0) {
+                id = sqlite3_last_insert_rowid(m_sqlite_db);
+            }
+#           endif
+            stmt_insert.reset();
+            stmt_insert.clear_bindings();
+            if (id != -1) return id;
+
+            stmt_get_id.bind_value<T>(1, data);
+            if (stmt_get_id.step() == SQLITE_ROW) {
+                id = stmt_get_id.extract_column<int64_t>(0);
+            }
+            stmt_get_id.reset();
+            stmt_get_id.clear_bindings();
+            return id;
+        }
+
+        /// \brief Clears the cached key and value IDs.
+        void db_clear_id_cache() noexcept {
+            m_key_ids.clear();
+            m_value_ids.clear();
         }
 
         /// \brief Inserts a key into the temporary keys table.
@@ -1242,65 +1687,71 @@ namespace sqlite_containers {
             m_stmt_insert_value_temp.clear_bindings();
         }
 
-        /// \brief Inserts a key-value pair into the key-value table.
-        /// \param key_id The ID of the key.
-        /// \param value_id The ID of the value.
+        /// \brief Inserts the IDs of a key-value pair into the temporary key-value pairs table.
+        /// Must follow the upsert of the pair, which leaves the IDs of the key and the value in the cache.
+        /// \param key The key of the pair.
+        /// \param value The value of the pair.
         /// \throws sqlite_exception if an SQLite error occurs.
-        void db_insert_key_value(const int64_t& key_id, const int64_t& value_id) {
-            m_stmt_insert_key_value.bind_value<int64_t>(1, key_id);
-            m_stmt_insert_key_value.bind_value<int64_t>(2, value_id);
-            m_stmt_insert_key_value.execute();
-            m_stmt_insert_key_value.reset();
-            m_stmt_insert_key_value.clear_bindings();
-        }
-
-        /// \brief Retrieves the count of values associated with a specific key-value pair.
-        /// \param key_id The ID of the key.
-        /// \param value_id The ID of the value.
-        /// \return The count of values associated with the key-value pair.
+        void db_insert_key_value_temp(const KeyT& key, const ValueT& value) {
+            m_stmt_insert_key_value_temp.bind_value<int64_t>(1, db_get_or_insert_key_id(key));
+            m_stmt_insert_key_value_temp.bind_value<int64_t>(2, db_get_or_insert_value_id(value));
+            m_stmt_insert_key_value_temp.execute();
+            m_stmt_insert_key_value_temp.reset();
+            m_stmt_insert_key_value_temp.clear_bindings();
+        }
+
+        /// \brief Inserts a key-value pair into the key-value table, or updates its count, by the IDs of the key and value.
+        /// Cached IDs go stale when another connection removes the key or the value, and the FOREIGN KEY check of
+        /// the upsert then fails. The upsert is retried once with IDs looked up again in that case.
+        /// \param stmt Upsert statement taking the key ID, the value ID and, if `value_count` is given, a count.
+        /// \param key The key of the pair.
+        /// \param value The value of the pair.
+        /// \param value_count The count bound as the third parameter, or null.
         /// \throws sqlite_exception if an SQLite error occurs.
-        std::size_t db_get_value_count(const int64_t &key_id, const int64_t& value_id) {
-            m_stmt_get_value_count.bind_value<int64_t>(1, key_id);
-            m_stmt_get_value_count.bind_value<int64_t>(2, value_id);
-            std::size_t value_count = 0;
-            if (m_stmt_get_value_count.step() == SQLITE_ROW) {
-                value_count = m_stmt_get_value_count.extract_column<std::size_t>(0);
+        void db_upsert_pair(SqliteStmt& stmt, const KeyT& key, const ValueT& value, const std::size_t* value_count = nullptr) {
+            for (bool retry = true;; retry = false) {
+                try {
+                    stmt.bind_value<int64_t>(1, db_get_or_insert_key_id(key));
+                    stmt.bind_value<int64_t>(2, db_get_or_insert_value_id(value));
+                    if (value_count) stmt.bind_value<size_t>(3, *value_count);
+                    stmt.execute();
+                    stmt.reset();
+                    stmt.clear_bindings();
+                    return;
+                } catch (const sqlite_exception& e) {
+                    if (!retry || (e.error_code() & 0xFF) != SQLITE_CONSTRAINT) throw;
+                }
+                // The failed step is reported again by the reset
+                sqlite3_reset(stmt.get_stmt());
+                stmt.clear_bindings();
+                m_key_ids.erase(key);
+                m_value_ids.erase(value);
             }
-            m_stmt_get_value_count.reset();
-            m_stmt_get_value_count.clear_bindings();
-            return value_count;
-        }
-
-        /// \brief Sets the count of values associated with a specific key-value pair.
-        /// \param key_id The ID of the key.
-        /// \param value_id The ID of the value.
-        /// \param value_count The count to be set.
-        /// \throws sqlite_exception if an SQLite error occurs.
-        void db_set_value_count(const int64_t& key_id, const int64_t& value_id, const size_t& value_count) {
-            m_stmt_set_value_count.bind_value<size_t>(1, value_count);
-            m_stmt_set_value_count.bind_value<int64_t>(2, key_id);
-            m_stmt_set_value_count.bind_value<int64_t>(3, value_id);
-            m_stmt_set_value_count.execute();
-            m_stmt_set_value_count.reset();
-            m_stmt_set_value_count.clear_bindings();
         }
 
-        /// \brief Removes old keys and values that are no longer in the temporary tables.
+        /// \brief Removes old key-value pairs, keys and values that are no longer in the temporary tables.
         /// \throws sqlite_exception if an SQLite error occurs.
         void db_purge_old_data() {
+            // Pairs whose key and value both remain are not removed by the cascade of the purges below
+            m_stmt_purge_key_values.execute();
+            m_stmt_purge_key_values.reset();
+            // Purged rows invalidate their cached IDs
+            db_clear_id_cache();
             m_stmt_purge_keys.execute();
             m_stmt_purge_keys.reset();
             m_stmt_purge_values.execute();
             m_stmt_purge_values.reset();
         }
 
-        /// \brief Clears the temporary keys and values tables.
+        /// \brief Clears the temporary keys, values and key-value pairs tables.
         /// \throws sqlite_exception if an SQLite error occurs.
         void db_clear_temp_tables() {
             m_stmt_clear_keys_temp.execute();
             m_stmt_clear_keys_temp.reset();
             m_stmt_clear_values_temp.execute();
             m_stmt_clear_values_temp.reset();
+            m_stmt_clear_key_values_temp.execute();
+            m_stmt_clear_key_values_temp.reset();
         }
 
     }; // KeyMultiValueDB
@@ -4,6 +4,10 @@
 /// \brief Declaration of the KeyValueDB class for managing key-value pairs in a SQLite database.
 
 #include "parts/BaseDB.hpp"
+#include "parts/ChangeLog.hpp"
+#include "parts/LruCache.hpp"
+#include "parts/ThreadPool.hpp"
+#include <shared_mutex>
 
 namespace sqlite_containers {
 
@@ -17,7 +21,8 @@ namespace sqlite_containers {
     /// methods for bulk loading and appending data with transactional integrity, ensuring that operations are safely executed
     /// in a database environment. Additionally, temporary tables are used during reconciliation to ensure consistent data
     /// synchronization. This class also provides methods for checking the count and emptiness of the database, and efficiently
-    /// handles database errors with detailed exception handling.
+    /// handles database errors with detailed exception handling. With `Config::write_back` all pairs are kept in an
+    /// in-memory hash map that serves every read, and changed keys are written back to the table in batches.
     template<class KeyT, class ValueT>
     class KeyValueDB final : public BaseDB {
     public:
@@ -31,8 +36,20 @@ namespace sqlite_containers {
             set_config(config);
         }
 
+        /// \brief Constructor for a table on the shared connection of a Database.
+        /// \param database The database whose connection is used; it must outlive the container.
+        /// \param config Table settings; the connection settings are taken from the database.
+        KeyValueDB(Database& database, const Config& config) : BaseDB(database) {
+            set_config(config);
+        }
+
         /// \brief Destructor.
-        ~KeyValueDB() override final = default;
+        /// Stops the background writer while the prepared statements are still alive.
+        ~KeyValueDB() override final {
+            try {
+                disconnect();
+            } catch (...) {}
+        }
 
         // --- Operators ---
 
@@ -41,8 +58,8 @@ namespace sqlite_containers {
         /// \return Reference to this KeyValueDB.
         /// \throws sqlite_exception if an SQLite error occurs.
         /// \note The transaction mode is taken from the database configuration.
-        template<template <class...> class ContainerT>
-        KeyValueDB& operator=(const ContainerT<KeyT, ValueT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        KeyValueDB& operator=(const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
             // Get the default transaction mode from the configuration
             auto txn_mode = get_config().default_txn_mode;
 
@@ -60,11 +77,15 @@ namespace sqlite_containers {
         template<template <class...> class ContainerT = std::map>
         ContainerT<KeyT, ValueT> operator()() {
             ContainerT<KeyT, ValueT> container;
+            if (m_write_back) {
+                copy_write_back(container);
+                return container;
+            }
             // Get the default transaction mode from the configuration
             auto txn_mode = get_config().default_txn_mode;
 
             execute_in_transaction([this, &container]() {
-                db_load(container);
+                db_load_all(m_stmt_load, m_stmt_load_sorted, m_stmt_count, container);
             }, txn_mode);  // Use transaction mode from the configuration
             return container;
         }
@@ -75,10 +96,9 @@ namespace sqlite_containers {
         /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
         /// \param container Container to be synchronized with database content.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void load(ContainerT<KeyT, ValueT>& container) {
-            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_load(container);
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void load(ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            load_rows(container);
         }
 
         /// \brief Loads data with a transaction.
@@ -86,13 +106,119 @@ namespace sqlite_containers {
         /// \param container Container to be synchronized with database content.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
+        template<template <class...> class ContainerT, class... ContainerArgs>
         void load(
-                ContainerT<KeyT, ValueT>& container,
+                ContainerT<KeyT, ValueT, ContainerArgs...>& container,
                 const TransactionMode& mode) {
-            execute_in_transaction([this, &container]() {
-                db_load(container);
-            }, mode);
+            load_rows(container, mode);
+        }
+
+        /// \brief Loads data from the database into a flat sequence of pairs sorted by key.
+        /// The pairs are read in key order after room for all of them is reserved, so the sequence can be searched
+        /// with `std::lower_bound`. With `Config::write_back` they are copied from memory and are not sorted.
+        /// \tparam SequenceT Sequence type (e.g., std::vector or std::deque) of `std::pair<KeyT, ValueT>`.
+        /// \param container Sequence receiving the pairs.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class SequenceT, class... SequenceArgs>
+        void load(SequenceT<std::pair<KeyT, ValueT>, SequenceArgs...>& container) {
+            load_rows(container);
+        }
+
+        /// \brief Loads data into a flat sequence of pairs sorted by key, with a transaction.
+        /// \tparam SequenceT Sequence type (e.g., std::vector or std::deque) of `std::pair<KeyT, ValueT>`.
+        /// \param container Sequence receiving the pairs.
+        /// \param mode Transaction mode.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class SequenceT, class... SequenceArgs>
+        void load(
+                SequenceT<std::pair<KeyT, ValueT>, SequenceArgs...>& container,
+                const TransactionMode& mode) {
+            load_rows(container, mode);
+        }
+
+        /// \brief Loads data from the database into the container, scanning ranges of the table in parallel.
+        /// The table is split into `partitions` ranges that are read and decoded on worker threads, each through
+        /// its own read-only connection, and the rows are then moved into the container. Rowid tables are split
+        /// into rowid ranges of equal width; `WITHOUT ROWID` tables (see `Config::table_layout`) into key ranges
+        /// of equal row counts. Room for all rows is reserved up front if the container supports `reserve()`.
+        /// Each range is read in its own WAL snapshot, so writes committed during the load may be seen by some
+        /// ranges only. Falls back to load() when fewer than two read connections are available (see
+        /// `Config::read_connections`) or while a transaction opened by `begin()` is active.
+        /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
+        /// \param container Container to be synchronized with database content.
+        /// \param partitions Number of ranges read in parallel; 0 uses one range per read connection.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void load_parallel(ContainerT<KeyT, ValueT, ContainerArgs...>& container, std::size_t partitions = 0) {
+            if (m_write_back) {
+                copy_write_back(container);
+                return;
+            }
+            if (partitions == 0) partitions = m_readers.size();
+            std::size_t rows = 0;
+            int64_t min_rowid = 0;
+            int64_t max_rowid = 0;
+            {
+                auto reader = partitions > 1 ? db_acquire_reader() : typename ReaderPool<ReadStmts>::Lease();
+                if (!reader) {
+                    load(container);
+                    return;
+                }
+                rows = db_count(reader->stmts.count);
+                if (rows == 0) return;
+                if (m_has_rowid) db_rowid_range(reader->stmts.rowid_range, min_rowid, max_rowid);
+            }
+            reserve_capacity(container, container.size() + rows);
+
+            std::vector<std::vector<std::pair<KeyT, ValueT>>> parts;
+            if (m_has_rowid) {
+                // Split [min_rowid, max_rowid] into ranges of equal width
+                const uint64_t span = static_cast<uint64_t>(max_rowid) - static_cast<uint64_t>(min_rowid) + 1;
+                if (span > 0 && span < partitions) partitions = static_cast<std::size_t>(span);
+                const uint64_t step = span == 0 ? UINT64_MAX / partitions : (span + partitions - 1) / partitions;
+                parts.resize(partitions);
+                ThreadPool pool(partitions);
+                pool.parallel_for(partitions, [&](std::size_t i) {
+                    const int64_t first = static_cast<int64_t>(static_cast<uint64_t>(min_rowid) + step * i);
+                    const int64_t last = i + 1 == partitions ? max_rowid : static_cast<int64_t>(static_cast<uint64_t>(first) + step - 1);
+                    auto reader = db_lease_reader();
+                    parts[i].reserve(rows / partitions + 1);
+                    db_load_range(reader->stmts.load_range, [&first, &last](SqliteStmt& stmt) {
+                        stmt.bind_value<int64_t>(1, first);
+                        stmt.bind_value<int64_t>(2, last);
+                    }, parts[i]);
+                });
+            } else {
+                // Split the key order into ranges of equal row counts
+                if (rows < partitions) partitions = rows;
+                std::vector<KeyT> bounds(partitions);
+                parts.resize(partitions);
+                ThreadPool pool(partitions);
+                pool.parallel_for(partitions, [&](std::size_t i) {
+                    auto reader = db_lease_reader();
+                    db_key_at(reader->stmts.key_at, static_cast<int64_t>(rows / partitions * i), bounds[i]);
+                });
+                pool.parallel_for(partitions, [&](std::size_t i) {
+                    auto reader = db_lease_reader();
+                    parts[i].reserve(rows / partitions + 1);
+                    if (i + 1 == partitions) {
+                        db_load_range(reader->stmts.load_tail, [&bounds, i](SqliteStmt& stmt) {
+                            stmt.bind_value<KeyT>(1, bounds[i]);
+                        }, parts[i]);
+                        return;
+                    }
+                    db_load_range(reader->stmts.load_range, [&bounds, i](SqliteStmt& stmt) {
+                        stmt.bind_value<KeyT>(1, bounds[i]);
+                        stmt.bind_value<KeyT>(2, bounds[i + 1]);
+                    }, parts[i]);
+                });
+            }
+            for (auto& part : parts) {
+                for (auto& pair : part) {
+                    container.emplace(std::move(pair.first), std::move(pair.second));
+                }
+                std::vector<std::pair<KeyT, ValueT>>().swap(part);
+            }
         }
 
         /// \brief Retrieves all key-value pairs.
@@ -102,8 +228,19 @@ namespace sqlite_containers {
         template<template <class...> class ContainerT>
         ContainerT<KeyT, ValueT> retrieve_all() {
             ContainerT<KeyT, ValueT> container;
-            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_load(container);
+            load(container);
+            return container;
+        }
+
+        /// \brief Retrieves all key-value pairs into a container of the given type, which may use a custom allocator.
+        /// \tparam ContainerT Complete container type, e.g. `std::pmr::map<KeyT, ValueT>`.
+        /// \param allocator Allocator of the container, e.g. one drawing from a `std::pmr::monotonic_buffer_resource`.
+        /// \return A container with all key-value pairs.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<class ContainerT>
+        ContainerT retrieve_all(const typename ContainerT::allocator_type& allocator = typename ContainerT::allocator_type()) {
+            ContainerT container(allocator);
+            load(container);
             return container;
         }
 
@@ -115,19 +252,164 @@ namespace sqlite_containers {
         template<template <class...> class ContainerT>
         ContainerT<KeyT, ValueT> retrieve_all(const TransactionMode& mode) {
             ContainerT<KeyT, ValueT> container;
+            if (m_write_back) {
+                copy_write_back(container);
+                return container;
+            }
             execute_in_transaction([this, &container]() {
-                db_load(container);
+                db_load_all(m_stmt_load, m_stmt_load_sorted, m_stmt_count, container);
             }, mode);
             return container;
         }
 
+        /// \brief Opens a cursor that streams all key-value pairs from the database one row at a time.
+        /// The cursor holds the connection lock until it is destroyed (see Cursor).
+        /// With `Config::write_back` the buffered changes are written back first.
+        /// \return Cursor over all key-value pairs.
+        /// \throws sqlite_exception if the buffered changes cannot be written back.
+        Cursor<std::pair<KeyT, ValueT>> cursor() {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            if (m_write_back) db_flush_buffered();
+            return Cursor<std::pair<KeyT, ValueT>>(std::move(locker), m_sqlite_db, m_stmt_load, &decode_row);
+        }
+
+        /// \brief Calls a visitor for every key-value pair in the database without materializing a container.
+        /// \tparam Func Callable `void(const KeyT&, const ValueT&)` or `bool(const KeyT&, const ValueT&)`;
+        /// returning false stops the iteration.
+        /// \param visitor Function called for every pair.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<typename Func>
+        void for_each(Func visitor) {
+            auto pairs = cursor();
+            for (const auto& pair : pairs) {
+                if (!invoke_visitor(visitor, pair.first, pair.second)) break;
+            }
+        }
+
+        /// \brief Opens a cursor over the pairs with keys in `[from, to)`, in key order.
+        /// The range is read with an index seek, so only the returned rows are visited. Keys are ordered as
+        /// SQLite compares their column: numerically for INTEGER and REAL, bytewise for TEXT and BLOB (see
+        /// OrderedCodec for structures and composite keys). The cursor holds the connection lock until it is
+        /// destroyed (see Cursor). With `Config::write_back` the buffered changes are written back first.
+        /// \param from Smallest key of the range.
+        /// \param to Key past the end of the range.
+        /// \param limit Maximum number of pairs; 0 returns all pairs of the range.
+        /// \return Cursor over the pairs of the range.
+        /// \throws sqlite_exception if the buffered changes cannot be written back.
+        Cursor<std::pair<KeyT, ValueT>> range(const KeyT& from, const KeyT& to, const std::size_t& limit = 0) {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            return db_open_range(std::move(locker), m_stmt_range, from, &to, limit);
+        }
+
+        /// \brief Opens a cursor over the pairs with keys not less than `key`, in key order.
+        /// \param key Smallest key to return.
+        /// \param limit Maximum number of pairs; 0 returns all pairs up to the end of the table.
+        /// \return Cursor over the pairs.
+        /// \throws sqlite_exception if the buffered changes cannot be written back.
+        Cursor<std::pair<KeyT, ValueT>> lower_bound(const KeyT& key, const std::size_t& limit = 0) {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            return db_open_range(std::move(locker), m_stmt_lower_bound, key, nullptr, limit);
+        }
+
+        /// \brief Opens a cursor over the pairs with keys greater than `key`, in key order.
+        /// \param key Key preceding the first key to return.
+        /// \param limit Maximum number of pairs; 0 returns all pairs up to the end of the table.
+        /// \return Cursor over the pairs.
+        /// \throws sqlite_exception if the buffered changes cannot be written back.
+        Cursor<std::pair<KeyT, ValueT>> upper_bound(const KeyT& key, const std::size_t& limit = 0) {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            return db_open_range(std::move(locker), m_stmt_upper_bound, key, nullptr, limit);
+        }
+
+        /// \brief Finds the pair with the smallest key.
+        /// \param key Receives the smallest key.
+        /// \param value Receives its value.
+        /// \return True if the table is not empty, false otherwise.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        bool first(KeyT& key, ValueT& value) {
+            return read_edge(false, key, value);
+        }
+
+        /// \brief Finds the pair with the largest key.
+        /// \param key Receives the largest key.
+        /// \param value Receives its value.
+        /// \return True if the table is not empty, false otherwise.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        bool last(KeyT& key, ValueT& value) {
+            return read_edge(true, key, value);
+        }
+
+        /// \brief Removes the pairs with keys in `[from, to)` with one `DELETE` statement.
+        /// \param from Smallest key of the range.
+        /// \param to Key past the end of the range.
+        /// \return Number of removed pairs.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        std::size_t range_remove(const KeyT& from, const KeyT& to) {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
+            return db_range_remove(from, to);
+        }
+
+        /// \brief Removes the stored values that no key refers to anymore (see `Config::dedup_values`).
+        /// reconcile(), clear() and range_remove() purge such values on their own; insert() and remove() leave
+        /// them for a later purge.
+        /// \return Number of removed values.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        std::size_t purge_values() {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
+            return db_purge_values();
+        }
+
+        /// \brief Returns the time the connections of the container have spent waiting for a busy database.
+        /// Counts the waits of the main connection and of the read-only connections.
+        /// \return Counters of the waits since the connections were opened.
+        BusyStats busy_stats() const override {
+            BusyStats stats = BaseDB::busy_stats();
+            stats += m_readers.busy_stats();
+            return stats;
+        }
+
+        /// \brief Opens the stored value of a key for incremental reads and writes.
+        /// The value is read into and written from buffers of the caller in pieces, so it is never copied whole
+        /// into memory. The stream holds the connection lock until it is closed (see BlobStream). Requires a
+        /// rowid table (`TableLayout::ROWID`) without value compression, deduplication and write-back.
+        /// \param key The key of the value.
+        /// \param writable True to open the value for writing.
+        /// \return Open stream, or a closed stream if the key is not found.
+        /// \throws sqlite_exception if the table does not support incremental I/O or an SQLite error occurs.
+        BlobStream open_blob(const KeyT& key, const bool& writable = false) {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
+            return db_open_blob(std::move(locker), key, writable, nullptr);
+        }
+
+        /// \brief Inserts a key with a zero-filled value of the given size and opens the value for writing.
+        /// The value is then filled by BlobStream::write() in pieces. The pair is written before the stream is
+        /// opened, so run both in one transaction to make the whole value appear at once.
+        /// \param key The key to be inserted.
+        /// \param size Size of the value in bytes.
+        /// \return Stream open for writing.
+        /// \throws sqlite_exception if the table does not support incremental I/O or an SQLite error occurs.
+        BlobStream insert_blob(const KeyT& key, const std::size_t& size) {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
+            return db_open_blob(std::move(locker), key, true, &size);
+        }
+
         /// \brief Appends data to the database.
         /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
         /// \param container Container with content to be synchronized.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void append(const ContainerT<KeyT, ValueT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void append(const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             db_append(container);
         }
 
@@ -136,9 +418,9 @@ namespace sqlite_containers {
         /// \param container Container with content to be synchronized.
         /// \param mode Transaction mode.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
+        template<template <class...> class ContainerT, class... ContainerArgs>
         void append(
-                const ContainerT<KeyT, ValueT>& container,
+                const ContainerT<KeyT, ValueT, ContainerArgs...>& container,
                 const TransactionMode& mode) {
             execute_in_transaction([this, &container]() {
                 db_append(container);
@@ -146,157 +428,986 @@ namespace sqlite_containers {
         }
 
         /// \brief Reconciles the database with the container.
+        /// Only the differences are written: missing keys are inserted, changed values are updated and keys
+        /// that are not in the container are removed.
         /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
         /// \param container Container to be reconciled with the database.
+        /// \return Numbers of inserted, updated and removed rows.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void reconcile(const ContainerT<KeyT, ValueT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        ReconcileStats reconcile(const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_reconcile(container);
+            db_flush_async();
+            db_group_commit();
+            return db_reconcile(container);
         }
 
         /// \brief Reconciles the database with the container using a transaction.
         /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
         /// \param container Container to be reconciled with the database.
         /// \param mode Transaction mode.
+        /// \return Numbers of inserted, updated and removed rows.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void reconcile(
-                const ContainerT<KeyT, ValueT>& container,
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        ReconcileStats reconcile(
+                const ContainerT<KeyT, ValueT, ContainerArgs...>& container,
                 const TransactionMode& mode) {
-            execute_in_transaction([this, &container]() {
-                db_reconcile(container);
+            ReconcileStats stats;
+            execute_in_transaction([this, &container, &stats]() {
+                stats = db_reconcile(container);
+            }, mode);
+            return stats;
+        }
+
+        /// \brief Applies recorded changes to the database in one transaction.
+        /// Only the keys in the log are written, so the cost depends on the number of changes and not on the
+        /// size of the table. Joins the transaction opened by `begin()` if there is one; otherwise a transaction
+        /// with `Config::default_txn_mode` is used. In write-back mode the changes are applied to the in-memory
+        /// map and written back with the other dirty keys.
+        /// \param log Changes to apply; the log is not cleared.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void apply_delta(const ChangeLog<KeyT, ValueT>& log) {
+            if (log.empty()) return;
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
+            if (m_write_back) {
+                db_apply_delta(log);
+                return;
+            }
+            db_write_in_transaction([this, &log]() {
+                db_apply_delta(log);
+            });
+        }
+
+        /// \brief Applies recorded changes to the database using a transaction.
+        /// \param log Changes to apply; the log is not cleared.
+        /// \param mode Transaction mode.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void apply_delta(const ChangeLog<KeyT, ValueT>& log, const TransactionMode& mode) {
+            execute_in_transaction([this, &log]() {
+                db_apply_delta(log);
             }, mode);
         }
 
         /// \brief Inserts a key-value pair into the database.
+        /// With `Config::use_async` the pair is queued and written by the background writer.
         /// \param key The key to be inserted.
         /// \param value The value to be inserted.
         /// \throws sqlite_exception if an SQLite error occurs.
         void insert(const KeyT &key, const ValueT &value) {
+            if (m_write_back) {
+                std::unique_lock<std::shared_mutex> locker(m_wb_mutex);
+                m_wb_values[key] = value;
+                m_wb_dirty.insert(key);
+                return;
+            }
+            if (m_async_writes) {
+                async_enqueue([this, key, value]() {
+                    db_insert(key, value);
+                });
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_insert(key, value);
+            db_group_write([this, &key, &value]() {
+                db_insert(key, value);
+            }, get_byte_size(key) + get_byte_size(value));
         }
 
         /// \brief Inserts a key-value pair into the database.
+        /// With `Config::use_async` the pair is queued and written by the background writer.
         /// \param pair The key-value pair to be inserted.
         /// \throws sqlite_exception if an SQLite error occurs.
         void insert(const std::pair<KeyT, ValueT> &pair) {
-            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_insert(pair.first, pair.second);
+            insert(pair.first, pair.second);
         }
 
         /// \brief Finds a value by key.
+        /// With `Config::read_cache_bytes` found values are kept in a bounded LRU cache, and repeated lookups
+        /// of the same key are served from memory.
         /// \param key The key to search for.
         /// \param value The value associated with the key.
         /// \return True if the key was found, false otherwise.
         /// \throws sqlite_exception if an SQLite error occurs.
         bool find(const KeyT &key, ValueT &value) {
+            if (m_write_back) {
+                std::shared_lock<std::shared_mutex> locker(m_wb_mutex);
+                auto it = m_wb_values.find(key);
+                if (it == m_wb_values.end()) return false;
+                value = it->second;
+                return true;
+            }
+            if (m_cache.get(key, value)) return true;
+            const std::uint64_t generation = m_cache.generation();
+            if (auto reader = db_acquire_reader()) {
+                if (!db_find(reader->stmts.get_value, key, value)) return false;
+            } else {
+                std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+                if (!db_find(m_stmt_get_value, key, value)) return false;
+                // Values read inside a transaction may still be rolled back
+                if (!sqlite3_get_autocommit(m_sqlite_db)) return true;
+            }
+            m_cache.put(key, value, generation);
+            return true;
+        }
+
+        /// \brief Returns the hit and miss counters of the find() cache (see `Config::read_cache_bytes`).
+        /// \return Cache counters.
+        CacheStats cache_stats() const {
+            return m_cache.stats();
+        }
+
+        /// \brief Resets the hit and miss counters of the find() cache.
+        void reset_cache_stats() {
+            m_cache.reset_stats();
+        }
+
+        /// \brief Finds the values of several keys at once.
+        /// Keys are looked up with `WHERE key IN (...)` statements of up to `SQLITE_CONTAINERS_BULK_MAX_ROWS` keys,
+        /// and the connection lock is taken once for the whole batch. Keys that are not found are skipped.
+        /// \tparam KeyContainerT Container type of the keys (e.g., std::vector or std::set).
+        /// \tparam ContainerT Container type receiving the pairs (e.g., std::map or std::unordered_map).
+        /// \param keys The keys to search for.
+        /// \param container Container receiving the found key-value pairs.
+        /// \return The number of rows found.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class KeyContainerT, template <class...> class ContainerT, class... KeyArgs, class... ContainerArgs>
+        std::size_t find_many(const KeyContainerT<KeyT, KeyArgs...>& keys, ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            if (m_write_back) {
+                std::size_t found = 0;
+                std::shared_lock<std::shared_mutex> locker(m_wb_mutex);
+                for (const auto& key : keys) {
+                    auto it = m_wb_values.find(key);
+                    if (it == m_wb_values.end()) continue;
+                    container.emplace(it->first, it->second);
+                    ++found;
+                }
+                return found;
+            }
+            if (auto reader = db_acquire_reader()) {
+                return db_find_many(reader->stmts.find_many, keys, container);
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            return db_find(key, value);
+            return db_find_many(m_bulk_find, keys, container);
         }
 
         /// \brief Returns the number of elements in the database.
         /// \return The number of key-value pairs.
         /// \throws sqlite_exception if an SQLite error occurs.
         std::size_t count() const {
+            if (m_write_back) {
+                std::shared_lock<std::shared_mutex> locker(m_wb_mutex);
+                return m_wb_values.size();
+            }
+            if (auto reader = db_acquire_reader()) {
+                return db_count(reader->stmts.count);
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            return db_count();
+            return db_count(m_stmt_count);
         }
 
         /// \brief Checks if the database is empty.
         /// \return True if the database is empty, false otherwise.
         /// \throws sqlite_exception if an SQLite error occurs.
         bool empty() const {
-            return (db_count() == 0);
+            return (count() == 0);
         }
 
         /// \brief Removes a key-value pair from the database.
+        /// With `Config::use_async` the removal is queued and executed by the background writer.
         /// \param key The key of the pair to be removed.
         /// \throws sqlite_exception if an SQLite error occurs.
         void remove(const KeyT &key) {
+            if (m_write_back) {
+                std::unique_lock<std::shared_mutex> locker(m_wb_mutex);
+                m_wb_values.erase(key);
+                m_wb_dirty.insert(key);
+                return;
+            }
+            if (m_async_writes) {
+                async_enqueue([this, key]() {
+                    db_remove(key);
+                });
+                return;
+            }
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
-            db_remove(key);
+            db_group_write([this, &key]() {
+                db_remove(key);
+            }, get_byte_size(key));
         }
 
         /// \brief Clears all key-value pairs from the database.
         /// \throws sqlite_exception if an SQLite error occurs.
         void clear() {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             db_clear();
         }
 
+        // --- Asynchronous methods ---
+
+        /// \brief Inserts a key-value pair on the I/O thread of the container (see `async_call()`).
+        /// Consecutive `async_insert()` and `async_remove()` calls queued together share one transaction.
+        /// With `Config::write_back` or `Config::use_async` the call runs insert() instead.
+        /// \param key The key to be inserted.
+        /// \param value The value to be inserted.
+        /// \return Future completing once the pair is written.
+        AsyncResult<void> async_insert(const KeyT &key, const ValueT &value) {
+            if (m_write_back || m_async_writes) {
+                return async_call([this, key, value]() {
+                    insert(key, value);
+                });
+            }
+            return async_write([this, key, value]() {
+                db_group_write([this, &key, &value]() {
+                    db_insert(key, value);
+                }, get_byte_size(key) + get_byte_size(value));
+            });
+        }
+
+        /// \brief Inserts a key-value pair on the I/O thread of the container.
+        /// \param pair The key-value pair to be inserted.
+        /// \return Future completing once the pair is written.
+        AsyncResult<void> async_insert(const std::pair<KeyT, ValueT> &pair) {
+            return async_insert(pair.first, pair.second);
+        }
+
+        /// \brief Removes a key-value pair on the I/O thread of the container.
+        /// Shares a transaction with neighbouring `async_insert()` and `async_remove()` calls.
+        /// \param key The key of the pair to be removed.
+        /// \return Future completing once the pair is removed.
+        AsyncResult<void> async_remove(const KeyT &key) {
+            if (m_write_back || m_async_writes) {
+                return async_call([this, key]() {
+                    remove(key);
+                });
+            }
+            return async_write([this, key]() {
+                db_group_write([this, &key]() {
+                    db_remove(key);
+                }, get_byte_size(key));
+            });
+        }
+
+        /// \brief Finds a value by key on the I/O thread of the container.
+        /// \param key The key to search for.
+        /// \return Future receiving the value, or no value if the key was not found.
+        AsyncResult<std::optional<ValueT>> async_find(const KeyT &key) {
+            return async_call([this, key]() {
+                std::optional<ValueT> result(std::in_place);
+                if (!find(key, *result)) result.reset();
+                return result;
+            });
+        }
+
+        /// \brief Finds the values of several keys on the I/O thread of the container.
+        /// \tparam ContainerT Container type receiving the pairs (e.g., std::map or std::unordered_map).
+        /// \param keys The keys to search for.
+        /// \return Future receiving the pairs that were found.
+        template<template <class...> class ContainerT = std::unordered_map, class KeyContainerT>
+        AsyncResult<ContainerT<KeyT, ValueT>> async_find_many(KeyContainerT keys) {
+            return async_call([this, keys = std::move(keys)]() {
+                ContainerT<KeyT, ValueT> container;
+                find_many(keys, container);
+                return container;
+            });
+        }
+
+        /// \brief Returns the number of elements on the I/O thread of the container.
+        /// \return Future receiving the number of key-value pairs.
+        AsyncResult<std::size_t> async_count() {
+            return async_call([this]() {
+                return count();
+            });
+        }
+
+        /// \brief Loads data from the database into the container on the I/O thread of the container.
+        /// \param container Container receiving the pairs; it must stay alive and untouched until the future is ready.
+        /// \return Future completing once the container is filled.
+        template<class ContainerT>
+        AsyncResult<void> async_load(ContainerT& container) {
+            return async_call([this, &container]() {
+                load(container);
+            });
+        }
+
+        /// \brief Retrieves all elements on the I/O thread of the container.
+        /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
+        /// \return Future receiving the container with all pairs.
+        template<template <class...> class ContainerT = std::map>
+        AsyncResult<ContainerT<KeyT, ValueT>> async_retrieve_all() {
+            return async_call([this]() {
+                return retrieve_all<ContainerT>();
+            });
+        }
+
+        /// \brief Appends data to the database on the I/O thread of the container.
+        /// \param container Container with content to be appended; it is copied into the call.
+        /// \return Future completing once the pairs are written.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        AsyncResult<void> async_append(ContainerT<KeyT, ValueT, ContainerArgs...> container) {
+            return async_call([this, container = std::move(container)]() {
+                append(container);
+            });
+        }
+
+        /// \brief Reconciles the database with the container on the I/O thread of the container.
+        /// \param container Container to be reconciled with the database; it is copied into the call.
+        /// \return Future receiving the numbers of inserted, updated and removed rows.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        AsyncResult<ReconcileStats> async_reconcile(ContainerT<KeyT, ValueT, ContainerArgs...> container) {
+            return async_call([this, container = std::move(container)]() {
+                return reconcile(container);
+            });
+        }
+
+        /// \brief Applies recorded changes on the I/O thread of the container.
+        /// \param log Changes to apply; it is copied into the call.
+        /// \return Future completing once the changes are written.
+        AsyncResult<void> async_apply_delta(ChangeLog<KeyT, ValueT> log) {
+            return async_call([this, log = std::move(log)]() {
+                apply_delta(log);
+            });
+        }
+
+        /// \brief Removes the pairs with keys in `[from, to)` on the I/O thread of the container.
+        /// \param from Smallest key of the range.
+        /// \param to Key past the end of the range.
+        /// \return Future receiving the number of removed pairs.
+        AsyncResult<std::size_t> async_range_remove(const KeyT& from, const KeyT& to) {
+            return async_call([this, from, to]() {
+                return range_remove(from, to);
+            });
+        }
+
+        /// \brief Clears all key-value pairs on the I/O thread of the container.
+        /// \return Future completing once the table is cleared.
+        AsyncResult<void> async_clear() {
+            return async_call([this]() {
+                clear();
+            });
+        }
+
     private:
         SqliteStmt m_stmt_load;         ///< Statement for loading data from the database.
+        SqliteStmt m_stmt_load_sorted;  ///< Statement for loading data in key order.
         SqliteStmt m_stmt_replace;      ///< Statement for replacing key-value pairs in the database.
         SqliteStmt m_stmt_get_value;    ///< Statement for retrieving value by key from the database.
         mutable SqliteStmt m_stmt_count;///<
         SqliteStmt m_stmt_remove;       ///< Statement for removing key-value pair from the database.
         SqliteStmt m_stmt_clear_main;   ///< Statement for clearing the main table.
+        SqliteStmt m_stmt_range;        ///< Statement for reading the pairs of a key range in key order.
+        SqliteStmt m_stmt_lower_bound;  ///< Statement for reading the pairs from a key on, in key order.
+        SqliteStmt m_stmt_upper_bound;  ///< Statement for reading the pairs after a key, in key order.
+        SqliteStmt m_stmt_first;        ///< Statement for reading the pair with the smallest key.
+        SqliteStmt m_stmt_last;         ///< Statement for reading the pair with the largest key.
+        SqliteStmt m_stmt_range_remove; ///< Statement for removing the pairs of a key range.
+        std::pair<KeyT, KeyT> m_range_bounds; ///< Copies of the bounds bound to the statement of an open range cursor.
 
-        SqliteStmt m_stmt_insert_temp;  ///< Statement for inserting data into the temporary table.
         SqliteStmt m_stmt_purge_main;   ///< Statement for purging stale data from the main table.
-        SqliteStmt m_stmt_merge_temp;   ///< Statement for merging data from the temporary table into the main table.
+        SqliteStmt m_stmt_merge_temp;   ///< Statement for inserting keys of the temporary table missing from the main table.
+        SqliteStmt m_stmt_update_temp;  ///< Statement for updating values that differ from the temporary table.
         SqliteStmt m_stmt_clear_temp;   ///< Statement for clearing the temporary table.
 
+        ChunkedStmt m_bulk_replace;     ///< Multi-row statement for replacing key-value pairs in the main table.
+        ChunkedStmt m_bulk_insert_temp; ///< Multi-row statement for inserting data into the temporary table.
+        ChunkedStmt m_bulk_find;        ///< Multi-key statement for finding values by keys.
+        ChunkedStmt m_bulk_remove;      ///< Multi-key statement for removing keys.
+
+        SqliteStmt  m_stmt_intern;      ///< Statement for storing a value in the values table.
+        ChunkedStmt m_bulk_intern;      ///< Multi-row statement for storing values in the values table.
+        SqliteStmt  m_stmt_purge_values;///< Statement for removing stored values that no key refers to.
+        SqliteStmt  m_stmt_clear_values;///< Statement for clearing the values table.
+        bool        m_dedup_values = false; ///< True if values are stored once in the values table (see `Config::dedup_values`).
+        bool        m_blob_io = false;  ///< True if values are stored as is in a rowid table, as incremental BLOB I/O requires.
+        std::string m_table_name;       ///< Name of the main table.
+        SqliteStmt  m_stmt_get_rowid;   ///< Statement for finding the rowid of a key.
+        SqliteStmt  m_stmt_replace_zeroblob; ///< Statement for replacing a pair with a zero-filled value.
+
+        /// \brief Prepared statements of a read-only connection.
+        struct ReadStmts {
+            SqliteStmt  load;           ///< Statement for loading data from the database.
+            SqliteStmt  load_sorted;    ///< Statement for loading data in key order.
+            SqliteStmt  get_value;      ///< Statement for retrieving value by key from the database.
+            SqliteStmt  count;          ///< Statement for counting key-value pairs.
+            ChunkedStmt find_many;      ///< Multi-key statement for finding values by keys.
+            SqliteStmt  rowid_range;    ///< Statement for selecting the smallest and the largest rowid.
+            SqliteStmt  load_range;     ///< Statement for loading the pairs of a rowid or key range.
+            SqliteStmt  key_at;         ///< Statement for selecting the key at an offset in key order.
+            SqliteStmt  load_tail;      ///< Statement for loading the pairs from a key to the end of the table.
+            SqliteStmt  first;          ///< Statement for reading the pair with the smallest key.
+            SqliteStmt  last;           ///< Statement for reading the pair with the largest key.
+        };
+
+        mutable ReaderPool<ReadStmts> m_readers; ///< Read-only connections (see `Config::read_connections`).
+        bool m_has_rowid = true;                ///< False if the main table was created `WITHOUT ROWID`.
+
+        LruCache<KeyT, ValueT> m_cache;     ///< Cache of found values (see `Config::read_cache_bytes`).
+        std::vector<KeyT>   m_cache_pending;    ///< Keys written by the open transaction, invalidated again on commit.
+        bool                m_cache_pending_all = false; ///< True if the open transaction made a bulk change.
+
+        /// \brief Maximum number of keys tracked per transaction before the whole cache is invalidated on commit.
+        static constexpr std::size_t CACHE_PENDING_MAX = 1024;
+
+        using WriteBackMap = std::unordered_map<KeyT, ValueT, Hash<KeyT>, EqualTo<KeyT>>;
+        using WriteBackKeys = std::unordered_set<KeyT, Hash<KeyT>, EqualTo<KeyT>>;
+
+        std::atomic<bool>   m_write_back = ATOMIC_VAR_INIT(false); ///< True if `Config::write_back` is enabled.
+        WriteBackMap        m_wb_values;        ///< All pairs of the table, authoritative in write-back mode.
+        WriteBackKeys       m_wb_dirty;         ///< Keys changed since the last write-back.
+        bool                m_wb_resync = false; ///< True if a rolled back transaction may have left the table behind the map.
+        mutable std::shared_mutex m_wb_mutex;   ///< Protects the write-back map and the dirty keys.
+
+        /// \brief Loads all pairs into a container through a read-only connection or the main connection.
+        /// \param container Associative container or sequence of pairs.
+        template<class ContainerT>
+        void load_rows(ContainerT& container) {
+            if (m_write_back) {
+                copy_write_back(container);
+                return;
+            }
+            if (auto reader = db_acquire_reader()) {
+                db_load_all(reader->stmts.load, reader->stmts.load_sorted, reader->stmts.count, container);
+                return;
+            }
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_load_all(m_stmt_load, m_stmt_load_sorted, m_stmt_count, container);
+        }
+
+        /// \brief Loads all pairs into a container with a transaction.
+        /// \param container Associative container or sequence of pairs.
+        /// \param mode Transaction mode.
+        template<class ContainerT>
+        void load_rows(ContainerT& container, const TransactionMode& mode) {
+            if (m_write_back) {
+                copy_write_back(container);
+                return;
+            }
+            execute_in_transaction([this, &container]() {
+                db_load_all(m_stmt_load, m_stmt_load_sorted, m_stmt_count, container);
+            }, mode);
+        }
+
+        /// \brief Copies the write-back map into a container.
+        /// \param container Container receiving the pairs.
+        template<class ContainerT>
+        void copy_write_back(ContainerT& container) const {
+            std::shared_lock<std::shared_mutex> locker(m_wb_mutex);
+            reserve_capacity(container, container.size() + m_wb_values.size());
+            for (const auto& pair : m_wb_values) {
+                emplace_row(container, pair.first, pair.second);
+            }
+        }
+
+        /// \brief Leases a read-only connection if reads may bypass the main connection.
+        /// \return Lease over a reader, or an empty lease if reads must use the main connection.
+        typename ReaderPool<ReadStmts>::Lease db_acquire_reader() const {
+            if (!db_can_use_readers()) return typename ReaderPool<ReadStmts>::Lease();
+            return m_readers.acquire();
+        }
+
+        /// \brief Leases a read-only connection for a worker of load_parallel().
+        /// \return Lease over a reader.
+        /// \throws sqlite_exception if the read-only connections were closed.
+        typename ReaderPool<ReadStmts>::Lease db_lease_reader() const {
+            auto reader = m_readers.acquire();
+            if (!reader) throw sqlite_exception("Read-only connections were closed during the load.");
+            return reader;
+        }
+
+        /// \brief Returns the name of the main table.
+        static std::string get_table_name(const Config &config) {
+            return config.table_name.empty() ? "kv_store" : config.table_name;
+        }
+
+        /// \brief SQL of the value column, which depends on `Config::value_compression_level` and `Config::dedup_values`.
+        struct ValueSql {
+            std::string type;       ///< Type of the value column of the main and temporary tables.
+            std::string select;     ///< Expression reading the value of a row of the main table.
+            std::string bind;       ///< Expression writing a bound value to the main or temporary table.
+            std::string values_table; ///< Name of the values table, empty without deduplication.
+            std::string values_type;  ///< Type of the value column of the values table.
+            std::string stored;     ///< Expression turning `column1` into the stored value of the values table.
+        };
+
+        /// \brief Builds the SQL of the value column.
+        /// Compressed values are written through `sc_deflate()` and read through `sc_inflate()`. With deduplication
+        /// the value column holds the SHA-256 digest of the value, and the value itself is stored once in the
+        /// values table under its digest.
+        /// \param config Configuration settings for the database.
+        /// \throws sqlite_exception if the compression level is invalid or zlib support is not compiled in.
+        static ValueSql get_value_sql(const Config &config) {
+            const int level = config.value_compression_level;
+            if (level < 0 || level > 9) throw sqlite_exception("Value compression level must be between 0 and 9.");
+#           ifndef SQLITE_CONTAINERS_USE_ZLIB
+            if (level > 0) throw sqlite_exception("Value compression requires SQLITE_CONTAINERS_USE_ZLIB.");
+#           endif
+            auto encode = [level](const std::string& param) {
+                return level > 0 ? "sc_deflate(" + param + ", " + std::to_string(level) + ")" : param;
+            };
+            auto decode = [level](const std::string& column) {
+                return level > 0 ? "sc_inflate(" + column + ")" : column;
+            };
+
+            ValueSql sql;
+            sql.values_type = level > 0 ? "BLOB" : get_sqlite_type<ValueT>();
+            if (config.dedup_values) {
+                sql.values_table = get_table_name(config) + "_blobs";
+                sql.type = "BLOB";
+                sql.select = "(SELECT " + decode("value") + " FROM " + sql.values_table + " WHERE digest = " + get_table_name(config) + ".value)";
+                sql.bind = "sc_digest(?)";
+                sql.stored = encode("column1");
+            } else {
+                sql.type = sql.values_type;
+                sql.select = decode("value");
+                sql.bind = encode("?");
+            }
+            return sql;
+        }
+
+        /// \brief Decodes a row of `m_stmt_load`.
+        static std::pair<KeyT, ValueT> decode_row(SqliteStmt& stmt) {
+            return std::pair<KeyT, ValueT>(stmt.extract_column<KeyT>(0), stmt.extract_column<ValueT>(1));
+        }
+
+        /// \brief Binds the bounds and the limit of a range statement and opens a cursor over it.
+        /// The bounds are copied into `m_range_bounds`, which stays unchanged while the cursor holds the lock,
+        /// so the cursor does not depend on the lifetime of the arguments.
+        /// \param locker Lock of the connection, moved into the cursor.
+        /// \param stmt Range statement taking one or two bounds followed by the limit.
+        /// \param from First bound.
+        /// \param to Second bound, or nullptr if the statement takes one bound.
+        /// \param limit Maximum number of pairs; 0 means no limit.
+        /// \return Cursor over the pairs of the range.
+        Cursor<std::pair<KeyT, ValueT>> db_open_range(
+                std::unique_lock<std::mutex> locker,
+                SqliteStmt& stmt,
+                const KeyT& from,
+                const KeyT* to,
+                const std::size_t& limit) {
+            if (m_write_back) db_flush_buffered();
+            int index = 1;
+            m_range_bounds.first = from;
+            stmt.bind_value<KeyT>(index++, m_range_bounds.first);
+            if (to) {
+                m_range_bounds.second = *to;
+                stmt.bind_value<KeyT>(index++, m_range_bounds.second);
+            }
+            stmt.bind_value<int64_t>(index, to_sql_limit(limit));
+            return Cursor<std::pair<KeyT, ValueT>>(std::move(locker), m_sqlite_db, stmt, &decode_row);
+        }
+
+        /// \brief Reads the pair with the smallest or the largest key.
+        /// \param last True for the largest key, false for the smallest.
+        /// \param key Receives the key.
+        /// \param value Receives the value.
+        /// \return True if the table is not empty, false otherwise.
+        bool read_edge(const bool& last, KeyT& key, ValueT& value) {
+            std::vector<std::pair<KeyT, ValueT>> rows;
+            auto no_bounds = [](SqliteStmt&) {};
+            auto reader = m_write_back ? typename ReaderPool<ReadStmts>::Lease() : db_acquire_reader();
+            if (reader) {
+                db_load_range(last ? reader->stmts.last : reader->stmts.first, no_bounds, rows);
+            } else {
+                std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+                if (m_write_back) db_flush_buffered();
+                db_load_range(last ? m_stmt_last : m_stmt_first, no_bounds, rows);
+            }
+            if (rows.empty()) return false;
+            key = std::move(rows.front().first);
+            value = std::move(rows.front().second);
+            return true;
+        }
+
+        /// \brief Opens an incremental BLOB handle over the value of a key.
+        /// \param locker Lock of the connection, moved into the stream.
+        /// \param key The key of the value.
+        /// \param writable True to open the value for writing.
+        /// \param size Size of a zero-filled value to insert first, or null to open the stored value.
+        /// \return Open stream, or a closed stream if the key is not found.
+        /// \throws sqlite_exception if the table does not support incremental I/O or an SQLite error occurs.
+        BlobStream db_open_blob(std::unique_lock<std::mutex> locker, const KeyT& key, const bool& writable, const std::size_t* size) {
+            if (!m_blob_io || m_write_back) {
+                throw sqlite_exception("Incremental BLOB I/O requires a rowid table without value compression, deduplication and write-back.");
+            }
+            sqlite3_blob* blob = nullptr;
+            try {
+                int64_t rowid = 0;
+                bool is_found = false;
+                if (size) {
+                    m_cache.erase(key);
+                    m_stmt_replace_zeroblob.bind_value<KeyT>(1, key);
+                    m_stmt_replace_zeroblob.bind_value<int64_t>(2, static_cast<int64_t>(*size));
+                    m_stmt_replace_zeroblob.execute();
+                    m_stmt_replace_zeroblob.reset();
+                    m_stmt_replace_zeroblob.clear_bindings();
+                    db_cache_written(key);
+                    rowid = sqlite3_last_insert_rowid(m_sqlite_db);
+                    is_found = true;
+                } else {
+                    BusyRetry busy_retry(m_sqlite_db);
+                    int err;
+                    for (;;) {
+                        m_stmt_get_rowid.bind_value<KeyT>(1, key);
+                        while ((err = m_stmt_get_rowid.step()) == SQLITE_ROW) {
+                            rowid = m_stmt_get_rowid.extract_column<int64_t>(0);
+                            is_found = true;
+                        }
+                        sqlite3_reset(m_stmt_get_rowid.get_stmt());
+                        m_stmt_get_rowid.clear_bindings();
+                        if (err == SQLITE_DONE) break;
+                        if (err == SQLITE_BUSY) {
+                            // Handle busy database, retry reading
+                            is_found = false;
+                            busy_retry.wait();
+                            continue;
+                        }
+                        // Handle SQLite errors
+                        std::string err_msg = "SQLite error: ";
+                        err_msg += std::to_string(err);
+                        err_msg += ", ";
+                        err_msg += sqlite3_errmsg(m_sqlite_db);
+                        throw sqlite_exception(err_msg, err);
+                    }
+                }
+                if (!is_found) return BlobStream();
+
+                BusyRetry busy_retry(m_sqlite_db);
+                int err;
+                while ((err = sqlite3_blob_open(m_sqlite_db, "main", m_table_name.c_str(), "value", rowid, writable ? 1 : 0, &blob)) == SQLITE_BUSY) {
+                    busy_retry.wait();
+                }
+                if (err != SQLITE_OK) {
+                    std::string err_msg = "SQLite error: ";
+                    err_msg += std::to_string(err);
+                    err_msg += ", ";
+                    err_msg += sqlite3_errmsg(m_sqlite_db);
+                    throw sqlite_exception(err_msg, err);
+                }
+            } catch (...) {
+                db_handle_exception(
+                    std::current_exception(),
+                    {&m_stmt_get_rowid, &m_stmt_replace_zeroblob},
+                    "Unknown error occurred while opening a BLOB value.");
+            }
+            if (!writable) return BlobStream(std::move(locker), m_sqlite_db, blob);
+            if (!size) {
+                m_cache.erase(key);
+                db_cache_written(key);
+            }
+            // Readers may have cached the old value until the writes were committed by the close
+            return BlobStream(std::move(locker), m_sqlite_db, blob, [this, key]() {
+                db_cache_written(key);
+            });
+        }
+
         /// \brief Creates the main and temporary tables in the database.
         /// This method creates both the main key-value table and a temporary table for handling synchronization.
         /// \param config Configuration settings for the database, such as table names.
         void db_create_table(const Config &config) override final {
-            const std::string table_name = config.table_name.empty() ? "kv_store" : config.table_name;
+            const std::string table_name = get_table_name(config);
             const std::string temp_table_name = config.table_name.empty() ? "kv_temp_store" : config.table_name + "_temp";
+            const ValueSql value_sql = get_value_sql(config);
+            const std::string& value = value_sql.select;
+            if (config.value_compression_level > 0 || config.dedup_values) register_value_functions(m_sqlite_db);
 
             // Create table if they do not exist
             const std::string create_table_sql =
                 "CREATE TABLE IF NOT EXISTS " + table_name + " ("
                 "key " + get_sqlite_type<KeyT>() + " PRIMARY KEY NOT NULL,"
-                "value " + get_sqlite_type<ValueT>() + "         NOT NULL);";
+                "value " + value_sql.type + "         NOT NULL)" + to_table_options(config.table_layout) + ";";
             execute(m_sqlite_db, create_table_sql);
+            m_has_rowid = sqlite_containers::has_rowid(m_sqlite_db, table_name);
+            m_table_name = table_name;
+            m_blob_io = m_has_rowid && config.value_compression_level == 0 && !config.dedup_values;
 
             // Create the temporary table for synchronization if it does not exist
             const std::string create_temp_table_sql =
                 "CREATE TEMPORARY TABLE IF NOT EXISTS " + temp_table_name + " ("
                 "key " + get_sqlite_type<KeyT>() + " PRIMARY KEY NOT NULL,"
-                "value " + get_sqlite_type<ValueT>() + "         NOT NULL);";
+                "value " + value_sql.type + "         NOT NULL);";
             execute(m_sqlite_db, create_temp_table_sql);
 
+            // Create the table holding each distinct value once, addressed by its digest
+            m_dedup_values = config.dedup_values;
+            if (m_dedup_values) {
+                const std::string& values_table = value_sql.values_table;
+                execute(m_sqlite_db,
+                    "CREATE TABLE IF NOT EXISTS " + values_table + " ("
+                    "digest BLOB PRIMARY KEY NOT NULL,"
+                    "value " + value_sql.values_type + " NOT NULL);");
+                m_stmt_intern.init(m_sqlite_db,
+                    "INSERT OR IGNORE INTO " + values_table + " (digest, value) "
+                    "SELECT sc_digest(column1), " + value_sql.stored + " FROM (VALUES (?));", true);
+                m_bulk_intern.init(m_sqlite_db,
+                    "INSERT OR IGNORE INTO " + values_table + " (digest, value) "
+                    "SELECT sc_digest(column1), " + value_sql.stored + " FROM (VALUES ", "(?)", ", ", ");", 1);
+                m_stmt_purge_values.defer(m_sqlite_db, "DELETE FROM " + values_table + " WHERE digest NOT IN (SELECT value FROM " + table_name + ");", true);
+                m_stmt_clear_values.defer(m_sqlite_db, "DELETE FROM " + values_table + ";", true);
+            }
+
+            m_cache.set_capacity(config.read_cache_bytes);
+            m_cache_pending.clear();
+            m_cache_pending_all = false;
+
             // Initialize prepared statements for operations on the main table
-            m_stmt_load.init(m_sqlite_db, "SELECT key, value FROM " + table_name + ";");
-            m_stmt_replace.init(m_sqlite_db, "REPLACE INTO  " + table_name + " (key, value) VALUES (?, ?);");
-            m_stmt_get_value.init(m_sqlite_db, "SELECT value FROM " + table_name + " WHERE key = ?;");
-            m_stmt_count.init(m_sqlite_db, "SELECT COUNT(*) FROM " + table_name + ";");
-            m_stmt_remove.init(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key = ?;");
-            m_stmt_clear_main.init(m_sqlite_db, "DELETE FROM " + table_name);
+            m_stmt_load.init(m_sqlite_db, "SELECT key, " + value + " FROM " + table_name + ";", true);
+            m_stmt_load_sorted.defer(m_sqlite_db, "SELECT key, " + value + " FROM " + table_name + " ORDER BY key;", true);
+            m_stmt_replace.init(m_sqlite_db, "REPLACE INTO  " + table_name + " (key, value) VALUES (?, " + value_sql.bind + ");", true);
+            m_stmt_get_value.init(m_sqlite_db, "SELECT " + value + " FROM " + table_name + " WHERE key = ?;", true);
+            m_stmt_count.init(m_sqlite_db, "SELECT COUNT(*) FROM " + table_name + ";", true);
+            m_stmt_remove.init(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key = ?;", true);
+            m_stmt_clear_main.defer(m_sqlite_db, "DELETE FROM " + table_name, true);
+            m_stmt_range.defer(m_sqlite_db, "SELECT key, " + value + " FROM " + table_name + " WHERE key >= ? AND key < ? ORDER BY key LIMIT ?;", true);
+            m_stmt_lower_bound.defer(m_sqlite_db, "SELECT key, " + value + " FROM " + table_name + " WHERE key >= ? ORDER BY key LIMIT ?;", true);
+            m_stmt_upper_bound.defer(m_sqlite_db, "SELECT key, " + value + " FROM " + table_name + " WHERE key > ? ORDER BY key LIMIT ?;", true);
+            m_stmt_first.defer(m_sqlite_db, "SELECT key, " + value + " FROM " + table_name + " ORDER BY key LIMIT 1;", true);
+            m_stmt_last.defer(m_sqlite_db, "SELECT key, " + value + " FROM " + table_name + " ORDER BY key DESC LIMIT 1;", true);
+            m_stmt_range_remove.defer(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key >= ? AND key < ?;", true);
+            if (m_blob_io) {
+                m_stmt_get_rowid.defer(m_sqlite_db, "SELECT rowid FROM " + table_name + " WHERE key = ?;", true);
+                m_stmt_replace_zeroblob.defer(m_sqlite_db, "REPLACE INTO " + table_name + " (key, value) VALUES (?, zeroblob(?));", true);
+            }
 
             // Initialize prepared statements for temporary table operations
-            m_stmt_insert_temp.init(m_sqlite_db, "INSERT OR REPLACE INTO " + temp_table_name + " (key, value) VALUES (?, ?);");
-            m_stmt_purge_main.init(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key NOT IN (SELECT key FROM " + temp_table_name + ");");
-            m_stmt_merge_temp.init(m_sqlite_db, "INSERT OR REPLACE INTO " + table_name + " (key, value) SELECT key, value FROM " + temp_table_name + ";");
-            m_stmt_clear_temp.init(m_sqlite_db, "DELETE FROM " + temp_table_name + ";");
+            m_stmt_purge_main.defer(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key NOT IN (SELECT key FROM " + temp_table_name + ");", true);
+            m_stmt_merge_temp.defer(m_sqlite_db, "INSERT OR IGNORE INTO " + table_name + " (key, value) SELECT key, value FROM " + temp_table_name + ";", true);
+#           if SQLITE_VERSION_NUMBER >= 3033000
+            m_stmt_update_temp.defer(m_sqlite_db,
+                "UPDATE " + table_name + " SET value = " + temp_table_name + ".value FROM " + temp_table_name + " "
+                "WHERE " + table_name + ".key = " + temp_table_name + ".key AND " + table_name + ".value IS NOT " + temp_table_name + ".value;", true);
+#           else
+            m_stmt_update_temp.defer(m_sqlite_db,
+                "UPDATE " + table_name + " SET value = (SELECT value FROM " + temp_table_name + " WHERE " + temp_table_name + ".key = " + table_name + ".key) "
+                "WHERE EXISTS (SELECT 1 FROM " + temp_table_name + " "
+                "WHERE " + temp_table_name + ".key = " + table_name + ".key AND " + temp_table_name + ".value IS NOT " + table_name + ".value);", true);
+#           endif
+            m_stmt_clear_temp.defer(m_sqlite_db, "DELETE FROM " + temp_table_name + ";", true);
+
+            // Initialize multi-row statements for bulk operations
+            m_bulk_replace.init(m_sqlite_db, "REPLACE INTO " + table_name + " (key, value) VALUES ", "(?, " + value_sql.bind + ")", ", ", ";", 2);
+            m_bulk_insert_temp.init(m_sqlite_db, "INSERT OR REPLACE INTO " + temp_table_name + " (key, value) VALUES ", "(?, " + value_sql.bind + ")", ", ", ";", 2);
+            m_bulk_find.init(m_sqlite_db, "SELECT key, " + value + " FROM " + table_name + " WHERE key IN (", "?", ", ", ");", 1);
+            m_bulk_remove.init(m_sqlite_db, "DELETE FROM " + table_name + " WHERE key IN (", "?", ", ", ");", 1);
+
+            // Warm the in-memory map from the table
+            m_write_back = config.write_back;
+            m_wb_resync = false;
+            if (config.write_back) {
+                db_warm_write_back();
+            } else {
+                std::unique_lock<std::shared_mutex> locker(m_wb_mutex);
+                m_wb_values.clear();
+                m_wb_dirty.clear();
+            }
         }
 
-        /// \brief Loads data from the database into the container.
-        /// \tparam ContainerT Template for the container type.
-        /// \param container Container to be synchronized with database content.
+        /// \brief Opens the read-only connections and prepares their statements.
+        /// \param config Configuration settings for the database.
+        void db_open_readers(const Config &config) override final {
+            const std::string table_name = get_table_name(config);
+            const bool has_rowid = m_has_rowid;
+            const bool value_functions = config.value_compression_level > 0 || config.dedup_values;
+            const std::string value = get_value_sql(config).select;
+            m_readers.open(config, [&table_name, &value, has_rowid, value_functions](sqlite3* sqlite_db, ReadStmts& stmts) {
+                if (value_functions) register_value_functions(sqlite_db);
+                stmts.load.init(sqlite_db, "SELECT key, " + value + " FROM " + table_name + ";", true);
+                stmts.load_sorted.defer(sqlite_db, "SELECT key, " + value + " FROM " + table_name + " ORDER BY key;", true);
+                stmts.get_value.init(sqlite_db, "SELECT " + value + " FROM " + table_name + " WHERE key = ?;", true);
+                stmts.count.init(sqlite_db, "SELECT COUNT(*) FROM " + table_name + ";", true);
+                stmts.find_many.init(sqlite_db, "SELECT key, " + value + " FROM " + table_name + " WHERE key IN (", "?", ", ", ");", 1);
+                stmts.first.defer(sqlite_db, "SELECT key, " + value + " FROM " + table_name + " ORDER BY key LIMIT 1;", true);
+                stmts.last.defer(sqlite_db, "SELECT key, " + value + " FROM " + table_name + " ORDER BY key DESC LIMIT 1;", true);
+                if (has_rowid) {
+                    stmts.rowid_range.defer(sqlite_db, "SELECT MIN(rowid), MAX(rowid) FROM " + table_name + ";", true);
+                    stmts.load_range.defer(sqlite_db, "SELECT key, " + value + " FROM " + table_name + " WHERE rowid BETWEEN ? AND ?;", true);
+                } else {
+                    stmts.key_at.defer(sqlite_db, "SELECT key FROM " + table_name + " ORDER BY key LIMIT 1 OFFSET ?;", true);
+                    stmts.load_range.defer(sqlite_db, "SELECT key, " + value + " FROM " + table_name + " WHERE key >= ? AND key < ?;", true);
+                    stmts.load_tail.defer(sqlite_db, "SELECT key, " + value + " FROM " + table_name + " WHERE key >= ?;", true);
+                }
+            });
+        }
+
+        /// \brief Closes the read-only connections.
+        void db_close_readers() override final {
+            m_readers.close();
+        }
+
+        /// \brief Invalidates the cached keys written by the committed transaction.
+        void on_db_commit() override final {
+            if (m_cache_pending_all) {
+                m_cache.clear();
+            } else {
+                for (const auto& key : m_cache_pending) {
+                    m_cache.erase(key);
+                }
+            }
+            m_cache_pending.clear();
+            m_cache_pending_all = false;
+        }
+
+        /// \brief Forgets the keys written by the rolled back transaction.
+        /// The cache only holds committed values, so it stays valid. In write-back mode the map already holds
+        /// the changes of the transaction, so the whole table is rewritten on the next write-back.
+        void on_db_rollback() override final {
+            m_cache_pending.clear();
+            m_cache_pending_all = false;
+            if (m_write_back) m_wb_resync = true;
+        }
+
+        /// \brief Writes the keys changed since the last write-back to the table in one transaction.
+        /// Joins the transaction opened by the user if there is one. If the write fails, the keys stay dirty
+        /// and are written by the next write-back.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void db_load(ContainerT<KeyT, ValueT>& container) {
+        void db_flush_buffered() override final {
+            if (!m_write_back) return;
+            std::vector<std::pair<KeyT, ValueT>> replaced;
+            std::vector<KeyT> removed;
+            WriteBackKeys dirty;
+            const bool resync = m_wb_resync;
+            std::unique_lock<std::shared_mutex> wb_locker(m_wb_mutex);
+            if (resync) {
+                replaced.assign(m_wb_values.begin(), m_wb_values.end());
+                m_wb_dirty.clear();
+            } else {
+                if (m_wb_dirty.empty()) return;
+                dirty.swap(m_wb_dirty);
+                for (const auto& key : dirty) {
+                    auto it = m_wb_values.find(key);
+                    if (it == m_wb_values.end()) {
+                        removed.push_back(key);
+                    } else {
+                        replaced.emplace_back(it->first, it->second);
+                    }
+                }
+            }
+            wb_locker.unlock();
+
+            const bool own_transaction = sqlite3_get_autocommit(m_sqlite_db);
+            try {
+                if (own_transaction) db_begin(get_config().default_txn_mode);
+                m_wb_resync = false;
+                if (resync) {
+                    db_write_back_all(replaced);
+                } else {
+                    db_intern_values(replaced.begin(), replaced.size());
+                    m_bulk_replace.execute(replaced.begin(), replaced.size(), bind_pair<std::pair<KeyT, ValueT>>);
+                    for (const auto& key : removed) {
+                        m_stmt_remove.bind_value<KeyT>(1, key);
+                        m_stmt_remove.execute();
+                        m_stmt_remove.reset();
+                        m_stmt_remove.clear_bindings();
+                    }
+                }
+                if (own_transaction) db_commit();
+            } catch (...) {
+                if (own_transaction && !sqlite3_get_autocommit(m_sqlite_db)) {
+                    try {
+                        db_rollback();
+                    } catch (...) {}
+                }
+                if (resync) m_wb_resync = true;
+                wb_locker.lock();
+                m_wb_dirty.insert(dirty.begin(), dirty.end());
+                wb_locker.unlock();
+                db_handle_exception(
+                    std::current_exception(), {&m_stmt_remove},
+                    "Unknown error occurred while writing back changed key-value pairs.");
+            }
+        }
+
+        /// \brief Replaces the whole table with the given pairs.
+        /// \param pairs All pairs of the write-back map.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void db_write_back_all(const std::vector<std::pair<KeyT, ValueT>>& pairs) {
+            m_stmt_clear_temp.execute();
+            m_stmt_clear_temp.reset();
+            db_intern_values(pairs.begin(), pairs.size());
+            m_bulk_insert_temp.execute(pairs.begin(), pairs.size(), bind_pair<std::pair<KeyT, ValueT>>);
+            db_merge_temp();
+        }
+
+        /// \brief Applies the difference between the temporary table and the main table, then clears the temporary table.
+        /// Rows that are already equal are not written.
+        /// \return Numbers of inserted, updated and removed rows.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        ReconcileStats db_merge_temp() {
+            ReconcileStats stats;
+
+            // Remove old data from the main table that is not in the temporary table
+            m_stmt_purge_main.execute();
+            m_stmt_purge_main.reset();
+            stats.removed = static_cast<std::size_t>(sqlite3_changes(m_sqlite_db));
+
+            // Update the values that differ
+            m_stmt_update_temp.execute();
+            m_stmt_update_temp.reset();
+            stats.updated = static_cast<std::size_t>(sqlite3_changes(m_sqlite_db));
+
+            // Insert the keys that are missing from the main table
+            m_stmt_merge_temp.execute();
+            m_stmt_merge_temp.reset();
+            stats.inserted = static_cast<std::size_t>(sqlite3_changes(m_sqlite_db));
+
+            // Clear the temporary table
+            m_stmt_clear_temp.execute();
+            m_stmt_clear_temp.reset();
+            db_purge_values();
+            return stats;
+        }
+
+        /// \brief Stores the values of pairs in the values table before the pairs are written.
+        /// Does nothing without `Config::dedup_values`; values that are already stored are not written again.
+        /// \tparam IteratorT Input iterator over the pairs.
+        /// \param first Iterator to the first pair.
+        /// \param count Number of pairs.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<typename IteratorT>
+        void db_intern_values(IteratorT first, const std::size_t& count) {
+            if (!m_dedup_values) return;
+            m_bulk_intern.execute(first, count, bind_pair_value<typename std::iterator_traits<IteratorT>::value_type>);
+        }
+
+        /// \brief Removes the stored values that no key refers to.
+        /// \return Number of removed values; 0 without `Config::dedup_values`.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        std::size_t db_purge_values() {
+            if (!m_dedup_values) return 0;
+            try {
+                m_stmt_purge_values.execute();
+                m_stmt_purge_values.reset();
+                return static_cast<std::size_t>(sqlite3_changes(m_sqlite_db));
+            } catch (...) {
+                db_handle_exception(
+                    std::current_exception(),
+                    {&m_stmt_purge_values},
+                    "Unknown error occurred while purging unused values.");
+            }
+            return 0;
+        }
+
+        /// \brief Loads the table into the write-back map.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void db_warm_write_back() {
+            WriteBackMap values;
+            BusyRetry busy_retry(m_sqlite_db);
             int err;
             try {
                 for (;;) {
                     while ((err = m_stmt_load.step()) == SQLITE_ROW) {
-                        KeyT key = m_stmt_load.extract_column<KeyT>(0);
-                        ValueT value = m_stmt_load.extract_column<ValueT>(1);
-                        container.emplace(std::move(key), std::move(value));
+                        values.insert_or_assign(m_stmt_load.extract_column<KeyT>(0), m_stmt_load.extract_column<ValueT>(1));
                     }
                     if (err == SQLITE_DONE) {
                         m_stmt_load.reset();
-                        return;
+                        break;
                     }
                     if (err == SQLITE_BUSY) {
                         // Handle busy database, retry reading
-                        m_stmt_load.reset();
-                        sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                        values.clear();
+                        sqlite3_reset(m_stmt_load.get_stmt());
+                        busy_retry.wait();
                         continue;
                     }
                     // Handle SQLite errors
@@ -310,154 +1421,420 @@ namespace sqlite_containers {
                 db_handle_exception(
                     std::current_exception(),
                     {&m_stmt_load},
+                    "Unknown error occurred while loading the write-back map.");
+            }
+            std::unique_lock<std::shared_mutex> locker(m_wb_mutex);
+            m_wb_values.swap(values);
+            m_wb_dirty.clear();
+        }
+
+        /// \brief Invalidates a written key once the write is committed.
+        /// Readers may have cached the old value between the write and its commit, so the key is
+        /// invalidated again when the write becomes visible to them.
+        /// \param key The written key.
+        void db_cache_written(const KeyT& key) {
+            if (!m_cache.enabled()) return;
+            if (sqlite3_get_autocommit(m_sqlite_db)) {
+                m_cache.erase(key);
+                return;
+            }
+            if (m_cache_pending_all) return;
+            if (m_cache_pending.size() >= CACHE_PENDING_MAX) {
+                m_cache_pending.clear();
+                m_cache_pending_all = true;
+                return;
+            }
+            m_cache_pending.push_back(key);
+        }
+
+        /// \brief Invalidates the whole cache once a bulk change is committed.
+        void db_cache_written_all() {
+            if (!m_cache.enabled()) return;
+            if (sqlite3_get_autocommit(m_sqlite_db)) {
+                m_cache.clear();
+                return;
+            }
+            m_cache_pending.clear();
+            m_cache_pending_all = true;
+        }
+
+        /// \brief Binds a key to a statement parameter.
+        /// \param stmt The statement to bind to.
+        /// \param index Index of the parameter.
+        /// \param key The key to bind.
+        static void bind_key(SqliteStmt& stmt, const int& index, const KeyT& key) {
+            stmt.bind_value<KeyT>(index, key);
+        }
+
+        /// \brief Binds a key-value pair to two consecutive statement parameters.
+        /// \param stmt The statement to bind to.
+        /// \param index Index of the key parameter.
+        /// \param pair The key-value pair.
+        template<typename PairT>
+        static void bind_pair(SqliteStmt& stmt, const int& index, const PairT& pair) {
+            stmt.bind_value<KeyT>(index, pair.first);
+            stmt.bind_value<ValueT>(index + 1, pair.second);
+        }
+
+        /// \brief Binds the value of a key-value pair to a statement parameter.
+        /// \param stmt The statement to bind to.
+        /// \param index Index of the parameter.
+        /// \param pair The key-value pair.
+        template<typename PairT>
+        static void bind_pair_value(SqliteStmt& stmt, const int& index, const PairT& pair) {
+            stmt.bind_value<ValueT>(index, pair.second);
+        }
+
+        /// \brief Loads all key-value pairs into a container, choosing the statement by the container.
+        /// Sequences and flat sorted containers (see is_sorted_load_target) read the rows in key order; containers
+        /// with `reserve()` first reserve room for the counted rows.
+        /// \param load Statement reading the table in storage order.
+        /// \param load_sorted Statement reading the table in key order.
+        /// \param count Statement counting the rows.
+        /// \param container Container to load the data into.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<class ContainerT>
+        void db_load_all(SqliteStmt& load, SqliteStmt& load_sorted, SqliteStmt& count, ContainerT& container) {
+            if constexpr (has_reserve<ContainerT>::value) {
+                reserve_capacity(container, container.size() + db_count(count));
+            }
+            db_load(is_sorted_load_target<ContainerT>::value ? load_sorted : load, container);
+        }
+
+        /// \brief Loads data from the database into the container.
+        /// \tparam ContainerT Associative container of the pairs or sequence of `std::pair<KeyT, ValueT>`.
+        /// \param stmt Load statement of the connection to read from.
+        /// \param container Container to be synchronized with database content.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<class ContainerT>
+        void db_load(SqliteStmt& stmt, ContainerT& container) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::LOAD);
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
+            int err;
+            try {
+                for (;;) {
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        KeyT key = stmt.extract_column<KeyT>(0);
+                        ValueT value = stmt.extract_column<ValueT>(1);
+                        emplace_row(container, std::move(key), std::move(value));
+                    }
+                    if (err == SQLITE_DONE) {
+                        stmt.reset();
+                        return;
+                    }
+                    if (err == SQLITE_BUSY) {
+                        // Handle busy database, retry reading
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
+                        continue;
+                    }
+                    // Handle SQLite errors
+                    std::string err_msg = "SQLite error: ";
+                    err_msg += std::to_string(err);
+                    err_msg += ", ";
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
+                    throw sqlite_exception(err_msg, err);
+                }
+            } catch (...) {
+                db_handle_exception(
+                    std::current_exception(),
+                    {&stmt},
                     "Unknown error occurred while loading data from database.");
             }
         }
 
+        /// \brief Finds the values of several keys in the database.
+        /// \tparam KeyContainerT Container type of the keys.
+        /// \tparam ContainerT Container type receiving the pairs.
+        /// \param bulk_find Multi-key statement of the connection to read from.
+        /// \param keys The keys to search for.
+        /// \param container Container receiving the found key-value pairs.
+        /// \return The number of rows found.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class KeyContainerT, template <class...> class ContainerT, class... KeyArgs, class... ContainerArgs>
+        std::size_t db_find_many(ChunkedStmt& bulk_find, const KeyContainerT<KeyT, KeyArgs...>& keys, ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            std::size_t found = 0;
+            try {
+                bulk_find.query(keys.begin(), keys.size(), bind_key, [&container, &found](SqliteStmt& stmt) {
+                    container.emplace(stmt.extract_column<KeyT>(0), stmt.extract_column<ValueT>(1));
+                    ++found;
+                });
+            } catch (...) {
+                db_handle_exception(std::current_exception(), {}, "Unknown error occurred while finding values by keys.");
+            }
+            return found;
+        }
+
         /// \brief Finds a value by key in the database.
+        /// \param stmt Lookup statement of the connection to read from.
         /// \param key The key to search for.
         /// \param value The value associated with the key.
         /// \return True if the key was found, false otherwise.
         /// \throws sqlite_exception if an SQLite error occurs.
-        bool db_find(const KeyT& key, ValueT& value) {
+        bool db_find(SqliteStmt& stmt, const KeyT& key, ValueT& value) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::FIND);
             bool is_found = false;
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
             int err;
             try {
                 for (;;) {
-                    m_stmt_get_value.bind_value<KeyT>(1, key);
-                    while ((err = m_stmt_get_value.step()) == SQLITE_ROW) {
-                        value = m_stmt_get_value.extract_column<ValueT>(0);
+                    stmt.bind_value<KeyT>(1, key);
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        stmt.extract_column(0, value);
                         is_found = true;
                     }
                     if (err == SQLITE_DONE) {
-                        m_stmt_get_value.reset();
-                        m_stmt_get_value.clear_bindings();
+                        stmt.reset();
+                        stmt.clear_bindings();
                         return is_found;
                     }
                     if (err == SQLITE_BUSY) {
                         // Handle busy database, retry reading
-                        m_stmt_get_value.reset();
-                        m_stmt_get_value.clear_bindings();
-                        sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                        sqlite3_reset(stmt.get_stmt());
+                        stmt.clear_bindings();
+                        busy_retry.wait();
                         continue;
                     }
                     // Handle SQLite errors
                     std::string err_msg = "SQLite error: ";
                     err_msg += std::to_string(err);
                     err_msg += ", ";
-                    err_msg += sqlite3_errmsg(m_sqlite_db);
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
                     throw sqlite_exception(err_msg, err);
                 }
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(),
-                    {&m_stmt_get_value},
+                    {&stmt},
                     "Unknown error occurred while retrieving value for the provided key.");
             }
             return false;
         }
 
+        /// \brief Reads the smallest and the largest rowid of the table.
+        /// \param stmt Rowid range statement of the connection to read from.
+        /// \param min_rowid Receives the smallest rowid.
+        /// \param max_rowid Receives the largest rowid.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void db_rowid_range(SqliteStmt& stmt, int64_t& min_rowid, int64_t& max_rowid) const {
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
+            int err;
+            try {
+                for (;;) {
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        min_rowid = stmt.extract_column<int64_t>(0);
+                        max_rowid = stmt.extract_column<int64_t>(1);
+                    }
+                    if (err == SQLITE_DONE) {
+                        stmt.reset();
+                        return;
+                    }
+                    if (err == SQLITE_BUSY) {
+                        // Handle busy database, retry reading
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
+                        continue;
+                    }
+                    // Handle SQLite errors
+                    std::string err_msg = "SQLite error: ";
+                    err_msg += std::to_string(err);
+                    err_msg += ", ";
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
+                    throw sqlite_exception(err_msg, err);
+                }
+            } catch (...) {
+                db_handle_exception(
+                    std::current_exception(),
+                    {&stmt},
+                    "Unknown error occurred while reading the rowid range.");
+            }
+        }
+
+        /// \brief Reads the key at an offset in key order.
+        /// \param stmt Key statement of the connection to read from.
+        /// \param offset Number of keys before the key.
+        /// \param key Receives the key.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void db_key_at(SqliteStmt& stmt, const int64_t& offset, KeyT& key) const {
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
+            int err;
+            try {
+                stmt.bind_value<int64_t>(1, offset);
+                for (;;) {
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        key = stmt.extract_column<KeyT>(0);
+                    }
+                    if (err == SQLITE_DONE) {
+                        stmt.reset();
+                        stmt.clear_bindings();
+                        return;
+                    }
+                    if (err == SQLITE_BUSY) {
+                        // Handle busy database, retry reading
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
+                        continue;
+                    }
+                    // Handle SQLite errors
+                    std::string err_msg = "SQLite error: ";
+                    err_msg += std::to_string(err);
+                    err_msg += ", ";
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
+                    throw sqlite_exception(err_msg, err);
+                }
+            } catch (...) {
+                db_handle_exception(
+                    std::current_exception(),
+                    {&stmt},
+                    "Unknown error occurred while reading a key boundary.");
+            }
+        }
+
+        /// \brief Loads the pairs of a rowid or key range.
+        /// \tparam BindFunc Callable `void(SqliteStmt&)` that binds the bounds of the range.
+        /// \param stmt Range load statement of the connection to read from.
+        /// \param bind Function that binds the bounds of the range.
+        /// \param pairs Receives the pairs of the range.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<typename BindFunc>
+        void db_load_range(SqliteStmt& stmt, BindFunc bind, std::vector<std::pair<KeyT, ValueT>>& pairs) const {
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
+            int err;
+            try {
+                bind(stmt);
+                for (;;) {
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        pairs.push_back(decode_row(stmt));
+                    }
+                    if (err == SQLITE_DONE) {
+                        stmt.reset();
+                        stmt.clear_bindings();
+                        return;
+                    }
+                    if (err == SQLITE_BUSY) {
+                        // The range is read again from the start
+                        pairs.clear();
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
+                        continue;
+                    }
+                    // Handle SQLite errors
+                    std::string err_msg = "SQLite error: ";
+                    err_msg += std::to_string(err);
+                    err_msg += ", ";
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
+                    throw sqlite_exception(err_msg, err);
+                }
+            } catch (...) {
+                db_handle_exception(
+                    std::current_exception(),
+                    {&stmt},
+                    "Unknown error occurred while loading a range of key-value pairs.");
+            }
+        }
+
         /// \brief Returns the number of elements in the database.
+        /// \param stmt Count statement of the connection to read from.
         /// \return The number of key-value pairs in the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        std::size_t db_count() const {
+        std::size_t db_count(SqliteStmt& stmt) const {
             std::size_t count = 0;
+            BusyRetry busy_retry(sqlite3_db_handle(stmt.get_stmt()));
             int err;
             try {
                 for (;;) {
-                    while ((err = m_stmt_count.step()) == SQLITE_ROW) {
-                        count = m_stmt_count.extract_column<std::size_t>(0);
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        count = stmt.extract_column<std::size_t>(0);
                     }
                     if (err == SQLITE_DONE) {
-                        m_stmt_count.reset();
+                        stmt.reset();
                         break;
                     }
                     if (err == SQLITE_BUSY) {
                         // Handle busy database, retry reading
-                        m_stmt_count.reset();
-                        sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
                         continue;
                     }
                     // Handle SQLite errors
                     std::string err_msg = "SQLite error: ";
                     err_msg += std::to_string(err);
                     err_msg += ", ";
-                    err_msg += sqlite3_errmsg(m_sqlite_db);
+                    err_msg += sqlite3_errmsg(sqlite3_db_handle(stmt.get_stmt()));
                     throw sqlite_exception(err_msg, err);
                 }
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(),
-                    {&m_stmt_count},
+                    {&stmt},
                     "Unknown error occurred while counting key-value pairs in the database.");
             }
             return count;
         }
 
         /// \brief Appends the content of the container to the database.
+        /// Pairs are written in chunks by multi-row `REPLACE INTO` statements.
         /// \tparam ContainerT Template for the container type (map or unordered_map).
-        /// \param container Container with content to
+        /// \param container Container with content to be appended to the database.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void db_append(const ContainerT<KeyT, ValueT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void db_append(const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
             try {
-                for (const auto& pair : container) {
-                    m_stmt_replace.bind_value<KeyT>(1, pair.first);
-                    m_stmt_replace.bind_value<ValueT>(2, pair.second);
-                    m_stmt_replace.execute();
-                    m_stmt_replace.reset();
-                    m_stmt_replace.clear_bindings();
+                m_cache.clear();
+                db_intern_values(container.begin(), container.size());
+                m_bulk_replace.execute(container.begin(), container.size(), bind_pair<typename ContainerT<KeyT, ValueT, ContainerArgs...>::value_type>);
+                db_cache_written_all();
+                if (m_write_back) {
+                    std::unique_lock<std::shared_mutex> locker(m_wb_mutex);
+                    for (const auto& pair : container) {
+                        m_wb_values.insert_or_assign(pair.first, pair.second);
+                    }
                 }
             } catch (...) {
                 db_handle_exception(
-                    std::current_exception(),
-                    {&m_stmt_replace},
+                    std::current_exception(), {},
                     "Unknown error occurred while appending key-value pairs to the database.");
             }
         }
 
         /// \brief Reconciles the content of the database with the container.
         /// Synchronizes the main table with the content of the container by using a temporary table.
-        /// Clears old data, inserts new data, and updates existing records in the main table.
+        /// Removes stale keys, updates the values that differ and inserts missing keys; equal rows are not rewritten.
         /// \tparam ContainerT Template for the container type (map or unordered_map).
         /// \param container Container with key-value pairs to be reconciled with the database.
+        /// \return Numbers of inserted, updated and removed rows.
         /// \throws sqlite_exception if an SQLite error occurs.
-        template<template <class...> class ContainerT>
-        void db_reconcile(const ContainerT<KeyT, ValueT>& container) {
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        ReconcileStats db_reconcile(const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::RECONCILE);
+            ReconcileStats stats;
             try {
+                m_cache.clear();
+
                 // Clear the temporary table
                 m_stmt_clear_temp.execute();
                 m_stmt_clear_temp.reset();
 
                 // Insert all new data from the container into the temporary table
-                for (const auto& pair : container) {
-                    m_stmt_insert_temp.bind_value<KeyT>(1, pair.first);
-                    m_stmt_insert_temp.bind_value<ValueT>(2, pair.second);
-                    m_stmt_insert_temp.execute();
-                    m_stmt_insert_temp.reset();
-                    m_stmt_insert_temp.clear_bindings();
-                }
-
-                // Remove old data from the main table that is not in the temporary table
-                m_stmt_purge_main.execute();
-                m_stmt_purge_main.reset();
+                db_intern_values(container.begin(), container.size());
+                m_bulk_insert_temp.execute(container.begin(), container.size(), bind_pair<typename ContainerT<KeyT, ValueT, ContainerArgs...>::value_type>);
 
-                // Insert or update records from the temporary table into the main table
-                m_stmt_merge_temp.execute();
-                m_stmt_merge_temp.reset();
-
-                // Clear the temporary table
-                m_stmt_clear_temp.execute();
-                m_stmt_clear_temp.reset();
+                stats = db_merge_temp();
 
+                db_cache_written_all();
+                if (m_write_back) {
+                    std::unique_lock<std::shared_mutex> locker(m_wb_mutex);
+                    m_wb_values = WriteBackMap(container.begin(), container.end());
+                }
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(), {
-                        &m_stmt_purge_main, &m_stmt_merge_temp,
-                        &m_stmt_clear_temp, &m_stmt_insert_temp
+                        &m_stmt_purge_main, &m_stmt_update_temp,
+                        &m_stmt_merge_temp, &m_stmt_clear_temp
                     },
                     "Unknown error occurred while reconciling data.");
             }
+            return stats;
         }
 
         /// \brief Inserts a key-value pair into the database.
@@ -465,16 +1842,25 @@ namespace sqlite_containers {
         /// \param value The value to be inserted.
         /// \throws sqlite_exception if an SQLite error occurs.
         void db_insert(const KeyT &key, const ValueT &value) {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::INSERT);
             try {
+                m_cache.erase(key);
+                if (m_dedup_values) {
+                    m_stmt_intern.bind_value<ValueT>(1, value);
+                    m_stmt_intern.execute();
+                    m_stmt_intern.reset();
+                    m_stmt_intern.clear_bindings();
+                }
                 m_stmt_replace.bind_value<KeyT>(1, key);
                 m_stmt_replace.bind_value<ValueT>(2, value);
                 m_stmt_replace.execute();
                 m_stmt_replace.reset();
                 m_stmt_replace.clear_bindings();
+                db_cache_written(key);
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(),
-                    {&m_stmt_replace},
+                    {&m_stmt_intern, &m_stmt_replace},
                     "Unknown error occurred while inserting key-value pair into the database.");
             }
         }
@@ -484,10 +1870,12 @@ namespace sqlite_containers {
         /// \throws sqlite_exception if an SQLite error occurs.
         void db_remove(const KeyT &key) {
             try {
+                m_cache.erase(key);
                 m_stmt_remove.bind_value<KeyT>(1, key);
                 m_stmt_remove.execute();
                 m_stmt_remove.reset();
                 m_stmt_remove.clear_bindings();
+                db_cache_written(key);
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(),
@@ -496,20 +1884,117 @@ namespace sqlite_containers {
             }
         }
 
+        /// \brief Applies recorded changes to the database.
+        /// Overwritten pairs are written by multi-row `REPLACE INTO` statements and erased keys are removed by
+        /// `DELETE ... WHERE key IN (...)` statements. In write-back mode only the in-memory map is changed.
+        /// \param log Changes to apply.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void db_apply_delta(const ChangeLog<KeyT, ValueT>& log) {
+            const auto& upserts = log.upserts();
+            const auto& erased = log.erased();
+            if (m_write_back) {
+                std::unique_lock<std::shared_mutex> locker(m_wb_mutex);
+                for (const auto& pair : upserts) {
+                    m_wb_values.insert_or_assign(pair.first, pair.second);
+                    m_wb_dirty.insert(pair.first);
+                }
+                for (const auto& key : erased) {
+                    m_wb_values.erase(key);
+                    m_wb_dirty.insert(key);
+                }
+                return;
+            }
+            try {
+                for (const auto& pair : upserts) {
+                    m_cache.erase(pair.first);
+                }
+                for (const auto& key : erased) {
+                    m_cache.erase(key);
+                }
+                db_intern_values(upserts.begin(), upserts.size());
+                m_bulk_replace.execute(upserts.begin(), upserts.size(), bind_pair<typename ChangeLog<KeyT, ValueT>::ValueMap::value_type>);
+                m_bulk_remove.execute(erased.begin(), erased.size(), bind_key);
+                for (const auto& pair : upserts) {
+                    db_cache_written(pair.first);
+                }
+                for (const auto& key : erased) {
+                    db_cache_written(key);
+                }
+            } catch (...) {
+                db_handle_exception(
+                    std::current_exception(), {},
+                    "Unknown error occurred while applying changes to the database.");
+            }
+        }
+
         /// \brief Clears all key-value pairs from the database.
         /// \throws sqlite_exception if an SQLite error occurs.
         void db_clear() {
             try {
+                m_cache.clear();
                 m_stmt_clear_main.execute();
                 m_stmt_clear_main.reset();
+                if (m_dedup_values) {
+                    m_stmt_clear_values.execute();
+                    m_stmt_clear_values.reset();
+                }
+                db_cache_written_all();
+                if (m_write_back) {
+                    std::unique_lock<std::shared_mutex> locker(m_wb_mutex);
+                    m_wb_values.clear();
+                    m_wb_dirty.clear();
+                }
             } catch (...) {
                 db_handle_exception(
                     std::current_exception(),
-                    {&m_stmt_clear_main},
+                    {&m_stmt_clear_main, &m_stmt_clear_values},
                     "Unknown error occurred while clearing the database tables.");
             }
         }
 
+        /// \brief Removes the pairs of a key range from the database.
+        /// In write-back mode the buffered changes are written back first, and the removed keys are erased
+        /// from the in-memory map.
+        /// \param from Smallest key of the range.
+        /// \param to Key past the end of the range.
+        /// \return Number of removed pairs.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        std::size_t db_range_remove(const KeyT& from, const KeyT& to) {
+            try {
+                std::vector<std::pair<KeyT, ValueT>> removed;
+                if (m_write_back) {
+                    db_flush_buffered();
+                    db_load_range(m_stmt_range, [&from, &to](SqliteStmt& stmt) {
+                        stmt.bind_value<KeyT>(1, from);
+                        stmt.bind_value<KeyT>(2, to);
+                        stmt.bind_value<int64_t>(3, to_sql_limit(0));
+                    }, removed);
+                }
+                m_cache.clear();
+                m_stmt_range_remove.bind_value<KeyT>(1, from);
+                m_stmt_range_remove.bind_value<KeyT>(2, to);
+                m_stmt_range_remove.execute();
+                m_stmt_range_remove.reset();
+                m_stmt_range_remove.clear_bindings();
+                const std::size_t count = static_cast<std::size_t>(sqlite3_changes(m_sqlite_db));
+                db_purge_values();
+                db_cache_written_all();
+                if (m_write_back) {
+                    std::unique_lock<std::shared_mutex> locker(m_wb_mutex);
+                    for (const auto& pair : removed) {
+                        m_wb_values.erase(pair.first);
+                    }
+                }
+                return count;
+            } catch (...) {
+                db_handle_exception(
+                    std::current_exception(),
+                    {&m_stmt_range, &m_stmt_range_remove},
+                    "Unknown error occurred while removing a key range.");
+            }
+            return 0;
+        }
+
     }; // KeyValueDB
 
 }; // namespace sqlite_containers
@@ -0,0 +1,200 @@
+#pragma once
+
+/// \file ShardedKeyDB.hpp
+/// \brief Declaration of the ShardedKeyDB class for keys spread across several database files.
+
+#include "KeyDB.hpp"
+#include "parts/ShardedDB.hpp"
+
+namespace sqlite_containers {
+
+    /// \class ShardedKeyDB
+    /// \brief Key container that hashes every key to one of several `KeyDB` shards.
+    /// \tparam KeyT Type of the keys.
+    /// \tparam HashT Hash function that selects the shard of a key.
+    /// \details Each shard has its own database file (see ShardedDB::shard_path()) and connection. Point
+    /// operations go directly to the shard of the key; bulk operations are split by shard and run in parallel.
+    template<class KeyT, class HashT = ShardHash<KeyT>>
+    class ShardedKeyDB final : public ShardedDB<KeyT, KeyDB<KeyT>, HashT> {
+    public:
+        using ShardedDB<KeyT, KeyDB<KeyT>, HashT>::ShardedDB;
+
+        /// \brief Loads all keys of all shards into the container.
+        /// The shards are read in parallel.
+        /// \tparam ContainerT Container type (vector, deque, list, set or unordered_set).
+        /// \param container Container to be populated with data from the database.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void load(ContainerT<KeyT, ContainerArgs...>& container) {
+            auto parts = this->make_parts(container);
+            this->for_each_shard([&parts](KeyDB<KeyT>& shard, std::size_t index) {
+                shard.load(parts[index]);
+            });
+            merge(parts, container);
+        }
+
+        /// \brief Loads all keys of all shards into the container, reading each shard in a transaction.
+        /// \tparam ContainerT Container type (vector, deque, list, set or unordered_set).
+        /// \param container Container to be populated with data from the database.
+        /// \param mode Transaction mode.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void load(ContainerT<KeyT, ContainerArgs...>& container, const TransactionMode& mode) {
+            auto parts = this->make_parts(container);
+            this->for_each_shard([&parts, &mode](KeyDB<KeyT>& shard, std::size_t index) {
+                shard.load(parts[index], mode);
+            });
+            merge(parts, container);
+        }
+
+        /// \brief Appends the keys of the container to the shards in parallel.
+        /// \tparam ContainerT Container type (vector, deque, list, set or unordered_set).
+        /// \param container Container with keys to be appended.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void append(const ContainerT<KeyT, ContainerArgs...>& container) {
+            auto parts = this->split(container, get_key);
+            this->for_each_shard([&parts](KeyDB<KeyT>& shard, std::size_t index) {
+                if (!parts[index].empty()) shard.append(parts[index]);
+            });
+        }
+
+        /// \brief Appends the keys of the container to the shards in parallel, one transaction per shard.
+        /// \tparam ContainerT Container type (vector, deque, list, set or unordered_set).
+        /// \param container Container with keys to be appended.
+        /// \param mode Transaction mode.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void append(const ContainerT<KeyT, ContainerArgs...>& container, const TransactionMode& mode) {
+            auto parts = this->split(container, get_key);
+            this->for_each_shard([&parts, &mode](KeyDB<KeyT>& shard, std::size_t index) {
+                if (!parts[index].empty()) shard.append(parts[index], mode);
+            });
+        }
+
+        /// \brief Reconciles all shards with the container in parallel.
+        /// \tparam ContainerT Container type (vector, deque, list, set or unordered_set).
+        /// \param container Container to be reconciled with the database.
+        /// \return Numbers of inserted and removed keys summed over the shards.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        ReconcileStats reconcile(const ContainerT<KeyT, ContainerArgs...>& container) {
+            auto parts = this->split(container, get_key);
+            std::vector<ReconcileStats> stats(parts.size());
+            this->for_each_shard([&parts, &stats](KeyDB<KeyT>& shard, std::size_t index) {
+                stats[index] = shard.reconcile(parts[index]);
+            });
+            return this->sum_stats(stats);
+        }
+
+        /// \brief Reconciles all shards with the container in parallel, one transaction per shard.
+        /// \tparam ContainerT Container type (vector, deque, list, set or unordered_set).
+        /// \param container Container to be reconciled with the database.
+        /// \param mode Transaction mode.
+        /// \return Numbers of inserted and removed keys summed over the shards.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        ReconcileStats reconcile(const ContainerT<KeyT, ContainerArgs...>& container, const TransactionMode& mode) {
+            auto parts = this->split(container, get_key);
+            std::vector<ReconcileStats> stats(parts.size());
+            this->for_each_shard([&parts, &stats, &mode](KeyDB<KeyT>& shard, std::size_t index) {
+                stats[index] = shard.reconcile(parts[index], mode);
+            });
+            return this->sum_stats(stats);
+        }
+
+        /// \brief Inserts a key into its shard.
+        /// \param key The key to be inserted.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void insert(const KeyT &key) {
+            this->shard_of(key).insert(key);
+        }
+
+        /// \brief Checks whether a key exists in its shard.
+        /// \param key The key to search for.
+        /// \return True if the key was found, false otherwise.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        bool find(const KeyT &key) {
+            return this->shard_of(key).find(key);
+        }
+
+        /// \brief Finds several keys, querying the shards in parallel.
+        /// \tparam KeyContainerT Container type of the keys to search for (e.g., std::vector or std::set).
+        /// \tparam ContainerT Container type receiving the found keys (vector, deque, list, set or unordered_set).
+        /// \param keys The keys to search for.
+        /// \param container Container receiving the keys that were found.
+        /// \return The number of keys found.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class KeyContainerT, template <class...> class ContainerT, class... KeyArgs, class... ContainerArgs>
+        std::size_t find_many(const KeyContainerT<KeyT, KeyArgs...>& keys, ContainerT<KeyT, ContainerArgs...>& container) {
+            std::vector<std::vector<KeyT>> key_parts(this->m_shards.size());
+            for (const auto& key : keys) {
+                key_parts[this->shard_index(key)].push_back(key);
+            }
+            auto parts = this->make_parts(container);
+            std::vector<std::size_t> found(this->m_shards.size(), 0);
+            this->for_each_shard([&key_parts, &parts, &found](KeyDB<KeyT>& shard, std::size_t index) {
+                if (!key_parts[index].empty()) found[index] = shard.find_many(key_parts[index], parts[index]);
+            });
+            merge(parts, container);
+            std::size_t total = 0;
+            for (const auto& item : found) {
+                total += item;
+            }
+            return total;
+        }
+
+        /// \brief Returns the number of keys in all shards.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        std::size_t count() const {
+            std::size_t total = 0;
+            for (const auto& shard : this->m_shards) {
+                total += shard->count();
+            }
+            return total;
+        }
+
+        /// \brief Checks if all shards are empty.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        bool empty() const {
+            for (const auto& shard : this->m_shards) {
+                if (!shard->empty()) return false;
+            }
+            return true;
+        }
+
+        /// \brief Removes a key from its shard.
+        /// \param key The key to be removed.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void remove(const KeyT &key) {
+            this->shard_of(key).remove(key);
+        }
+
+        /// \brief Clears all shards.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void clear() {
+            this->for_each_shard([](KeyDB<KeyT>& shard, std::size_t) {
+                shard.clear();
+            });
+        }
+
+    private:
+
+        /// \brief Returns the key of a container element.
+        static const KeyT& get_key(const KeyT& key) {
+            return key;
+        }
+
+        /// \brief Moves the keys loaded from the shards into the target container.
+        template<class ContainerT>
+        static void merge(std::vector<ContainerT>& parts, ContainerT& container) {
+            for (auto& part : parts) {
+                for (auto& key : part) {
+                    container.insert(container.end(), key);
+                }
+                part.clear();
+            }
+        }
+    }; // ShardedKeyDB
+
+}; // namespace sqlite_containers
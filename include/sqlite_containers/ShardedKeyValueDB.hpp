@@ -0,0 +1,252 @@
+#pragma once
+
+/// \file ShardedKeyValueDB.hpp
+/// \brief Declaration of the ShardedKeyValueDB class for key-value pairs spread across several database files.
+
+#include "KeyValueDB.hpp"
+#include "parts/ShardedDB.hpp"
+
+namespace sqlite_containers {
+
+    /// \class ShardedKeyValueDB
+    /// \brief Key-value container that hashes every key to one of several `KeyValueDB` shards.
+    /// \tparam KeyT Type of the keys.
+    /// \tparam ValueT Type of the values.
+    /// \tparam HashT Hash function that selects the shard of a key.
+    /// \details Each shard has its own database file (see ShardedDB::shard_path()) and connection, so writes to
+    /// different shards do not wait for each other. Point operations go directly to the shard of the key; bulk
+    /// operations are split by shard and run in parallel, and their results are merged.
+    template<class KeyT, class ValueT, class HashT = ShardHash<KeyT>>
+    class ShardedKeyValueDB final : public ShardedDB<KeyT, KeyValueDB<KeyT, ValueT>, HashT> {
+    public:
+        using ShardedDB<KeyT, KeyValueDB<KeyT, ValueT>, HashT>::ShardedDB;
+
+        /// \brief Loads all key-value pairs of all shards into the container.
+        /// The shards are read in parallel.
+        /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
+        /// \param container Container to be populated with data from the database.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void load(ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            auto parts = this->make_parts(container);
+            this->for_each_shard([&parts](KeyValueDB<KeyT, ValueT>& shard, std::size_t index) {
+                shard.load(parts[index]);
+            });
+            merge(parts, container);
+        }
+
+        /// \brief Loads all key-value pairs of all shards into the container, reading each shard in a transaction.
+        /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
+        /// \param container Container to be populated with data from the database.
+        /// \param mode Transaction mode.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void load(ContainerT<KeyT, ValueT, ContainerArgs...>& container, const TransactionMode& mode) {
+            auto parts = this->make_parts(container);
+            this->for_each_shard([&parts, &mode](KeyValueDB<KeyT, ValueT>& shard, std::size_t index) {
+                shard.load(parts[index], mode);
+            });
+            merge(parts, container);
+        }
+
+        /// \brief Retrieves all key-value pairs of all shards.
+        /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
+        /// \return Container with all key-value pairs.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT = std::map>
+        ContainerT<KeyT, ValueT> retrieve_all() {
+            ContainerT<KeyT, ValueT> container;
+            load(container);
+            return container;
+        }
+
+        /// \brief Retrieves all key-value pairs of all shards into a container of the given type, which may use a custom allocator.
+        /// \tparam ContainerT Complete container type, e.g. `std::pmr::map<KeyT, ValueT>`.
+        /// \param allocator Allocator of the container, e.g. one drawing from a `std::pmr::monotonic_buffer_resource`.
+        /// \return A container with all key-value pairs of all shards.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<class ContainerT>
+        ContainerT retrieve_all(const typename ContainerT::allocator_type& allocator = typename ContainerT::allocator_type()) {
+            ContainerT container(allocator);
+            load(container);
+            return container;
+        }
+
+        /// \brief Appends the content of the container to the shards in parallel.
+        /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
+        /// \param container Container with content to be appended.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void append(const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            auto parts = this->split(container, get_key<typename ContainerT<KeyT, ValueT, ContainerArgs...>::value_type>);
+            this->for_each_shard([&parts](KeyValueDB<KeyT, ValueT>& shard, std::size_t index) {
+                if (!parts[index].empty()) shard.append(parts[index]);
+            });
+        }
+
+        /// \brief Appends the content of the container to the shards in parallel, one transaction per shard.
+        /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
+        /// \param container Container with content to be appended.
+        /// \param mode Transaction mode.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        void append(const ContainerT<KeyT, ValueT, ContainerArgs...>& container, const TransactionMode& mode) {
+            auto parts = this->split(container, get_key<typename ContainerT<KeyT, ValueT, ContainerArgs...>::value_type>);
+            this->for_each_shard([&parts, &mode](KeyValueDB<KeyT, ValueT>& shard, std::size_t index) {
+                if (!parts[index].empty()) shard.append(parts[index], mode);
+            });
+        }
+
+        /// \brief Reconciles all shards with the container in parallel.
+        /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
+        /// \param container Container to be reconciled with the database.
+        /// \return Numbers of inserted, updated and removed rows summed over the shards.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        ReconcileStats reconcile(const ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            auto parts = this->split(container, get_key<typename ContainerT<KeyT, ValueT, ContainerArgs...>::value_type>);
+            std::vector<ReconcileStats> stats(parts.size());
+            this->for_each_shard([&parts, &stats](KeyValueDB<KeyT, ValueT>& shard, std::size_t index) {
+                stats[index] = shard.reconcile(parts[index]);
+            });
+            return this->sum_stats(stats);
+        }
+
+        /// \brief Reconciles all shards with the container in parallel, one transaction per shard.
+        /// \tparam ContainerT Container type (e.g., std::map or std::unordered_map).
+        /// \param container Container to be reconciled with the database.
+        /// \param mode Transaction mode.
+        /// \return Numbers of inserted, updated and removed rows summed over the shards.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class ContainerT, class... ContainerArgs>
+        ReconcileStats reconcile(const ContainerT<KeyT, ValueT, ContainerArgs...>& container, const TransactionMode& mode) {
+            auto parts = this->split(container, get_key<typename ContainerT<KeyT, ValueT, ContainerArgs...>::value_type>);
+            std::vector<ReconcileStats> stats(parts.size());
+            this->for_each_shard([&parts, &stats, &mode](KeyValueDB<KeyT, ValueT>& shard, std::size_t index) {
+                stats[index] = shard.reconcile(parts[index], mode);
+            });
+            return this->sum_stats(stats);
+        }
+
+        /// \brief Applies recorded changes to the shards in parallel, one transaction per shard.
+        /// \param log Changes to apply; the log is not cleared.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void apply_delta(const ChangeLog<KeyT, ValueT>& log) {
+            std::vector<ChangeLog<KeyT, ValueT>> parts(this->m_shards.size());
+            for (const auto& pair : log.upserts()) {
+                parts[this->shard_index(pair.first)].insert(pair.first, pair.second);
+            }
+            for (const auto& key : log.erased()) {
+                parts[this->shard_index(key)].erase(key);
+            }
+            this->for_each_shard([&parts](KeyValueDB<KeyT, ValueT>& shard, std::size_t index) {
+                shard.apply_delta(parts[index]);
+            });
+        }
+
+        /// \brief Inserts a key-value pair into the shard of the key.
+        /// \param key The key to be inserted.
+        /// \param value The value to be inserted.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void insert(const KeyT &key, const ValueT &value) {
+            this->shard_of(key).insert(key, value);
+        }
+
+        /// \brief Inserts a key-value pair into the shard of the key.
+        /// \param pair The key-value pair to be inserted.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void insert(const std::pair<KeyT, ValueT> &pair) {
+            insert(pair.first, pair.second);
+        }
+
+        /// \brief Finds a value by key in the shard of the key.
+        /// \param key The key to search for.
+        /// \param value The value found.
+        /// \return True if the key was found, false otherwise.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        bool find(const KeyT &key, ValueT &value) {
+            return this->shard_of(key).find(key, value);
+        }
+
+        /// \brief Finds the values of several keys, querying the shards in parallel.
+        /// \tparam KeyContainerT Container type of the keys (e.g., std::vector or std::set).
+        /// \tparam ContainerT Container type receiving the found pairs (e.g., std::map or std::unordered_map).
+        /// \param keys Keys to search for.
+        /// \param container Container receiving the found key-value pairs.
+        /// \return Number of keys found.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<template <class...> class KeyContainerT, template <class...> class ContainerT, class... KeyArgs, class... ContainerArgs>
+        std::size_t find_many(const KeyContainerT<KeyT, KeyArgs...>& keys, ContainerT<KeyT, ValueT, ContainerArgs...>& container) {
+            std::vector<std::vector<KeyT>> key_parts(this->m_shards.size());
+            for (const auto& key : keys) {
+                key_parts[this->shard_index(key)].push_back(key);
+            }
+            auto parts = this->make_parts(container);
+            std::vector<std::size_t> found(this->m_shards.size(), 0);
+            this->for_each_shard([&key_parts, &parts, &found](KeyValueDB<KeyT, ValueT>& shard, std::size_t index) {
+                if (!key_parts[index].empty()) found[index] = shard.find_many(key_parts[index], parts[index]);
+            });
+            merge(parts, container);
+            std::size_t total = 0;
+            for (const auto& item : found) {
+                total += item;
+            }
+            return total;
+        }
+
+        /// \brief Returns the number of pairs in all shards.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        std::size_t count() const {
+            std::size_t total = 0;
+            for (const auto& shard : this->m_shards) {
+                total += shard->count();
+            }
+            return total;
+        }
+
+        /// \brief Checks if all shards are empty.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        bool empty() const {
+            for (const auto& shard : this->m_shards) {
+                if (!shard->empty()) return false;
+            }
+            return true;
+        }
+
+        /// \brief Removes a key from the shard of the key.
+        /// \param key The key to be removed.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void remove(const KeyT &key) {
+            this->shard_of(key).remove(key);
+        }
+
+        /// \brief Clears all shards.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        void clear() {
+            this->for_each_shard([](KeyValueDB<KeyT, ValueT>& shard, std::size_t) {
+                shard.clear();
+            });
+        }
+
+    private:
+
+        /// \brief Returns the key of a container element.
+        template<class PairT>
+        static const KeyT& get_key(const PairT& pair) {
+            return pair.first;
+        }
+
+        /// \brief Moves the pairs loaded from the shards into the target container.
+        /// The pairs are inserted one by one, so the target keeps its allocator.
+        template<class ContainerT>
+        static void merge(std::vector<ContainerT>& parts, ContainerT& container) {
+            for (auto& part : parts) {
+                for (auto& pair : part) {
+                    container.emplace(pair.first, std::move(pair.second));
+                }
+                part.clear();
+            }
+        }
+    }; // ShardedKeyValueDB
+
+}; // namespace sqlite_containers
@@ -0,0 +1,359 @@
+#pragma once
+
+/// \file AsyncRunner.hpp
+/// \brief Declaration of the AsyncRunner class and the AsyncResult futures of the `async_*` container calls.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define SQLITE_CONTAINERS_HAS_COROUTINES 1
+#endif
+
+namespace sqlite_containers {
+
+    /// \brief Executor running the `async_*` calls of a container instead of its own I/O thread.
+    /// It receives a job and must run it once, on any thread and without blocking the caller for its duration.
+    using Executor = std::function<void(std::function<void()>)>;
+
+    /// \class AsyncNotifier
+    /// \brief Completion flag of an asynchronous call, holding the continuation of a coroutine awaiting it.
+    class AsyncNotifier {
+    public:
+
+        /// \brief Stores the continuation to run once the call completes.
+        /// \param continuation Function resuming the awaiting coroutine.
+        /// \return True if the continuation was stored, false if the call has already completed.
+        bool set_continuation(std::function<void()> continuation) {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            if (m_done) return false;
+            m_continuation = std::move(continuation);
+            return true;
+        }
+
+        /// \brief Marks the call as completed and runs the stored continuation, if any.
+        void notify() noexcept {
+            std::function<void()> continuation;
+            {
+                std::lock_guard<std::mutex> locker(m_mutex);
+                m_done = true;
+                continuation.swap(m_continuation);
+            }
+            if (continuation) continuation();
+        }
+
+    private:
+        std::mutex              m_mutex;            ///< Protects the flag and the continuation.
+        bool                    m_done = false;     ///< True once the result is available.
+        std::function<void()>   m_continuation;     ///< Continuation of the awaiting coroutine.
+    }; // AsyncNotifier
+
+    /// \class AsyncResult
+    /// \brief Future of an `async_*` call of a container.
+    /// Wraps a `std::future` and, when the compiler supports C++20 coroutines, can be awaited with `co_await`.
+    /// An awaiting coroutine is resumed on the thread that completed the call, i.e. the I/O thread of the
+    /// container or a thread of its executor; it must not block there on another call of the same container.
+    /// \tparam T Type of the result.
+    template<class T>
+    class AsyncResult {
+    public:
+
+        /// \brief Default constructor. Creates a result without a shared state.
+        AsyncResult() = default;
+
+        /// \brief Constructor.
+        /// \param future Future receiving the result of the call.
+        /// \param notifier Completion flag of the call.
+        AsyncResult(std::future<T> future, std::shared_ptr<AsyncNotifier> notifier)
+            : m_future(std::move(future)), m_notifier(std::move(notifier)) {}
+
+        /// \brief Checks whether the result refers to a call.
+        bool valid() const noexcept {
+            return m_future.valid();
+        }
+
+        /// \brief Checks whether the call has completed.
+        bool ready() const {
+            return m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+
+        /// \brief Blocks until the call has completed.
+        void wait() const {
+            m_future.wait();
+        }
+
+        /// \brief Blocks until the call has completed or the timeout has elapsed.
+        /// \param timeout Maximum time to wait.
+        /// \return Status of the call.
+        template<class Rep, class Period>
+        std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+            return m_future.wait_for(timeout);
+        }
+
+        /// \brief Waits for the call and returns its result.
+        /// \return The result of the call.
+        /// \throws sqlite_exception or the exception thrown by the call.
+        T get() {
+            return m_future.get();
+        }
+
+        /// \brief Releases the underlying future, e.g. to pass it to code expecting a `std::future`.
+        /// \return The future of the call; the result is left without a shared state.
+        std::future<T> future() {
+            m_notifier.reset();
+            return std::move(m_future);
+        }
+
+#       ifdef SQLITE_CONTAINERS_HAS_COROUTINES
+        bool await_ready() const {
+            return ready();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return m_notifier->set_continuation([handle] {
+                handle.resume();
+            });
+        }
+
+        T await_resume() {
+            return m_future.get();
+        }
+#       endif
+
+    private:
+        std::future<T>                  m_future;   ///< Future receiving the result.
+        std::shared_ptr<AsyncNotifier>  m_notifier; ///< Completion flag resuming awaiting coroutines.
+    }; // AsyncResult
+
+    /// \class AsyncCall
+    /// \brief Operation of an `async_*` call together with its result.
+    /// The operation may be run several times, e.g. again on its own after its shared transaction was rolled back,
+    /// and the result of the last run is handed to the future by resolve().
+    /// \tparam T Type of the result.
+    template<class T>
+    class AsyncCall {
+    public:
+
+        /// \brief Constructor.
+        /// \param operation The operation to run; it must own copies of its arguments.
+        template<typename Func>
+        explicit AsyncCall(Func&& operation)
+            : m_operation(std::forward<Func>(operation)), m_notifier(std::make_shared<AsyncNotifier>()) {}
+
+        /// \brief Returns the future of the call.
+        AsyncResult<T> result() {
+            return AsyncResult<T>(m_promise.get_future(), m_notifier);
+        }
+
+        /// \brief Runs the operation and keeps its result or exception.
+        /// \return True if the operation succeeded.
+        bool run() noexcept {
+            try {
+                if constexpr (std::is_void<T>::value) {
+                    m_operation();
+                    m_value.emplace();
+                } else {
+                    m_value.emplace(m_operation());
+                }
+                m_error = nullptr;
+                return true;
+            } catch (...) {
+                m_value.reset();
+                m_error = std::current_exception();
+                return false;
+            }
+        }
+
+        /// \brief Records an error without running the operation.
+        /// \param error The exception handed to the future.
+        void fail(std::exception_ptr error) noexcept {
+            m_value.reset();
+            m_error = std::move(error);
+        }
+
+        /// \brief Hands the kept result to the future and resumes an awaiting coroutine.
+        void resolve() noexcept {
+            try {
+                if (m_error) {
+                    m_promise.set_exception(m_error);
+                } else if constexpr (std::is_void<T>::value) {
+                    m_promise.set_value();
+                } else {
+                    m_promise.set_value(std::move(*m_value));
+                }
+            } catch (...) {
+                m_promise.set_exception(std::current_exception());
+            }
+            m_notifier->notify();
+        }
+
+    private:
+        using StoredT = typename std::conditional<std::is_void<T>::value, bool, T>::type;
+
+        std::function<T()>              m_operation;    ///< The operation.
+        std::promise<T>                 m_promise;      ///< Promise of the future.
+        std::shared_ptr<AsyncNotifier>  m_notifier;     ///< Completion flag shared with the future.
+        std::optional<StoredT>          m_value;        ///< Result of the last run.
+        std::exception_ptr              m_error;        ///< Exception of the last run.
+    }; // AsyncCall
+
+    /// \brief Type-erased entry of the queue of an AsyncRunner.
+    struct AsyncTask {
+        std::function<bool()>                   run;        ///< Runs the operation and keeps its result.
+        std::function<void(std::exception_ptr)> fail;       ///< Records an error without running the operation.
+        std::function<void()>                   resolve;    ///< Hands the kept result to the future.
+        bool                                    locked = false; ///< Whether the operation runs with the connection lock held.
+    };
+
+    /// \class AsyncRunner
+    /// \brief FIFO queue of `async_*` calls, drained by a dedicated I/O thread or by an executor.
+    /// At most one drain runs at a time, so calls complete in the order they were submitted. A drain hands the
+    /// queued calls to the handler in batches, which lets the container pipeline consecutive writes into one
+    /// transaction. The I/O thread is started by the first call and runs until stop().
+    class AsyncRunner {
+    public:
+        using Handler = std::function<void(std::vector<AsyncTask>&)>; ///< Runs and resolves a batch of calls; must not throw.
+
+        /// \brief Constructor.
+        /// \param handler Function running a batch of calls.
+        explicit AsyncRunner(Handler handler) : m_handler(std::move(handler)) {}
+
+        AsyncRunner(const AsyncRunner&) = delete;
+        AsyncRunner& operator=(const AsyncRunner&) = delete;
+
+        /// \brief Destructor. Runs the queued calls and joins the I/O thread.
+        ~AsyncRunner() {
+            stop();
+        }
+
+        /// \brief Sets the maximum number of calls handed to the handler at once.
+        /// \param batch_size Number of calls; 0 is treated as 1.
+        void set_batch_size(const std::size_t& batch_size) {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            m_batch_size = std::max<std::size_t>(batch_size, 1);
+        }
+
+        /// \brief Sets the executor draining the queue, or the I/O thread if the executor is empty.
+        /// Waits for the queued calls and stops the I/O thread first.
+        /// \param executor The executor.
+        void set_executor(Executor executor) {
+            stop();
+            std::lock_guard<std::mutex> locker(m_mutex);
+            m_executor = std::move(executor);
+        }
+
+        /// \brief Queues a call and schedules a drain if none is running.
+        /// If the executor throws, the queue is drained on the calling thread.
+        /// \param task The call.
+        void submit(AsyncTask task) {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            m_tasks.push_back(std::move(task));
+            if (m_draining) return;
+            m_draining = true;
+            if (m_executor) {
+                Executor executor = m_executor;
+                locker.unlock();
+                try {
+                    executor([this] {
+                        drain();
+                    });
+                } catch (...) {
+                    drain();
+                }
+                return;
+            }
+            if (!m_thread.joinable()) {
+                m_stop = false;
+                m_thread = std::thread([this] {
+                    run();
+                });
+            }
+            locker.unlock();
+            m_cv.notify_one();
+        }
+
+        /// \brief Blocks until every queued call has completed.
+        /// Must not be called from a call of the same runner.
+        void wait_idle() {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            m_idle_cv.wait(locker, [this] {
+                return !m_draining;
+            });
+        }
+
+        /// \brief Waits for the queued calls and joins the I/O thread.
+        /// Must not be called from a call of the same runner.
+        void stop() {
+            wait_idle();
+            {
+                std::lock_guard<std::mutex> locker(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            if (m_thread.joinable()) m_thread.join();
+        }
+
+    private:
+        Handler                 m_handler;              ///< Runs a batch of calls.
+        Executor                m_executor;             ///< Executor draining the queue, or empty for the I/O thread.
+        std::deque<AsyncTask>   m_tasks;                ///< Queued calls.
+        std::mutex              m_mutex;                ///< Protects the queue and the state of the drain.
+        std::condition_variable m_cv;                   ///< Wakes the I/O thread.
+        std::condition_variable m_idle_cv;              ///< Signals that the queue has been drained.
+        std::thread             m_thread;               ///< I/O thread, started by the first call.
+        std::size_t             m_batch_size = 64;      ///< Maximum number of calls per batch.
+        bool                    m_draining = false;     ///< True while a drain is scheduled or running.
+        bool                    m_stop = false;         ///< True when the I/O thread must exit.
+
+        /// \brief I/O thread loop.
+        void run() {
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> locker(m_mutex);
+                    m_cv.wait(locker, [this] {
+                        return m_stop || m_draining;
+                    });
+                    if (!m_draining) return;
+                }
+                drain();
+            }
+        }
+
+        /// \brief Hands the queued calls to the handler until the queue is empty.
+        void drain() noexcept {
+            std::vector<AsyncTask> batch;
+            for (;;) {
+                std::unique_lock<std::mutex> locker(m_mutex);
+                if (m_tasks.empty()) {
+                    m_draining = false;
+                    locker.unlock();
+                    m_idle_cv.notify_all();
+                    return;
+                }
+                const std::size_t batch_size = std::min(m_tasks.size(), m_batch_size);
+                batch.clear();
+                batch.reserve(batch_size);
+                for (std::size_t i = 0; i < batch_size; ++i) {
+                    batch.push_back(std::move(m_tasks.front()));
+                    m_tasks.pop_front();
+                }
+                locker.unlock();
+                m_handler(batch);
+            }
+        }
+    }; // AsyncRunner
+
+}; // namespace sqlite_containers
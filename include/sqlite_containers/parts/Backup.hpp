@@ -0,0 +1,119 @@
+#pragma once
+
+/// \file Backup.hpp
+/// \brief Declaration of the BackupSession class, an online copy of a database through `sqlite3_backup`.
+
+#include "Utils.hpp"
+#include <functional>
+#include <string>
+
+namespace sqlite_containers {
+
+    /// \brief Settings of an online backup.
+    struct BackupOptions {
+        using ProgressFunc = std::function<bool(int remaining, int total)>; ///< Called after each step with the pages left and the pages in total; returns false to cancel.
+
+        int             pages_per_step = 256;   ///< Pages copied per step; a negative value copies everything in one step.
+        int             step_pause_ms = 0;      ///< Pause in milliseconds between two steps, leaving the connection to other callers.
+        ProgressFunc    progress;               ///< Progress callback, may be empty.
+    };
+
+    /// \brief Opens a connection to the file at the other end of a backup.
+    /// \param path Path to the database file.
+    /// \param read_only Whether the file is only read (restore) or created and written (backup).
+    /// \return The open connection.
+    /// \throws sqlite_exception if the file cannot be opened.
+    inline sqlite3* open_backup_file(const std::string &path, const bool &read_only) {
+        const int flags = (read_only ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)) | SQLITE_OPEN_FULLMUTEX;
+        sqlite3* sqlite_db = nullptr;
+        const int err = sqlite3_open_v2(path.c_str(), &sqlite_db, flags, nullptr);
+        if (err != SQLITE_OK) {
+            std::string error_message = "Cannot open backup database: ";
+            error_message += sqlite3_errmsg(sqlite_db);
+            error_message += " (Error code: ";
+            error_message += std::to_string(err);
+            error_message += ")";
+            sqlite3_close_v2(sqlite_db);
+            throw sqlite_exception(error_message, err);
+        }
+        return sqlite_db;
+    }
+
+    /// \class BackupSession
+    /// \brief Copies the pages of the main database of one connection into another, a few pages per step.
+    /// \details The destination is written in one transaction that is committed when the last page is copied,
+    /// so a session destroyed before it is done leaves the destination unchanged. Writes made through the source
+    /// connection between steps are carried over; writes made through other connections restart the copy.
+    class BackupSession {
+    public:
+
+        /// \brief Starts a backup.
+        /// \param dest_db Connection receiving the pages.
+        /// \param source_db Connection whose main database is copied.
+        /// \throws sqlite_exception if the backup cannot be started, e.g. while the destination is in use.
+        BackupSession(sqlite3 *dest_db, sqlite3 *source_db) :
+                m_dest_db(dest_db), m_busy_retry(source_db) {
+            m_backup = sqlite3_backup_init(dest_db, "main", source_db, "main");
+            if (!m_backup) {
+                const int err = sqlite3_errcode(dest_db);
+                throw sqlite_exception(std::string("Failed to start backup: ") + sqlite3_errmsg(dest_db) + ". Error code: " + std::to_string(err), err);
+            }
+        }
+
+        BackupSession(const BackupSession&) = delete;
+        BackupSession& operator=(const BackupSession&) = delete;
+
+        /// \brief Abandons an unfinished backup.
+        ~BackupSession() {
+            if (m_backup) sqlite3_backup_finish(m_backup);
+        }
+
+        /// \brief Copies up to `pages` pages.
+        /// Waits with the busy retry policy of the source when one of the databases is locked.
+        /// \param pages Number of pages to copy; a negative value copies all remaining pages.
+        /// \return True once all pages are copied and the backup is finished.
+        /// \throws sqlite_exception if the copy fails.
+        bool step(const int &pages) {
+            const int err = sqlite3_backup_step(m_backup, pages);
+            if (err == SQLITE_DONE) {
+                finish();
+                return true;
+            }
+            if (err == SQLITE_OK) return false;
+            if (err == SQLITE_BUSY || err == SQLITE_LOCKED) {
+                m_busy_retry.wait();
+                return false;
+            }
+            sqlite3_backup_finish(m_backup);
+            m_backup = nullptr;
+            throw sqlite_exception(std::string("Backup step failed: ") + sqlite3_errstr(err) + ". Error code: " + std::to_string(err), err);
+        }
+
+        /// \brief Returns the number of pages left to copy, as of the last step.
+        int remaining() const {
+            return m_backup ? sqlite3_backup_remaining(m_backup) : 0;
+        }
+
+        /// \brief Returns the number of pages of the source database, as of the last step.
+        int pagecount() const {
+            return m_backup ? sqlite3_backup_pagecount(m_backup) : m_pagecount;
+        }
+
+    private:
+        sqlite3*        m_dest_db = nullptr;    ///< Connection receiving the pages.
+        sqlite3_backup* m_backup = nullptr;     ///< Backup handle, null once finished.
+        BusyRetry       m_busy_retry;           ///< Waits while one of the databases is locked.
+        int             m_pagecount = 0;        ///< Pages of the source when the backup finished.
+
+        /// \brief Releases the backup handle and reports the error of the backup, if any.
+        void finish() {
+            m_pagecount = sqlite3_backup_pagecount(m_backup);
+            const int err = sqlite3_backup_finish(m_backup);
+            m_backup = nullptr;
+            if (err != SQLITE_OK) {
+                throw sqlite_exception(std::string("Failed to finish backup: ") + sqlite3_errmsg(m_dest_db) + ". Error code: " + std::to_string(err), err);
+            }
+        }
+    }; // BackupSession
+
+}; // namespace sqlite_containers
@@ -6,10 +6,23 @@
 #include "Config.hpp"
 #include "Utils.hpp"
 #include "SqliteStmt.hpp"
+#include "Database.hpp"
+#include "KeyCodec.hpp"
+#include "ValueStore.hpp"
+#include "ChunkedStmt.hpp"
+#include "Cursor.hpp"
+#include "BlobStream.hpp"
+#include "ReaderPool.hpp"
+#include "Stats.hpp"
+#include "Backup.hpp"
+#include "AsyncRunner.hpp"
 #include <filesystem>
+#include <algorithm>
 #include <future>
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
+#include <functional>
 
 #if SQLITE_THREADSAFE != 1
 #error "The project must be built for sqlite multithreading! Set the SQLITE_THREADSAFE=1"
@@ -23,8 +36,12 @@ namespace sqlite_containers {
     class BaseDB {
     public:
 
-        /// \brief Default constructor.
-        BaseDB() = default;
+        /// \brief Default constructor. The container opens its own connection.
+        BaseDB() : m_sqlite_mutex(m_own_mutex) {}
+
+        /// \brief Constructor for a container attached to a shared connection.
+        /// \param database The database whose connection and lock the container uses; it must outlive the container.
+        explicit BaseDB(Database& database) : m_database(&database), m_sqlite_mutex(database.m_sqlite_mutex) {}
 
         /// \brief Destructor.
         /// Disconnects from the database if connected.
@@ -51,35 +68,58 @@ namespace sqlite_containers {
         /// Initializes a connection to the database by creating necessary directories, opening the database, creating tables, and setting up database parameters.
         /// \throws sqlite_exception if connection fails.
         void connect() {
-            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            // The background writer needs the connection mutex, so it is stopped before reconnecting.
+            if (m_config_update) {
+                m_async_calls.wait_idle();
+                db_stop_async();
+            }
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            db_wait_backups(locker);
             if (!m_sqlite_db && !m_config_update) {
                 throw sqlite_exception("Database connection already exists and no configuration update required.");
             }
             if (m_sqlite_db) {
                 if (!m_config_update) return;
+                db_flush_async();
+                db_flush_buffered_noexcept();
+                db_group_commit_noexcept();
+                db_close_readers();
                 on_db_close();
-                sqlite3_close_v2(m_sqlite_db);
-                m_sqlite_db = nullptr;
+                db_close();
             }
 
             std::unique_lock<std::mutex> config_locker(m_config_mutex);
             m_config = m_config_new;
+            if (m_database) m_database->db_connection_config(m_config);
             m_config_update = false;
             config_locker.unlock();
 
             try {
-                db_create_directories(m_config);
-                db_open(m_config);
+                if (m_database) {
+                    db_attach(m_config);
+                } else {
+                    create_database_directories(m_config);
+                    m_sqlite_db = open_database(m_config);
+                    // PRAGMAs such as page_size and temp_store must run before any table is created
+                    init_database(m_sqlite_db, m_config);
+                }
                 on_db_open();
                 db_create_table(m_config);
                 db_init(m_config);
+                db_open_readers(m_config);
+                if (m_database) {
+                    m_database->db_attach({this,
+                        [this] { db_flush_async(); },
+                        [this] { db_unblock_async(); on_db_commit(); },
+                        [this] { on_db_rollback(); }});
+                }
             } catch(const sqlite_exception &e) {
-                sqlite3_close_v2(m_sqlite_db);
-                m_sqlite_db = nullptr;
+                db_close_readers();
+                db_close();
                 throw e;
             } catch(...) {
-                sqlite3_close_v2(m_sqlite_db);
-                m_sqlite_db = nullptr;
+                db_close_readers();
+                db_close();
                 throw sqlite_exception("An unspecified error occurred in the database operation.");
             }
         }
@@ -93,51 +133,223 @@ namespace sqlite_containers {
         }
 
         /// \brief Disconnects from the database.
-        /// \throws sqlite_exception if disconnect fails.
+        /// Pending `async_*` calls complete and pending asynchronous writes are committed before the connection is closed.
+        /// Waits for running backup_to() calls. Must not be called from an `async_*` call of the same container or from
+        /// the progress callback of a backup.
+        /// \throws sqlite_exception if disconnect fails or a background write failed.
         void disconnect() {
-            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            m_async_calls.stop();
+            db_stop_async();
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            db_wait_backups(locker);
             if (!m_sqlite_db) return;
 
+            db_flush_async();
+            db_flush_buffered_noexcept();
+            db_group_commit_noexcept();
+            db_close_readers();
             on_db_close();
-            sqlite3_close_v2(m_sqlite_db);
-            m_sqlite_db = nullptr;
+            db_close();
+            locker.unlock();
 
-            try {
-                if (m_future.valid()) {
-                    while (m_future.wait_for(std::chrono::milliseconds(1)) == std::future_status::timeout) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                    }
-                    m_future.get();
+            db_rethrow_async_error();
+        }
+
+        /// \brief Commits all pending asynchronous writes, buffered write-back changes and the open group commit.
+        /// Blocks until every write issued before the call is committed to the database.
+        /// Does nothing if none of `Config::use_async`, `Config::group_commit` or `Config::write_back` is enabled.
+        /// \throws sqlite_exception if a background write or commit failed since the last check.
+        void flush() {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_flush_buffered();
+            db_group_commit();
+            locker.unlock();
+            db_rethrow_async_error();
+        }
+
+        /// \brief Sets the executor running the `async_*` calls of the container.
+        /// By default they run on an I/O thread of the container, started by the first call. The executor receives
+        /// one job per burst of calls, which runs the queued calls in order until the queue is empty, so an executor
+        /// with several threads still runs the calls of one container one after another. Waits for the pending calls
+        /// before switching.
+        /// \param executor The executor, or an empty function to use the I/O thread of the container.
+        void set_executor(Executor executor) {
+            m_async_calls.set_executor(std::move(executor));
+        }
+
+        /// \brief Runs an operation on the I/O thread of the container, or on its executor.
+        /// Calls are run in the order they were submitted, one at a time, so an operation may use any blocking
+        /// method of the container except disconnect(), connect() and set_executor().
+        /// \param operation The operation; it must own copies of its arguments.
+        /// \return Future receiving the result or the exception of the operation.
+        template<typename Func>
+        AsyncResult<typename std::invoke_result<Func>::type> async_call(Func operation) {
+            return async_submit(std::move(operation), false);
+        }
+
+        /// \brief Commits pending writes once the `async_*` calls submitted before it have completed.
+        /// \return Future completing when flush() has returned.
+        AsyncResult<void> async_flush() {
+            return async_call([this] {
+                flush();
+            });
+        }
+
+        /// \brief Copies the whole database into a file while the container stays in use.
+        /// Pending writes are committed first. The pages are copied `BackupOptions::pages_per_step` at a time and
+        /// the connection is released between steps, so other calls are served during the copy. The file is
+        /// created together with its parent directories if needed and replaced once the last page is copied; it is left unchanged if the backup fails
+        /// or is cancelled. `Config::in_memory` databases can be saved to disk this way. For a container attached
+        /// to a Database the copy holds the tables of all its containers. disconnect() and a connect() that applies
+        /// a new configuration wait until the backup has finished, so the progress callback must not call them.
+        /// \param path Path to the destination file.
+        /// \param options Pages per step, pause between steps and progress callback.
+        /// \return True if the backup completed, false if the progress callback cancelled it.
+        /// \throws sqlite_exception if the backup fails.
+        bool backup_to(const std::string& path, const BackupOptions& options = BackupOptions()) {
+            std::unique_lock<std::mutex> locker(m_sqlite_mutex);
+            if (!m_sqlite_db) throw sqlite_exception("Database is not connected.");
+            db_flush_async();
+            db_flush_buffered();
+            db_group_commit();
+            BackupGuard guard(*this, locker);
+            create_parent_directories(path);
+            std::unique_ptr<sqlite3, int(*)(sqlite3*)> dest_db(open_backup_file(path, false), &sqlite3_close_v2);
+            BackupSession backup(dest_db.get(), m_sqlite_db);
+            while (!backup.step(options.pages_per_step)) {
+                locker.unlock();
+                if (options.progress && !options.progress(backup.remaining(), backup.pagecount())) return false;
+                if (options.step_pause_ms > 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(options.step_pause_ms));
                 }
-            } catch(const sqlite_exception &e) {
-                throw e;
-            } catch(const std::exception &e) {
-                throw sqlite_exception(e.what());
-            } catch(...) {
-                throw sqlite_exception("Error occurred during async operation.");
+                locker.lock();
+            }
+            locker.unlock();
+            if (options.progress) options.progress(0, backup.pagecount());
+            return true;
+        }
+
+        /// \brief Replaces the database with the content of a file, e.g. to load a saved `Config::in_memory` database.
+        /// The connection is held for the whole copy. Afterwards the table of the container is created if the file
+        /// lacks it, and its caches are reloaded. Only containers owning their connection can be restored.
+        /// \param path Path to the source file.
+        /// \param options Pages per step and progress callback; `step_pause_ms` is ignored.
+        /// \return True if the restore completed, false if the progress callback cancelled it (the database is then unchanged).
+        /// \throws sqlite_exception if the restore fails, a transaction is open or the container is attached to a Database.
+        bool restore_from(const std::string& path, const BackupOptions& options = BackupOptions()) {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            if (!m_sqlite_db) throw sqlite_exception("Database is not connected.");
+            if (m_database) throw sqlite_exception("Cannot restore a container attached to a Database.");
+            db_flush_async();
+            db_flush_buffered();
+            db_group_commit();
+            if (!sqlite3_get_autocommit(m_sqlite_db)) throw sqlite_exception("Cannot restore during a transaction.");
+            std::unique_ptr<sqlite3, int(*)(sqlite3*)> source_db(open_backup_file(path, true), &sqlite3_close_v2);
+            {
+                BackupSession backup(m_sqlite_db, source_db.get());
+                while (!backup.step(options.pages_per_step)) {
+                    if (options.progress && !options.progress(backup.remaining(), backup.pagecount())) return false;
+                }
+                if (options.progress) options.progress(0, backup.pagecount());
             }
+            db_create_table(m_config);
+            on_db_restore();
+            return true;
+        }
+
+        /// \brief Writes a compacted copy of the database to a new file with `VACUUM INTO`.
+        /// Pending writes are committed first. The copy is consistent and has no free pages, but the connection is
+        /// held until it is written. Requires SQLite 3.27 or later. `VACUUM INTO` would write an in-memory database
+        /// into memory as well, so such a database, e.g. a `Config::in_memory` one, is copied with `sqlite3_backup`
+        /// in a single step instead, free pages included.
+        /// \param path Path to the snapshot file, which must not exist or be empty; missing parent directories are created.
+        /// \throws sqlite_exception if the snapshot fails or a transaction is open.
+        void snapshot_to(const std::string& path) {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            if (!m_sqlite_db) throw sqlite_exception("Database is not connected.");
+            db_flush_async();
+            db_flush_buffered();
+            db_group_commit();
+            if (!sqlite3_get_autocommit(m_sqlite_db)) throw sqlite_exception("Cannot take a snapshot during a transaction.");
+            create_parent_directories(path);
+            const char* file_name = sqlite3_db_filename(m_sqlite_db, "main");
+            if (!file_name || !file_name[0]) {
+                std::error_code ec;
+                if (fs::file_size(path, ec) > 0 && !ec) throw sqlite_exception("Snapshot file is not empty: " + path);
+                std::unique_ptr<sqlite3, int(*)(sqlite3*)> dest_db(open_backup_file(path, false), &sqlite3_close_v2);
+                BackupSession backup(dest_db.get(), m_sqlite_db);
+                while (!backup.step(-1)) {}
+                return;
+            }
+#           if SQLITE_VERSION_NUMBER >= 3027000
+            std::string quoted_path;
+            for (const char c : path) {
+                if (c == '\'') quoted_path += '\'';
+                quoted_path += c;
+            }
+            execute(m_sqlite_db, "VACUUM INTO '" + quoted_path + "';");
+#           else
+            throw sqlite_exception("VACUUM INTO requires SQLite 3.27 or later.");
+#           endif
+        }
+
+        /// \brief Returns the time the connections of the container have spent waiting for a busy database.
+        /// The connection of a Database is shared, so its waits are counted for every container attached to it.
+        /// \return Counters of the waits since the connections were opened.
+        virtual BusyStats busy_stats() const {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            return get_busy_stats(m_sqlite_db);
+        }
+
+        /// \brief Returns a snapshot of the statistics of the container.
+        /// Operation latencies are recorded only when `SQLITE_CONTAINERS_ENABLE_STATS` is defined; the SQLite
+        /// counters are read from the main connection, which may be shared with other containers through a Database.
+        /// \return Latencies, busy waits, page cache counters and counters of the prepared statements.
+        StatsSnapshot stats() const {
+            StatsSnapshot snapshot;
+            snapshot.busy = busy_stats();
+#           ifdef SQLITE_CONTAINERS_ENABLE_STATS
+            snapshot.timed = true;
+            for (size_t i = 0; i < snapshot.operations.size(); ++i) {
+                snapshot.operations[i] = m_op_histograms[i].snapshot();
+            }
+#           endif
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            snapshot.db = get_db_status(m_sqlite_db);
+            snapshot.statements = get_stmt_status(m_sqlite_db);
+            return snapshot;
         }
 
         /// \brief Begins a database transaction.
+        /// Until it is committed or rolled back, reads use the main connection so that they see its writes.
         /// \param mode Transaction mode (default: DEFERRED).
         /// \throws sqlite_exception if the transaction fails.
         void begin(const TransactionMode &mode = TransactionMode::DEFERRED) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
             db_begin(mode);
+            db_set_user_txn(true);
         }
 
         /// \brief Commits the current transaction.
+        /// An open group commit is committed first and does not count as the current transaction.
         /// \throws sqlite_exception if the commit fails.
         void commit() {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_group_commit();
             db_commit();
+            db_set_user_txn(false);
         }
 
         /// \brief Rolls back the current transaction.
+        /// An open group commit is committed first, so writes made outside of `begin()` are never rolled back.
         /// \throws sqlite_exception if the rollback fails.
         void rollback() {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_group_commit();
             db_rollback();
+            db_set_user_txn(false);
         }
 
         /// \brief Executes an operation inside a transaction.
@@ -147,6 +359,8 @@ namespace sqlite_containers {
         template<typename Func>
         void execute_in_transaction(Func operation, const TransactionMode& mode) {
             std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_flush_async();
+            db_group_commit();
             try {
                 db_begin(mode);
                 operation();
@@ -164,29 +378,312 @@ namespace sqlite_containers {
         }
 
         /// \brief Processes asynchronous database requests (can be overridden).
-        virtual void process() {};
+        /// Runs on the background writer thread when `Config::use_async` is enabled.
+        /// Waits for queued writes and commits them in batches of up to `Config::async_batch_size`.
+        /// While a transaction opened by the user is active, queued writes wait until it is committed or rolled back.
+        /// It also commits an open group commit once `Config::group_commit_latency_ms` has elapsed, and writes
+        /// buffered changes back every `Config::write_back_interval_ms`.
+        virtual void process() {
+            std::unique_lock<std::mutex> queue_locker(m_async_mutex);
+            const auto is_ready = [this] {
+                return m_async_stop || (!m_async_queue.empty() && !m_async_blocked);
+            };
+            for (;;) {
+                if (m_async_blocked) {
+                    // SQLite may also end the transaction on its own after an error, so the state is rechecked periodically
+                    if (!m_async_cv.wait_for(queue_locker, std::chrono::milliseconds(10), is_ready)) {
+                        m_async_blocked = false;
+                        continue;
+                    }
+                } else if (m_group_deadline_set || m_flush_interval.count() > 0) {
+                    const bool group_deadline_set = m_group_deadline_set;
+                    auto deadline = m_group_deadline_set ? m_group_deadline : m_flush_deadline;
+                    if (m_flush_interval.count() > 0) deadline = std::min(deadline, m_flush_deadline);
+                    // A group commit started during the wait changes the deadline, so it also ends the wait
+                    if (!m_async_cv.wait_until(queue_locker, deadline, [this, &is_ready, group_deadline_set] {
+                            return is_ready() || m_group_deadline_set != group_deadline_set;
+                        })) {
+                        queue_locker.unlock();
+                        {
+                            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+                            db_group_commit_expired();
+                            db_flush_buffered_expired();
+                        }
+                        queue_locker.lock();
+                        continue;
+                    }
+                    if (!is_ready()) continue;
+                } else {
+                    m_async_cv.wait(queue_locker, [this, &is_ready] {
+                        return is_ready() || m_group_deadline_set;
+                    });
+                    if (!is_ready()) continue;
+                }
+                if (m_async_queue.empty()) return;
+                if (m_async_stop && m_async_blocked) return; // The remaining writes are flushed by the stopping thread
+                queue_locker.unlock();
+                {
+                    std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+                    db_flush_async(false);
+                }
+                queue_locker.lock();
+            }
+        }
 
     protected:
         sqlite3*            m_sqlite_db = nullptr;
-        mutable std::mutex  m_sqlite_mutex;
+        Database*           m_database = nullptr;   ///< Database whose connection is shared, or null if the container owns its connection.
+        mutable std::mutex  m_own_mutex;            ///< Lock of the connection owned by the container.
+        std::mutex&         m_sqlite_mutex;         ///< Lock of the connection in use: `m_own_mutex` or the lock of `m_database`.
+        std::atomic<bool>   m_async_writes = ATOMIC_VAR_INIT(false); ///< True while the background writer accepts writes.
+        std::atomic<bool>   m_user_txn = ATOMIC_VAR_INIT(false);     ///< True while a transaction opened by `begin()` is active.
+#       ifdef SQLITE_CONTAINERS_ENABLE_STATS
+        mutable OperationHistograms m_op_histograms;  ///< Latencies of the operations of the container.
+#       endif
+
+        /// \brief Checks whether reads may be served by the read-only connections.
+        /// While a transaction opened by `begin()` or an open group commit is active, reads use the main connection
+        /// to see its writes.
+        bool db_can_use_readers() const noexcept {
+            if (m_group_open.load(std::memory_order_acquire)) return false;
+            if (m_database) return !m_database->m_user_txn.load(std::memory_order_acquire);
+            return !m_user_txn.load(std::memory_order_acquire);
+        }
+
+        /// \brief Records whether a transaction opened by the user is active.
+        /// For an attached container the state is kept by the Database and seen by all its containers.
+        void db_set_user_txn(const bool& active) noexcept {
+            if (m_database) {
+                m_database->m_user_txn = active;
+            } else {
+                m_user_txn = active;
+            }
+        }
 
         /// \brief Begins a transaction with the given mode.
+        /// Commits the open group commit first, since SQLite transactions cannot be nested.
         /// \param mode Transaction mode (defaults to DEFERRED).
         /// \throws sqlite_exception if the transaction fails.
         void db_begin(const TransactionMode &mode = TransactionMode::DEFERRED) {
+            db_group_commit();
             m_stmt_begin[static_cast<size_t>(mode)].execute(m_sqlite_db);
         }
 
         /// \brief Commits the current transaction.
         /// \throws sqlite_exception if the commit fails.
         void db_commit() {
+            SQLITE_CONTAINERS_STATS_TIMER(m_op_histograms, StatsOperation::COMMIT);
             m_stmt_commit.execute(m_sqlite_db);
+            if (m_database) {
+                // The transaction may hold writes of every container on the shared connection
+                m_database->db_committed();
+                return;
+            }
+            db_unblock_async();
+            on_db_commit();
         }
 
         /// \brief Rolls back the current transaction.
         /// \throws sqlite_exception if the rollback fails.
         void db_rollback() {
             m_stmt_rollback.execute(m_sqlite_db);
+            db_unblock_async();
+        }
+
+        /// \brief Executes a write in one transaction, joining the transaction that is already open.
+        /// Must be called with `m_sqlite_mutex` held. Otherwise a transaction with `Config::default_txn_mode` is
+        /// started, committed when the write succeeds and rolled back when it throws.
+        /// \param operation The write to execute.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<typename Func>
+        void db_write_in_transaction(Func&& operation) {
+            if (!sqlite3_get_autocommit(m_sqlite_db)) {
+                operation();
+                return;
+            }
+            db_begin(get_config().default_txn_mode);
+            try {
+                operation();
+                db_commit();
+            } catch (...) {
+                if (!sqlite3_get_autocommit(m_sqlite_db)) {
+                    try {
+                        db_rollback();
+                    } catch (...) {}
+                }
+                throw;
+            }
+        }
+
+        /// \brief Queues a single-row write run with `m_sqlite_mutex` held by the I/O thread.
+        /// Consecutive queued writes share one transaction (see db_run_async_writes()), so the operation must use
+        /// db_group_write() or db_write_in_transaction(), which join it.
+        /// \param operation The write; it must own copies of its arguments.
+        /// \return Future receiving the result or the exception of the write.
+        template<typename Func>
+        AsyncResult<typename std::invoke_result<Func>::type> async_write(Func operation) {
+            return async_submit(std::move(operation), true);
+        }
+
+        /// \brief Executes a single-row write, sharing a transaction with neighbouring writes.
+        /// Must be called with `m_sqlite_mutex` held. With `Config::group_commit` the write joins the open
+        /// `BEGIN IMMEDIATE` transaction (starting one if needed), and the transaction is committed once it holds
+        /// `Config::group_commit_rows` rows or `Config::group_commit_bytes` bytes. The background writer commits it
+        /// after `Config::group_commit_latency_ms` otherwise. Without group commit the write runs in autocommit mode.
+        /// A failed commit issued by the background writer is reported by the next single-row write.
+        /// \param operation The write to execute.
+        /// \param bytes Approximate number of bytes written.
+        /// \throws sqlite_exception if an SQLite error occurs or the last group commit failed.
+        template<typename Func>
+        void db_group_write(Func&& operation, const std::size_t& bytes) {
+            if (m_group_commit) db_rethrow_async_error();
+            if (!m_group_commit || (!m_group_open && !sqlite3_get_autocommit(m_sqlite_db))) {
+                // Group commit is disabled, or the write belongs to a transaction opened by the caller
+                operation();
+                return;
+            }
+            if (!m_group_open) {
+                m_stmt_begin[static_cast<size_t>(TransactionMode::IMMEDIATE)].execute(m_sqlite_db);
+                m_group_open = true;
+                m_group_rows = 0;
+                m_group_bytes = 0;
+                m_group_started = std::chrono::steady_clock::now();
+                std::unique_lock<std::mutex> queue_locker(m_async_mutex);
+                m_group_deadline = m_group_started + m_group_latency;
+                m_group_deadline_set = true;
+                queue_locker.unlock();
+                m_async_cv.notify_all();
+            }
+            try {
+                operation();
+            } catch (...) {
+                // Some errors make SQLite roll back the whole transaction together with the grouped writes
+                if (sqlite3_get_autocommit(m_sqlite_db)) m_group_open = false;
+                throw;
+            }
+            ++m_group_rows;
+            m_group_bytes += bytes;
+            if (m_group_rows >= m_group_max_rows ||
+                m_group_bytes >= m_group_max_bytes ||
+                (std::chrono::steady_clock::now() - m_group_started) >= m_group_latency) {
+                db_group_commit();
+            }
+        }
+
+        /// \brief Commits the open group commit, if any.
+        /// Must be called with `m_sqlite_mutex` held.
+        /// \throws sqlite_exception if the commit fails; the grouped writes are rolled back.
+        void db_group_commit() {
+            if (!m_group_open) return;
+            m_group_open = false;
+            {
+                std::lock_guard<std::mutex> queue_locker(m_async_mutex);
+                m_group_deadline_set = false;
+            }
+            try {
+                m_stmt_commit.execute(m_sqlite_db);
+            } catch (...) {
+                if (!sqlite3_get_autocommit(m_sqlite_db)) {
+                    try {
+                        m_stmt_rollback.execute(m_sqlite_db);
+                    } catch (...) {}
+                }
+                db_handle_exception(std::current_exception(), {&m_stmt_commit},
+                    "Unknown error occurred during group commit.");
+            }
+            on_db_commit();
+        }
+
+        /// \brief Queues a write for the background writer.
+        /// Blocks while the queue holds `Config::async_queue_size` writes.
+        /// \param task The write to execute; it must own copies of its arguments.
+        /// \throws sqlite_exception if a previous background write failed or the writer is stopped.
+        void async_enqueue(std::function<void()> task) {
+            std::unique_lock<std::mutex> queue_locker(m_async_mutex);
+            if (m_async_error) {
+                std::exception_ptr ex = m_async_error;
+                m_async_error = nullptr;
+                queue_locker.unlock();
+                db_handle_exception(ex, {}, "Error occurred during async operation.");
+            }
+            m_async_not_full_cv.wait(queue_locker, [this] {
+                return m_async_stop || m_async_queue.size() < m_async_queue_size;
+            });
+            if (m_async_stop) {
+                throw sqlite_exception("Asynchronous writer is not running.");
+            }
+            m_async_queue.push_back(std::move(task));
+            queue_locker.unlock();
+            m_async_cv.notify_one();
+        }
+
+        /// \brief Executes all queued asynchronous writes on the calling thread.
+        /// Must be called with `m_sqlite_mutex` held. Writes are grouped into transactions of up
+        /// to `Config::async_batch_size`. If a batch fails, it is rolled back and replayed write by write
+        /// so that only the failing writes are lost. The first error is kept and reported by the next call
+        /// to `flush()`, `disconnect()` or a queued write.
+        /// \param join_transaction If true, the writes join a transaction opened by the user on this thread;
+        /// otherwise nothing is written while such a transaction is open and the background writer waits for it to end.
+        void db_flush_async(const bool& join_transaction = true) {
+            std::vector<std::function<void()>> batch;
+            if (m_group_open) {
+                std::unique_lock<std::mutex> queue_locker(m_async_mutex);
+                const bool has_tasks = !m_async_queue.empty();
+                queue_locker.unlock();
+                if (has_tasks) db_group_commit_noexcept();
+            }
+            if (!join_transaction && !sqlite3_get_autocommit(m_sqlite_db)) {
+                std::lock_guard<std::mutex> queue_locker(m_async_mutex);
+                m_async_blocked = true;
+                return;
+            }
+            for (;;) {
+                std::unique_lock<std::mutex> queue_locker(m_async_mutex);
+                if (m_async_queue.empty()) return;
+                const std::size_t batch_size = std::min(m_async_queue.size(), m_async_batch_size);
+                batch.clear();
+                batch.reserve(batch_size);
+                for (std::size_t i = 0; i < batch_size; ++i) {
+                    batch.push_back(std::move(m_async_queue.front()));
+                    m_async_queue.pop_front();
+                }
+                queue_locker.unlock();
+                m_async_not_full_cv.notify_all();
+
+                if (!sqlite3_get_autocommit(m_sqlite_db)) {
+                    for (auto& task : batch) {
+                        db_execute_async_task(task);
+                    }
+                    continue;
+                }
+                try {
+                    m_stmt_begin[static_cast<size_t>(m_async_txn_mode)].execute(m_sqlite_db);
+                    for (auto& task : batch) {
+                        task();
+                    }
+                    db_commit();
+                } catch (...) {
+                    if (!sqlite3_get_autocommit(m_sqlite_db)) {
+                        try {
+                            db_rollback();
+                        } catch (...) {}
+                    }
+                    for (auto& task : batch) {
+                        db_execute_async_task(task);
+                    }
+                }
+            }
+        }
+
+        /// \brief Rethrows the first error raised by the background writer, if any.
+        /// \throws sqlite_exception if a background write failed.
+        void db_rethrow_async_error() {
+            std::unique_lock<std::mutex> queue_locker(m_async_mutex);
+            if (!m_async_error) return;
+            std::exception_ptr ex = m_async_error;
+            m_async_error = nullptr;
+            queue_locker.unlock();
+            db_handle_exception(ex, {}, "Error occurred during async operation.");
         }
 
         /// \brief Handles an exception by resetting and clearing bindings of prepared SQL statements.
@@ -200,7 +697,9 @@ namespace sqlite_containers {
                 const std::string& message = "Unknown error occurred.") const {
             try {
                 for (auto* stmt : stmts) {
-                    stmt->reset();
+                    if (!stmt->is_prepared()) continue;
+                    // The reset repeats the error of a failed step, which is reported by `ex` instead
+                    sqlite3_reset(stmt->get_stmt());
                     stmt->clear_bindings();
                 }
                 if (ex) {
@@ -228,70 +727,312 @@ namespace sqlite_containers {
 
         std::shared_future<void> m_future;
 
-        /// \brief Creates necessary directories for the database.
-        /// This method checks if the parent directory of the database file exists, and if not, attempts to create it.
-        /// \param config Configuration settings, including the path to the database file.
-        /// \throws sqlite_exception If the directories cannot be created.
-        void db_create_directories(const Config &config) {
-            fs::path file_path(config.db_path);
-            fs::path parent_dir = file_path.parent_path();
-            if (parent_dir.empty()) return;
-            if (!fs::exists(parent_dir)) {
-                if (!fs::create_directories(parent_dir)) {
-                    throw sqlite_exception("Failed to create directories for path: " + parent_dir.string());
+        std::deque<std::function<void()>> m_async_queue;  ///< Writes waiting for the background writer.
+        std::mutex              m_async_mutex;          ///< Protects the asynchronous queue and error state.
+        std::condition_variable m_async_cv;             ///< Signals the writer about new writes or shutdown.
+        std::condition_variable m_async_not_full_cv;    ///< Signals producers that the queue has room.
+        std::exception_ptr      m_async_error;          ///< First error raised by a background write.
+        std::size_t             m_async_queue_size = 0; ///< Queue capacity taken from the configuration.
+        std::size_t             m_async_batch_size = 0; ///< Batch size taken from the configuration.
+        TransactionMode         m_async_txn_mode = TransactionMode::IMMEDIATE; ///< Transaction mode of writer batches.
+        bool                    m_async_stop = true;    ///< True when the writer must exit after draining the queue.
+        bool                    m_async_blocked = false; ///< True while the writer waits for a user transaction to end.
+
+        std::condition_variable m_backup_cv;            ///< Signals disconnect() and connect() that the last backup has finished.
+        std::size_t             m_active_backups = 0;   ///< Running backup_to() calls; guarded by the connection lock.
+
+        bool                    m_group_commit = false; ///< Whether group commit is enabled.
+        std::atomic<bool>       m_group_open = ATOMIC_VAR_INIT(false); ///< True while a group commit transaction is open.
+        std::size_t             m_group_rows = 0;       ///< Rows written in the open group commit.
+        std::size_t             m_group_bytes = 0;      ///< Bytes written in the open group commit.
+        std::size_t             m_group_max_rows = 0;   ///< Row count that triggers a group commit.
+        std::size_t             m_group_max_bytes = 0;  ///< Byte count that triggers a group commit.
+        std::chrono::milliseconds m_group_latency{0};   ///< Maximum age of a group commit.
+        std::chrono::steady_clock::time_point m_group_started;  ///< Start time of the open group commit.
+        std::chrono::steady_clock::time_point m_group_deadline; ///< Commit deadline seen by the background writer.
+        bool                    m_group_deadline_set = false;   ///< True while the writer must watch the deadline.
+
+        std::chrono::milliseconds m_flush_interval{0};  ///< Interval of background write-back flushes, 0 if disabled.
+        std::chrono::steady_clock::time_point m_flush_deadline; ///< Time of the next write-back flush.
+
+        /// Queue of the `async_*` calls; declared last so that its I/O thread is joined first.
+        AsyncRunner m_async_calls{[this](std::vector<AsyncTask>& batch) {
+            db_run_async_calls(batch);
+        }};
+
+        /// \brief Queues an `async_*` call.
+        /// \param operation The operation.
+        /// \param locked Whether the operation is a write run with `m_sqlite_mutex` held.
+        /// \return Future of the call.
+        template<typename Func>
+        AsyncResult<typename std::invoke_result<Func>::type> async_submit(Func&& operation, const bool& locked) {
+            using ResultT = typename std::invoke_result<Func>::type;
+            auto call = std::make_shared<AsyncCall<ResultT>>(std::forward<Func>(operation));
+            AsyncResult<ResultT> result = call->result();
+            AsyncTask task;
+            task.run = [call] {
+                return call->run();
+            };
+            task.fail = [call](std::exception_ptr error) {
+                call->fail(std::move(error));
+            };
+            task.resolve = [call] {
+                call->resolve();
+            };
+            task.locked = locked;
+            m_async_calls.submit(std::move(task));
+            return result;
+        }
+
+        /// \brief Runs a batch of `async_*` calls in order on the I/O thread.
+        /// Consecutive writes are handed to db_run_async_writes(); other calls take the locks they need themselves.
+        /// \param batch The calls.
+        void db_run_async_calls(std::vector<AsyncTask>& batch) noexcept {
+            std::size_t i = 0;
+            while (i < batch.size()) {
+                if (!batch[i].locked) {
+                    batch[i].run();
+                    batch[i].resolve();
+                    ++i;
+                    continue;
+                }
+                std::size_t end = i + 1;
+                while (end < batch.size() && batch[end].locked) ++end;
+                db_run_async_writes(batch.data() + i, end - i);
+                i = end;
+            }
+        }
+
+        /// \brief Runs consecutive `async_*` writes in one transaction.
+        /// The writes join a transaction that is already open. Otherwise several writes are pipelined into one
+        /// transaction with `Config::default_txn_mode`; if one of them fails or the commit fails, the transaction
+        /// is rolled back and the writes are run again one by one, so that only the failing writes report an error.
+        /// The futures are resolved after the connection lock is released.
+        /// \param tasks The writes.
+        /// \param count Number of writes.
+        void db_run_async_writes(AsyncTask* tasks, const std::size_t& count) noexcept {
+            {
+                std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+                if (!m_sqlite_db) {
+                    const auto error = std::make_exception_ptr(sqlite_exception("Database is not connected."));
+                    for (std::size_t i = 0; i < count; ++i) {
+                        tasks[i].fail(error);
+                    }
+                } else {
+                    bool shared = false;
+                    if (count > 1) {
+                        try {
+                            db_group_commit();
+                            if (sqlite3_get_autocommit(m_sqlite_db)) {
+                                db_begin(get_config().default_txn_mode);
+                                shared = true;
+                            }
+                        } catch (...) {}
+                    }
+                    bool replay = !shared;
+                    if (shared) {
+                        for (std::size_t i = 0; i < count && !replay; ++i) {
+                            replay = !tasks[i].run();
+                        }
+                        if (!replay) {
+                            try {
+                                db_commit();
+                            } catch (...) {
+                                replay = true;
+                            }
+                        }
+                        if (replay && !sqlite3_get_autocommit(m_sqlite_db)) {
+                            try {
+                                db_rollback();
+                            } catch (...) {}
+                        }
+                    }
+                    if (replay) {
+                        for (std::size_t i = 0; i < count; ++i) {
+                            tasks[i].run();
+                        }
+                    }
                 }
             }
+            for (std::size_t i = 0; i < count; ++i) {
+                tasks[i].resolve();
+            }
+        }
+
+        /// \brief Writes buffered changes back and records a failure instead of throwing it.
+        void db_flush_buffered_noexcept() noexcept {
+            try {
+                db_flush_buffered();
+            } catch (...) {
+                std::lock_guard<std::mutex> queue_locker(m_async_mutex);
+                if (!m_async_error) m_async_error = std::current_exception();
+            }
+        }
+
+        /// \brief Writes buffered changes back once `Config::write_back_interval_ms` has elapsed.
+        /// Called by the background writer with `m_sqlite_mutex` held. Nothing is written while a transaction
+        /// opened by the user is active; the flush is retried on the next interval.
+        void db_flush_buffered_expired() noexcept {
+            if (m_flush_interval.count() <= 0) return;
+            const auto now = std::chrono::steady_clock::now();
+            if (now < m_flush_deadline) return;
+            m_flush_deadline = now + m_flush_interval;
+            if (!sqlite3_get_autocommit(m_sqlite_db)) return;
+            db_flush_buffered_noexcept();
+        }
+
+        /// \brief Commits the open group commit and records a failure instead of throwing it.
+        void db_group_commit_noexcept() noexcept {
+            try {
+                db_group_commit();
+            } catch (...) {
+                std::lock_guard<std::mutex> queue_locker(m_async_mutex);
+                if (!m_async_error) m_async_error = std::current_exception();
+            }
         }
 
-        /// \brief Opens the database with the specified configuration.
+        /// \brief Commits the open group commit if it has reached its maximum latency.
+        /// Called by the background writer with `m_sqlite_mutex` held.
+        void db_group_commit_expired() noexcept {
+            if (!m_group_open) {
+                std::lock_guard<std::mutex> queue_locker(m_async_mutex);
+                m_group_deadline_set = false;
+                return;
+            }
+            if ((std::chrono::steady_clock::now() - m_group_started) < m_group_latency) return;
+            db_group_commit_noexcept();
+        }
+
+        /// \brief Lets the background writer resume after a transaction has ended.
+        /// Must be called with `m_sqlite_mutex` held.
+        void db_unblock_async() {
+            std::unique_lock<std::mutex> queue_locker(m_async_mutex);
+            if (!m_async_blocked) return;
+            m_async_blocked = false;
+            queue_locker.unlock();
+            m_async_cv.notify_all();
+        }
+
+        /// \brief Executes a single queued write in autocommit mode and records its error.
+        /// \param task The write to execute.
+        void db_execute_async_task(std::function<void()>& task) noexcept {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> queue_locker(m_async_mutex);
+                if (!m_async_error) m_async_error = std::current_exception();
+            }
+        }
+
+        /// \brief Stops the background writer after it has committed all queued writes.
+        /// Must be called without `m_sqlite_mutex` held.
+        void db_stop_async() {
+            std::unique_lock<std::mutex> queue_locker(m_async_mutex);
+            m_async_writes = false;
+            m_async_stop = true;
+            queue_locker.unlock();
+            m_async_cv.notify_all();
+            m_async_not_full_cv.notify_all();
+
+            if (!m_future.valid()) return;
+            try {
+                m_future.get();
+            } catch (...) {
+                std::lock_guard<std::mutex> error_locker(m_async_mutex);
+                if (!m_async_error) m_async_error = std::current_exception();
+            }
+            m_future = std::shared_future<void>();
+        }
+
+        /// \brief Takes the connection of the Database the container is attached to.
         /// \param config Configuration settings.
-        /// \throws sqlite_exception if the database fails to open.
-        void db_open(const Config &config) {
-            int flags = 0;
-            flags |= config.read_only ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
-            flags |= config.use_uri ? SQLITE_OPEN_URI : 0;
-            flags |= config.in_memory ? SQLITE_OPEN_MEMORY : 0;
-            flags |= SQLITE_OPEN_FULLMUTEX;
-            int err = 0;
-            const char* db_name = config.in_memory ? ":memory:" : config.db_path.c_str();
-            if ((err = sqlite3_open_v2(db_name, &m_sqlite_db, flags, nullptr)) != SQLITE_OK) {
-                std::string error_message = "Cannot open database: ";
-                error_message += sqlite3_errmsg(m_sqlite_db);
-                error_message += " (Error code: ";
-                error_message += std::to_string(err);
-                error_message += ")";
-                throw sqlite_exception(error_message);
-            }
-        }
-
-        /// \brief Initializes the database with the given configuration.
-        /// Sets database parameters such as busy timeout, page size, cache size, journal mode, and other settings.
+        /// \throws sqlite_exception if the Database is not connected or the configuration needs an own connection.
+        void db_attach(const Config &config) {
+            if (!m_database->m_sqlite_db) throw sqlite_exception("Database is not connected.");
+            if (config.group_commit) throw sqlite_exception("Group commit is not available for containers attached to a Database.");
+            m_sqlite_db = m_database->m_sqlite_db;
+        }
+
+        /// \brief Closes the connection, or detaches from the Database whose connection is shared.
+        void db_close() noexcept {
+            if (m_database) {
+                if (m_sqlite_db) m_database->db_detach(this);
+            } else {
+                clear_busy_policy(m_sqlite_db);
+                sqlite3_close_v2(m_sqlite_db);
+            }
+            m_sqlite_db = nullptr;
+        }
+
+        /// \brief Keeps the source connection of backup_to() open until the backup has finished.
+        /// The count is raised with the connection lock held and lowered with it held again, since the lock is
+        /// released between backup steps.
+        class BackupGuard {
+        public:
+            BackupGuard(BaseDB& db, std::unique_lock<std::mutex>& locker) : m_db(db), m_locker(locker) {
+                ++m_db.m_active_backups;
+            }
+
+            BackupGuard(const BackupGuard&) = delete;
+            BackupGuard& operator=(const BackupGuard&) = delete;
+
+            ~BackupGuard() {
+                if (!m_locker.owns_lock()) m_locker.lock();
+                if (--m_db.m_active_backups == 0) m_db.m_backup_cv.notify_all();
+            }
+
+        private:
+            BaseDB&                         m_db;       ///< Container running the backup.
+            std::unique_lock<std::mutex>&   m_locker;   ///< Lock of the connection held by backup_to().
+        };
+
+        /// \brief Waits until no backup_to() call uses the connection.
+        /// \param locker Lock of the connection; released while waiting.
+        void db_wait_backups(std::unique_lock<std::mutex>& locker) {
+            m_backup_cv.wait(locker, [this] {
+                return m_active_backups == 0;
+            });
+        }
+
+        /// \brief Initializes the statements and write settings of the container.
+        /// The PRAGMA settings of the connection are applied by init_database() right after it is opened.
         /// \param config Configuration settings.
         void db_init(const Config &config) {
-            execute(m_sqlite_db, "PRAGMA busy_timeout = " + std::to_string(config.busy_timeout) + ";");
-            execute(m_sqlite_db, "PRAGMA page_size = " + std::to_string(config.page_size) + ";");
-            execute(m_sqlite_db, "PRAGMA cache_size = " + std::to_string(config.cache_size) + ";");
-            execute(m_sqlite_db, "PRAGMA analysis_limit = " + std::to_string(config.analysis_limit) + ";");
-            execute(m_sqlite_db, "PRAGMA wal_autocheckpoint = " + std::to_string(config.wal_autocheckpoint) + ";");
-            execute(m_sqlite_db, "PRAGMA journal_mode = " + to_string(config.journal_mode) + ";");
-            execute(m_sqlite_db, "PRAGMA synchronous = " + to_string(config.synchronous) + ";");
-            execute(m_sqlite_db, "PRAGMA locking_mode = " + to_string(config.locking_mode) + ";");
-            execute(m_sqlite_db, "PRAGMA auto_vacuum = " + to_string(config.auto_vacuum_mode) + ";");
-
             for (size_t i = 0; i < m_stmt_begin.size(); ++i) {
-                m_stmt_begin[i].init(m_sqlite_db, "BEGIN " + to_string(static_cast<TransactionMode>(i)) + " TRANSACTION");
+                m_stmt_begin[i].defer(m_sqlite_db, "BEGIN " + to_string(static_cast<TransactionMode>(i)) + " TRANSACTION", true);
             }
-            m_stmt_commit.init(m_sqlite_db, "COMMIT");
-            m_stmt_rollback.init(m_sqlite_db, "ROLLBACK");
-
-            if (config.user_version > 0) {
-                execute(m_sqlite_db, "PRAGMA user_version = " + std::to_string(config.user_version) + ";");
+            m_stmt_commit.init(m_sqlite_db, "COMMIT", true);
+            m_stmt_rollback.init(m_sqlite_db, "ROLLBACK", true);
+            m_user_txn = false;
+            if (!m_database) {
+                sqlite3_rollback_hook(m_sqlite_db, [](void* ptr) {
+                    BaseDB* db = static_cast<BaseDB*>(ptr);
+                    db->m_user_txn = false;
+                    db->on_db_rollback();
+                }, this);
             }
-            if (config.use_async) {
+            m_group_commit = config.group_commit;
+            m_group_open = false;
+            m_group_max_rows = std::max<std::size_t>(config.group_commit_rows, 1);
+            m_group_max_bytes = std::max<std::size_t>(config.group_commit_bytes, 1);
+            m_group_latency = std::chrono::milliseconds(std::max(config.group_commit_latency_ms, 0));
+            m_flush_interval = std::chrono::milliseconds(config.write_back ? std::max(config.write_back_interval_ms, 1) : 0);
+            m_flush_deadline = std::chrono::steady_clock::now() + m_flush_interval;
+            m_async_calls.set_batch_size(config.async_pipeline_size);
+            if (config.use_async || config.group_commit || config.write_back) {
+                std::unique_lock<std::mutex> queue_locker(m_async_mutex);
+                m_async_queue_size = std::max<std::size_t>(config.async_queue_size, 1);
+                m_async_batch_size = std::max<std::size_t>(config.async_batch_size, 1);
+                m_async_txn_mode = config.default_txn_mode;
+                m_async_stop = false;
+                m_async_blocked = false;
+                m_group_deadline_set = false;
+                queue_locker.unlock();
                 m_future = std::async(std::launch::async,
                         [this] {
                     process();
                 }).share();
+                m_async_writes = config.use_async;
             }
         }
 
@@ -302,6 +1043,18 @@ namespace sqlite_containers {
         /// \param config Configuration settings.
         virtual void db_create_table(const Config &config) = 0;
 
+        /// \brief Opens the read-only connections (see `Config::read_connections`).
+        /// Called with `m_sqlite_mutex` held once the database is initialized.
+        /// Can be overridden in derived classes.
+        /// \param config Configuration settings.
+        virtual void db_open_readers(const Config &config) {
+            (void)config;
+        }
+
+        /// \brief Closes the read-only connections before the main connection is closed.
+        /// Can be overridden in derived classes.
+        virtual void db_close_readers() {}
+
         /// \brief Called after the database is opened.
         /// Can be overridden in derived classes.
         virtual void on_db_open() {}
@@ -310,6 +1063,26 @@ namespace sqlite_containers {
         /// Can be overridden in derived classes.
         virtual void on_db_close() {}
 
+        /// \brief Writes changes buffered by the derived class to the database.
+        /// Called with `m_sqlite_mutex` held by `flush()`, before the connection is closed, and by the background
+        /// writer every `Config::write_back_interval_ms` when `Config::write_back` is enabled.
+        /// Can be overridden in derived classes.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        virtual void db_flush_buffered() {}
+
+        /// \brief Called with `m_sqlite_mutex` held after a transaction has been committed.
+        /// Can be overridden in derived classes.
+        virtual void on_db_commit() {}
+
+        /// \brief Called whenever a transaction is rolled back, including automatic rollbacks after an error.
+        /// Runs inside the SQLite rollback hook, so it must not use the database connection.
+        /// Can be overridden in derived classes.
+        virtual void on_db_rollback() {}
+
+        /// \brief Called after restore_from() replaced the database and the table was created again.
+        /// Can be overridden in derived classes to drop caches of the old content.
+        virtual void on_db_restore() {}
+
     }; // BaseDB
 
 }; // namespace sqlite_containers
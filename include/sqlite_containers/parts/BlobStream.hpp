@@ -0,0 +1,156 @@
+#pragma once
+
+/// \file BlobStream.hpp
+/// \brief Declaration of the BlobStream class for incremental reads and writes of a stored value.
+
+#include "Utils.hpp"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+
+namespace sqlite_containers {
+
+    /// \class BlobStream
+    /// \brief Handle over one stored TEXT or BLOB value, read and written in pieces at any offset.
+    /// \details Wraps an SQLite incremental BLOB handle (`sqlite3_blob_open()`), so a value of any size is read
+    /// into or written from buffers of the caller without being copied whole into memory. The size of the value
+    /// is fixed when it is written (see KeyValueDB::insert_blob()); writes cannot grow it. Like Cursor, the stream
+    /// owns the lock of the database connection until it is closed or destroyed, so the owning thread must not
+    /// call other methods of the container while the stream is open.
+    class BlobStream {
+    public:
+        using CloseFunc = std::function<void()>; ///< Function called once the handle is closed.
+
+        /// \brief Constructs a closed stream.
+        BlobStream() = default;
+
+        /// \brief Constructs a stream over an open BLOB handle.
+        /// \param locker Lock of the database connection, held until the stream is closed.
+        /// \param sqlite_db Pointer to the SQLite database.
+        /// \param blob Open BLOB handle; the stream closes it.
+        /// \param on_close Function called after the handle is closed, may be empty.
+        BlobStream(std::unique_lock<std::mutex> locker, sqlite3* sqlite_db, sqlite3_blob* blob, CloseFunc on_close = CloseFunc()) :
+            m_locker(std::move(locker)), m_sqlite_db(sqlite_db), m_blob(blob), m_on_close(std::move(on_close)) {}
+
+        BlobStream(const BlobStream&) = delete;
+        BlobStream& operator=(const BlobStream&) = delete;
+
+        /// \brief Move constructor.
+        BlobStream(BlobStream&& other) noexcept :
+                m_locker(std::move(other.m_locker)),
+                m_sqlite_db(other.m_sqlite_db),
+                m_blob(other.m_blob),
+                m_on_close(std::move(other.m_on_close)) {
+            other.m_blob = nullptr;
+        }
+
+        /// \brief Move assignment. Closes the current handle first.
+        BlobStream& operator=(BlobStream&& other) noexcept {
+            if (this != &other) {
+                release();
+                m_locker = std::move(other.m_locker);
+                m_sqlite_db = other.m_sqlite_db;
+                m_blob = other.m_blob;
+                m_on_close = std::move(other.m_on_close);
+                other.m_blob = nullptr;
+            }
+            return *this;
+        }
+
+        /// \brief Destructor. Closes the handle and releases the connection; errors are ignored.
+        ~BlobStream() {
+            release();
+        }
+
+        /// \brief Checks if the stream is open.
+        bool is_open() const noexcept {
+            return m_blob != nullptr;
+        }
+
+        /// \brief Checks if the stream is open.
+        explicit operator bool() const noexcept {
+            return is_open();
+        }
+
+        /// \brief Returns the size of the value in bytes, or 0 if the stream is closed.
+        std::size_t size() const noexcept {
+            return m_blob ? static_cast<std::size_t>(sqlite3_blob_bytes(m_blob)) : 0;
+        }
+
+        /// \brief Reads bytes of the value into a buffer.
+        /// \param data Buffer receiving the bytes.
+        /// \param size Maximum number of bytes to read.
+        /// \param offset Offset of the first byte in the value.
+        /// \return Number of bytes read; less than `size` at the end of the value.
+        /// \throws sqlite_exception if the stream is closed or an SQLite error occurs.
+        std::size_t read(void* data, const std::size_t& size, const std::size_t& offset = 0) {
+            check_open();
+            const std::size_t total = this->size();
+            if (offset >= total) return 0;
+            const std::size_t count = std::min(size, total - offset);
+            if (count == 0) return 0;
+            check(sqlite3_blob_read(m_blob, data, static_cast<int>(count), static_cast<int>(offset)));
+            return count;
+        }
+
+        /// \brief Writes bytes into the value.
+        /// \param data Bytes to write.
+        /// \param size Number of bytes to write.
+        /// \param offset Offset of the first byte in the value.
+        /// \throws sqlite_exception if the stream is closed or read-only, the range lies past the end of the
+        /// value, or an SQLite error occurs.
+        void write(const void* data, const std::size_t& size, const std::size_t& offset = 0) {
+            check_open();
+            if (offset > this->size() || size > this->size() - offset) {
+                throw sqlite_exception("Write past the end of the BLOB value.");
+            }
+            if (size == 0) return;
+            check(sqlite3_blob_write(m_blob, data, static_cast<int>(size), static_cast<int>(offset)));
+        }
+
+        /// \brief Closes the handle and releases the connection.
+        /// Writes made outside a transaction are committed here.
+        /// \throws sqlite_exception if the writes cannot be committed.
+        void close() {
+            if (!m_blob) return;
+            const int err = sqlite3_blob_close(m_blob);
+            m_blob = nullptr;
+            if (err == SQLITE_OK && m_on_close) m_on_close();
+            m_on_close = CloseFunc();
+            std::string err_msg;
+            if (err != SQLITE_OK) err_msg = "SQLite error: " + std::to_string(err) + ", " + sqlite3_errmsg(m_sqlite_db);
+            if (m_locker.owns_lock()) m_locker.unlock();
+            if (err != SQLITE_OK) throw sqlite_exception(err_msg, err);
+        }
+
+    private:
+        std::unique_lock<std::mutex> m_locker;  ///< Lock of the database connection.
+        sqlite3*        m_sqlite_db = nullptr;  ///< Pointer to the SQLite database.
+        sqlite3_blob*   m_blob = nullptr;       ///< The BLOB handle.
+        CloseFunc       m_on_close;             ///< Function called once the handle is closed.
+
+        /// \brief Closes the handle without reporting errors.
+        void release() noexcept {
+            try {
+                close();
+            } catch (...) {}
+        }
+
+        /// \brief Throws if the stream is closed.
+        void check_open() const {
+            if (!m_blob) throw sqlite_exception("BLOB stream is not open.");
+        }
+
+        /// \brief Throws if an SQLite call failed.
+        /// \param err Result code of the call.
+        void check(const int& err) const {
+            if (err == SQLITE_OK) return;
+            std::string err_msg = "SQLite error: ";
+            err_msg += std::to_string(err);
+            err_msg += ", ";
+            err_msg += sqlite3_errmsg(m_sqlite_db);
+            throw sqlite_exception(err_msg, err);
+        }
+    }; // BlobStream
+
+}; // namespace sqlite_containers
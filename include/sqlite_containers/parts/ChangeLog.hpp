@@ -0,0 +1,153 @@
+#pragma once
+
+/// \file ChangeLog.hpp
+/// \brief Declaration of the ChangeLog and MultiChangeLog classes that record changes to be applied as a delta.
+
+#include "Utils.hpp"
+#include <unordered_map>
+#include <unordered_set>
+
+namespace sqlite_containers {
+
+    /// \class ChangeLog
+    /// \brief Records inserts, overwrites and erases of key-value pairs for `KeyValueDB::apply_delta()`.
+    /// \tparam KeyT Type of the keys.
+    /// \tparam ValueT Type of the values.
+    /// \details Changes are coalesced per key: only the last change of each key is kept, so the size of the log
+    /// depends on the number of changed keys and not on the number of calls.
+    template<class KeyT, class ValueT>
+    class ChangeLog {
+    public:
+        using ValueMap = std::unordered_map<KeyT, ValueT, Hash<KeyT>, EqualTo<KeyT>>;   ///< Inserted or overwritten pairs.
+        using KeySet = std::unordered_set<KeyT, Hash<KeyT>, EqualTo<KeyT>>;             ///< Erased keys.
+
+        /// \brief Records an insert or an overwrite of a key.
+        /// \param key The key.
+        /// \param value The new value.
+        void insert(const KeyT& key, const ValueT& value) {
+            m_erased.erase(key);
+            m_upserts.insert_or_assign(key, value);
+        }
+
+        /// \brief Records an erase of a key.
+        /// \param key The key.
+        void erase(const KeyT& key) {
+            m_upserts.erase(key);
+            m_erased.insert(key);
+        }
+
+        /// \brief Forgets all recorded changes, typically after they have been applied.
+        void clear() noexcept {
+            m_upserts.clear();
+            m_erased.clear();
+        }
+
+        /// \brief Checks whether no changes are recorded.
+        bool empty() const noexcept {
+            return m_upserts.empty() && m_erased.empty();
+        }
+
+        /// \brief Returns the number of changed keys.
+        std::size_t size() const noexcept {
+            return m_upserts.size() + m_erased.size();
+        }
+
+        /// \brief Returns the inserted or overwritten pairs.
+        const ValueMap& upserts() const noexcept {
+            return m_upserts;
+        }
+
+        /// \brief Returns the erased keys.
+        const KeySet& erased() const noexcept {
+            return m_erased;
+        }
+
+    private:
+        ValueMap m_upserts; ///< Last value of every inserted or overwritten key.
+        KeySet   m_erased;  ///< Keys erased after their last insert.
+    }; // ChangeLog
+
+    /// \class MultiChangeLog
+    /// \brief Records changes of key-value pairs with counts for `KeyMultiValueDB::apply_delta()`.
+    /// \tparam KeyT Type of the keys.
+    /// \tparam ValueT Type of the values.
+    /// \details Changes are coalesced per pair: repeated inserts add up, and a count set or an erase replaces the
+    /// earlier changes of the pair. Erasing a key drops the recorded changes of all its values; values inserted
+    /// afterwards are applied after the key is removed.
+    template<class KeyT, class ValueT>
+    class MultiChangeLog {
+    public:
+
+        /// \brief Recorded change of one key-value pair.
+        struct PairChange {
+            bool        absolute = false;   ///< True if `count` replaces the stored count, false if it is added to it.
+            std::size_t count = 0;          ///< New count, or number of occurrences to add; an absolute 0 removes the pair.
+        };
+
+        using PairMap = std::unordered_map<ValueT, PairChange, Hash<ValueT>, EqualTo<ValueT>>; ///< Changes of the values of one key.
+
+        /// \brief Recorded changes of one key.
+        struct KeyChange {
+            bool    erase_all = false;  ///< True if all values of the key are removed before `values` are applied.
+            PairMap values;             ///< Changes of individual values.
+        };
+
+        using KeyMap = std::unordered_map<KeyT, KeyChange, Hash<KeyT>, EqualTo<KeyT>>; ///< Changes by key.
+
+        /// \brief Records one more occurrence of a key-value pair.
+        /// \param key The key.
+        /// \param value The value.
+        void insert(const KeyT& key, const ValueT& value) {
+            ++m_keys[key].values[value].count;
+        }
+
+        /// \brief Records a new count of a key-value pair.
+        /// \param key The key.
+        /// \param value The value.
+        /// \param value_count The count to set; 0 removes the pair.
+        void set_value_count(const KeyT& key, const ValueT& value, const std::size_t& value_count) {
+            PairChange& change = m_keys[key].values[value];
+            change.absolute = true;
+            change.count = value_count;
+        }
+
+        /// \brief Records the removal of a key-value pair.
+        /// \param key The key.
+        /// \param value The value.
+        void erase(const KeyT& key, const ValueT& value) {
+            set_value_count(key, value, 0);
+        }
+
+        /// \brief Records the removal of all values of a key.
+        /// \param key The key.
+        void erase(const KeyT& key) {
+            KeyChange& change = m_keys[key];
+            change.erase_all = true;
+            change.values.clear();
+        }
+
+        /// \brief Forgets all recorded changes, typically after they have been applied.
+        void clear() noexcept {
+            m_keys.clear();
+        }
+
+        /// \brief Checks whether no changes are recorded.
+        bool empty() const noexcept {
+            return m_keys.empty();
+        }
+
+        /// \brief Returns the number of changed keys.
+        std::size_t size() const noexcept {
+            return m_keys.size();
+        }
+
+        /// \brief Returns the recorded changes by key.
+        const KeyMap& changes() const noexcept {
+            return m_keys;
+        }
+
+    private:
+        KeyMap m_keys; ///< Changes by key.
+    }; // MultiChangeLog
+
+}; // namespace sqlite_containers
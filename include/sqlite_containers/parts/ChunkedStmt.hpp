@@ -0,0 +1,191 @@
+#pragma once
+
+/// \file ChunkedStmt.hpp
+/// \brief Declaration of the ChunkedStmt class for multi-row prepared statements.
+
+#include "SqliteStmt.hpp"
+#include <algorithm>
+#include <array>
+#include <string>
+
+/// \brief Upper bound for the number of rows bound to one multi-row statement.
+#ifndef SQLITE_CONTAINERS_BULK_MAX_ROWS
+#define SQLITE_CONTAINERS_BULK_MAX_ROWS 512
+#endif
+
+namespace sqlite_containers {
+
+    /// \class ChunkedStmt
+    /// \brief Multi-row prepared statement cached per chunk width.
+    /// \details Builds statements of the form `prefix row, row, ... suffix`, for example
+    /// `INSERT INTO t (key, value) VALUES (?, ?), (?, ?), ...;`, so that a whole chunk of elements is written
+    /// by a single VM run. Chunk widths are powers of two up to the largest width allowed by
+    /// `SQLITE_LIMIT_VARIABLE_NUMBER` and `SQLITE_CONTAINERS_BULK_MAX_ROWS`. Any number of rows is split into
+    /// at most one statement per width, so no more than a handful of statements are ever prepared.
+    /// Statements are prepared lazily on first use, with `SQLITE_PREPARE_PERSISTENT` since they are reused.
+    class ChunkedStmt {
+    public:
+
+        /// \brief Default constructor.
+        ChunkedStmt() = default;
+
+        /// \brief Initializes the statement template.
+        /// \param sqlite_db Pointer to the SQLite database.
+        /// \param prefix SQL text placed before the rows (e.g. `"REPLACE INTO t (key, value) VALUES "`).
+        /// \param row SQL text of one row (e.g. `"(?, ?)"`).
+        /// \param separator SQL text placed between rows (e.g. `", "`).
+        /// \param suffix SQL text placed after the rows (e.g. `";"`).
+        /// \param params_per_row Number of parameters in one row.
+        void init(
+                sqlite3 *sqlite_db,
+                const std::string &prefix,
+                const std::string &row,
+                const std::string &separator,
+                const std::string &suffix,
+                const int &params_per_row) {
+            m_sqlite_db = sqlite_db;
+            m_prefix = prefix;
+            m_row = row;
+            m_separator = separator;
+            m_suffix = suffix;
+            m_params_per_row = std::max(params_per_row, 1);
+            for (auto& stmt : m_stmts) {
+                stmt.finalize();
+            }
+
+            const int var_limit = sqlite3_limit(sqlite_db, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+            std::size_t max_rows = std::max(var_limit / m_params_per_row, 1);
+            max_rows = std::min<std::size_t>(max_rows, SQLITE_CONTAINERS_BULK_MAX_ROWS);
+            m_max_level = 0;
+            while ((std::size_t(1) << (m_max_level + 1)) <= max_rows) {
+                ++m_max_level;
+            }
+        }
+
+        /// \brief Returns the largest number of rows bound to one statement.
+        std::size_t max_rows() const noexcept {
+            return std::size_t(1) << m_max_level;
+        }
+
+        /// \brief Binds and runs `count` rows in chunks.
+        /// \tparam IteratorT Input iterator over the rows.
+        /// \tparam BindFunc Callable `void(SqliteStmt&, int first_param_index, const Row&)` that binds one row.
+        /// \tparam RunFunc Callable `void(SqliteStmt&)` that runs a fully bound statement.
+        /// \param first Iterator to the first row.
+        /// \param count Number of rows to process.
+        /// \param bind_row Function that binds one row.
+        /// \param run Function that runs one chunk.
+        /// \return Iterator past the last processed row.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<typename IteratorT, typename BindFunc, typename RunFunc>
+        IteratorT run(IteratorT first, std::size_t count, BindFunc&& bind_row, RunFunc&& run) {
+            while (count > 0) {
+                size_t level = m_max_level;
+                while ((std::size_t(1) << level) > count) {
+                    --level;
+                }
+                const std::size_t width = std::size_t(1) << level;
+                SqliteStmt& stmt = get_stmt(level);
+                try {
+                    int index = 1;
+                    for (std::size_t i = 0; i < width; ++i, ++first) {
+                        bind_row(stmt, index, *first);
+                        index += m_params_per_row;
+                    }
+                    run(stmt);
+                    stmt.reset();
+                    stmt.clear_bindings();
+                } catch (...) {
+                    sqlite3_reset(stmt.get_stmt());
+                    sqlite3_clear_bindings(stmt.get_stmt());
+                    throw;
+                }
+                count -= width;
+            }
+            return first;
+        }
+
+        /// \brief Binds and executes `count` rows in chunks.
+        /// \tparam IteratorT Input iterator over the rows.
+        /// \tparam BindFunc Callable `void(SqliteStmt&, int first_param_index, const Row&)` that binds one row.
+        /// \param first Iterator to the first row.
+        /// \param count Number of rows to write.
+        /// \param bind_row Function that binds one row.
+        /// \return Iterator past the last written row.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<typename IteratorT, typename BindFunc>
+        IteratorT execute(IteratorT first, std::size_t count, BindFunc&& bind_row) {
+            return run(first, count, std::forward<BindFunc>(bind_row), [](SqliteStmt& stmt) {
+                stmt.execute();
+            });
+        }
+
+        /// \brief Binds `count` rows in chunks and steps through the result rows of each chunk.
+        /// \tparam IteratorT Input iterator over the rows.
+        /// \tparam BindFunc Callable `void(SqliteStmt&, int first_param_index, const Row&)` that binds one row.
+        /// \tparam RowFunc Callable `void(SqliteStmt&)` called for every result row.
+        /// \param first Iterator to the first row.
+        /// \param count Number of rows to bind.
+        /// \param bind_row Function that binds one row.
+        /// \param on_row Function that reads one result row.
+        /// \return Iterator past the last bound row.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        template<typename IteratorT, typename BindFunc, typename RowFunc>
+        IteratorT query(IteratorT first, std::size_t count, BindFunc&& bind_row, RowFunc&& on_row) {
+            return run(first, count, std::forward<BindFunc>(bind_row), [this, &on_row](SqliteStmt& stmt) {
+                bool has_rows = false;
+                BusyRetry busy_retry(m_sqlite_db);
+                int err;
+                for (;;) {
+                    while ((err = stmt.step()) == SQLITE_ROW) {
+                        has_rows = true;
+                        on_row(stmt);
+                    }
+                    if (err == SQLITE_DONE) return;
+                    if (err == SQLITE_BUSY && !has_rows) {
+                        // Nothing has been read from this chunk yet, so it can be restarted
+                        sqlite3_reset(stmt.get_stmt());
+                        busy_retry.wait();
+                        continue;
+                    }
+                    std::string err_msg = "SQLite error: ";
+                    err_msg += std::to_string(err);
+                    err_msg += ", ";
+                    err_msg += sqlite3_errmsg(m_sqlite_db);
+                    throw sqlite_exception(err_msg, err);
+                }
+            });
+        }
+
+    private:
+        sqlite3*    m_sqlite_db = nullptr;  ///< Pointer to the SQLite database.
+        std::string m_prefix;               ///< SQL text placed before the rows.
+        std::string m_row;                  ///< SQL text of one row.
+        std::string m_separator;            ///< SQL text placed between rows.
+        std::string m_suffix;               ///< SQL text placed after the rows.
+        int         m_params_per_row = 1;   ///< Number of parameters in one row.
+        std::size_t m_max_level = 0;        ///< Log2 of the largest chunk width.
+        std::array<SqliteStmt, 32> m_stmts; ///< Prepared statements indexed by log2 of the width.
+
+        /// \brief Returns the statement for a chunk of `2^level` rows, preparing it on first use.
+        /// \param level Log2 of the chunk width.
+        /// \return Reference to the prepared statement.
+        /// \throws sqlite_exception if the query preparation fails.
+        SqliteStmt& get_stmt(const std::size_t &level) {
+            auto& stmt = m_stmts[level];
+            if (stmt.is_prepared()) return stmt;
+            const std::size_t width = std::size_t(1) << level;
+            std::string query;
+            query.reserve(m_prefix.size() + width * (m_row.size() + m_separator.size()) + m_suffix.size());
+            query += m_prefix;
+            for (std::size_t i = 0; i < width; ++i) {
+                if (i) query += m_separator;
+                query += m_row;
+            }
+            query += m_suffix;
+            stmt.init(m_sqlite_db, query, true);
+            return stmt;
+        }
+    }; // ChunkedStmt
+
+}; // namespace sqlite_containers
@@ -0,0 +1,322 @@
+#pragma once
+
+/// \file Codec.hpp
+/// \brief Declaration of the Codec traits that map C++ types to SQLite columns and parameters.
+
+#include "Utils.hpp"
+#include <array>
+
+namespace sqlite_containers {
+
+    /// \brief Borrowed view of a BLOB column or parameter.
+    /// \details When extracted from a column, the view is valid until the statement is stepped, reset or finalized.
+    /// When bound to a parameter, the viewed bytes must stay alive until the statement is reset.
+    struct BlobView {
+        const uint8_t* data = nullptr; ///< Pointer to the first byte.
+        std::size_t    size = 0;       ///< Number of bytes.
+
+        const uint8_t* begin() const noexcept { return data; }
+        const uint8_t* end() const noexcept { return data + size; }
+        bool empty() const noexcept { return size == 0; }
+    };
+
+    /// \brief Binds bytes as a BLOB parameter without copying them.
+    /// An empty range is bound as a zero-length BLOB rather than NULL.
+    /// \param stmt Prepared statement.
+    /// \param index Index of the parameter.
+    /// \param data Pointer to the first byte.
+    /// \param size Number of bytes.
+    /// \return SQLite result code.
+    inline int bind_blob(sqlite3_stmt* stmt, const int& index, const void* data, const std::size_t& size) {
+        if (size == 0) return sqlite3_bind_zeroblob(stmt, index, 0);
+        return sqlite3_bind_blob(stmt, index, data, static_cast<int>(size), SQLITE_STATIC);
+    }
+
+    /// \brief Returns the bytes of a BLOB column and checks their number.
+    /// \param stmt Prepared statement.
+    /// \param index Index of the column.
+    /// \param size Expected number of bytes.
+    /// \return Pointer to the bytes of the column.
+    /// \throws sqlite_exception if the column has a different size.
+    inline const void* extract_blob(sqlite3_stmt* stmt, const int& index, const std::size_t& size) {
+        const void* blob = sqlite3_column_blob(stmt, index);
+        if (static_cast<std::size_t>(sqlite3_column_bytes(stmt, index)) != size) {
+            throw sqlite_exception("Blob size does not match POD size.");
+        }
+        return blob;
+    }
+
+    /// \brief Reads a column written by earlier versions as the object representation of a value in a BLOB.
+    /// \param stmt Prepared statement.
+    /// \param index Index of the column.
+    /// \param value Value receiving the bytes.
+    /// \return True if the column is a BLOB and was read, false if it holds another type.
+    /// \throws sqlite_exception if the BLOB has a different size.
+    template<typename T>
+    inline bool extract_legacy_blob(sqlite3_stmt* stmt, const int& index, T& value) {
+        if (sqlite3_column_type(stmt, index) != SQLITE_BLOB) return false;
+        std::memcpy(&value, extract_blob(stmt, index, sizeof(T)), sizeof(T));
+        return true;
+    }
+
+    /// \brief Customization point describing how a type is stored in an SQLite column.
+    /// \details A codec provides:
+    /// - `affinity`: column type used in `CREATE TABLE` ("INTEGER", "REAL", "TEXT" or "BLOB");
+    /// - `fixed_size`: number of bytes of every encoded value, or 0 if it depends on the value;
+    /// - `bind(stmt, index, value)`: binds the value to a parameter and returns the SQLite result code;
+    /// - `extract(stmt, index, value)`: reads a column into an existing object.
+    ///
+    /// The primary template stores trivially copyable types as their object representation in a BLOB of
+    /// `sizeof(T)` bytes. Specialize it to store other types, or to use a more compact encoding:
+    /// \code
+    /// template<>
+    /// struct sqlite_containers::Codec<Price> {
+    ///     static constexpr const char* affinity = "INTEGER";
+    ///     static constexpr std::size_t fixed_size = 0;
+    ///     static int bind(sqlite3_stmt* stmt, int index, const Price& value) {
+    ///         return sqlite3_bind_int64(stmt, index, value.ticks);
+    ///     }
+    ///     static void extract(sqlite3_stmt* stmt, int index, Price& value) {
+    ///         value.ticks = sqlite3_column_int64(stmt, index);
+    ///     }
+    /// };
+    /// \endcode
+    /// Bound text and BLOBs are not copied by SQLite (`SQLITE_STATIC`); a codec that encodes into a temporary
+    /// buffer must bind it with `SQLITE_TRANSIENT`.
+    /// \tparam T The type to store.
+    template<typename T, typename Enable = void>
+    struct Codec {
+        static_assert(std::is_trivially_copyable<T>::value,
+            "sqlite_containers::Codec<T> must be specialized for types that are not trivially copyable.");
+
+        static constexpr const char* affinity = "BLOB";
+        static constexpr std::size_t fixed_size = sizeof(T);
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const T& value) {
+            return sqlite3_bind_blob(stmt, index, &value, sizeof(T), SQLITE_STATIC);
+        }
+
+        static void extract(sqlite3_stmt* stmt, const int& index, T& value) {
+            std::memcpy(&value, extract_blob(stmt, index, sizeof(T)), sizeof(T));
+        }
+    };
+
+    /// \brief Codec for integral types, stored as INTEGER.
+    template<typename T>
+    struct Codec<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+        static constexpr const char* affinity = "INTEGER";
+        static constexpr std::size_t fixed_size = sizeof(T);
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const T& value) {
+            return sqlite3_bind_int64(stmt, index, static_cast<int64_t>(value));
+        }
+
+        static void extract(sqlite3_stmt* stmt, const int& index, T& value) {
+            value = static_cast<T>(sqlite3_column_int64(stmt, index));
+        }
+    };
+
+    /// \brief Codec for floating-point types, stored as REAL.
+    template<typename T>
+    struct Codec<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+        static constexpr const char* affinity = "REAL";
+        static constexpr std::size_t fixed_size = sizeof(T);
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const T& value) {
+            return sqlite3_bind_double(stmt, index, static_cast<double>(value));
+        }
+
+        static void extract(sqlite3_stmt* stmt, const int& index, T& value) {
+            value = static_cast<T>(sqlite3_column_double(stmt, index));
+        }
+    };
+
+    /// \brief Codec for enumerations, stored as INTEGER through their underlying type.
+    template<typename T>
+    struct Codec<T, typename std::enable_if<std::is_enum<T>::value>::type> {
+        using UnderlyingT = typename std::underlying_type<T>::type;
+
+        static constexpr const char* affinity = "INTEGER";
+        static constexpr std::size_t fixed_size = sizeof(T);
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const T& value) {
+            return sqlite3_bind_int64(stmt, index, static_cast<int64_t>(static_cast<UnderlyingT>(value)));
+        }
+
+        static void extract(sqlite3_stmt* stmt, const int& index, T& value) {
+            value = static_cast<T>(static_cast<UnderlyingT>(sqlite3_column_int64(stmt, index)));
+        }
+    };
+
+    /// \brief Codec for strings, stored as TEXT.
+    template<>
+    struct Codec<std::string> {
+        static constexpr const char* affinity = "TEXT";
+        static constexpr std::size_t fixed_size = 0;
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const std::string& value) {
+            return sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+        }
+
+        /// \brief Reads a TEXT column, reusing the storage of the string.
+        static void extract(sqlite3_stmt* stmt, const int& index, std::string& value) {
+            const unsigned char *text = sqlite3_column_text(stmt, index);
+            if (text) {
+                value.assign(reinterpret_cast<const char*>(text), sqlite3_column_bytes(stmt, index));
+            } else {
+                value.clear();
+            }
+        }
+    };
+
+    /// \brief Codec for string views, stored as TEXT without copying.
+    /// A bound view must stay alive until the statement is reset; an extracted view is valid until the
+    /// statement is stepped, reset or finalized.
+    template<>
+    struct Codec<std::string_view> {
+        static constexpr const char* affinity = "TEXT";
+        static constexpr std::size_t fixed_size = 0;
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const std::string_view& value) {
+            return sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+        }
+
+        static void extract(sqlite3_stmt* stmt, const int& index, std::string_view& value) {
+            const unsigned char *text = sqlite3_column_text(stmt, index);
+            if (text) {
+                value = std::string_view(reinterpret_cast<const char*>(text), sqlite3_column_bytes(stmt, index));
+            } else {
+                value = std::string_view();
+            }
+        }
+    };
+
+    /// \brief Codec for BLOB views, stored as BLOB without copying.
+    /// A bound view must stay alive until the statement is reset; an extracted view is valid until the
+    /// statement is stepped, reset or finalized.
+    template<>
+    struct Codec<BlobView> {
+        static constexpr const char* affinity = "BLOB";
+        static constexpr std::size_t fixed_size = 0;
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const BlobView& value) {
+            return bind_blob(stmt, index, value.data, value.size);
+        }
+
+        static void extract(sqlite3_stmt* stmt, const int& index, BlobView& value) {
+            value.data = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, index));
+            value.size = static_cast<std::size_t>(sqlite3_column_bytes(stmt, index));
+        }
+    };
+
+    /// \brief Codec for vectors of trivially copyable elements, stored as BLOB.
+    template<typename T>
+    struct Codec<std::vector<T>, typename std::enable_if<
+            std::is_trivially_copyable<T>::value &&
+            !std::is_same<T, bool>::value>::type> {
+        static constexpr const char* affinity = "BLOB";
+        static constexpr std::size_t fixed_size = 0;
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const std::vector<T>& value) {
+            return bind_blob(stmt, index, value.data(), value.size() * sizeof(T));
+        }
+
+        /// \brief Reads a BLOB column, reusing the storage of the vector.
+        /// \throws sqlite_exception if the size of the BLOB is not a multiple of the element size.
+        static void extract(sqlite3_stmt* stmt, const int& index, std::vector<T>& value) {
+            const void* blob = sqlite3_column_blob(stmt, index);
+            const std::size_t blob_size = static_cast<std::size_t>(sqlite3_column_bytes(stmt, index));
+            if (blob_size % sizeof(T) != 0) {
+                throw sqlite_exception("Blob size is not a multiple of the element size.");
+            }
+            value.resize(blob_size / sizeof(T));
+            if (blob_size) std::memcpy(value.data(), blob, blob_size);
+        }
+    };
+
+    /// \brief Codec for arrays of trivially copyable elements, stored as a BLOB of fixed size.
+    template<typename T, std::size_t N>
+    struct Codec<std::array<T, N>, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+        static constexpr const char* affinity = "BLOB";
+        static constexpr std::size_t fixed_size = N * sizeof(T);
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const std::array<T, N>& value) {
+            return bind_blob(stmt, index, value.data(), fixed_size);
+        }
+
+        static void extract(sqlite3_stmt* stmt, const int& index, std::array<T, N>& value) {
+            if (fixed_size) std::memcpy(value.data(), extract_blob(stmt, index, fixed_size), fixed_size);
+        }
+    };
+
+    /// \brief Codec for durations, stored as their tick count.
+    /// Durations and time points written by earlier versions as BLOBs of their object representation are still read.
+    template<typename Rep, typename Period>
+    struct Codec<std::chrono::duration<Rep, Period>> {
+        static constexpr const char* affinity = Codec<Rep>::affinity;
+        static constexpr std::size_t fixed_size = Codec<Rep>::fixed_size;
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const std::chrono::duration<Rep, Period>& value) {
+            return Codec<Rep>::bind(stmt, index, value.count());
+        }
+
+        static void extract(sqlite3_stmt* stmt, const int& index, std::chrono::duration<Rep, Period>& value) {
+            if (extract_legacy_blob(stmt, index, value)) return;
+            Rep count{};
+            Codec<Rep>::extract(stmt, index, count);
+            value = std::chrono::duration<Rep, Period>(count);
+        }
+    };
+
+    /// \brief Codec for time points, stored as the tick count since the epoch of the clock.
+    template<typename Clock, typename Duration>
+    struct Codec<std::chrono::time_point<Clock, Duration>> {
+        static constexpr const char* affinity = Codec<Duration>::affinity;
+        static constexpr std::size_t fixed_size = Codec<Duration>::fixed_size;
+
+        static int bind(sqlite3_stmt* stmt, const int& index, const std::chrono::time_point<Clock, Duration>& value) {
+            return Codec<Duration>::bind(stmt, index, value.time_since_epoch());
+        }
+
+        static void extract(sqlite3_stmt* stmt, const int& index, std::chrono::time_point<Clock, Duration>& value) {
+            Duration duration{};
+            Codec<Duration>::extract(stmt, index, duration);
+            value = std::chrono::time_point<Clock, Duration>(duration);
+        }
+    };
+
+//------------------------------------------------------------------------------
+
+    /// \brief Returns the SQLite column type of a type.
+    /// \tparam T The type of the column.
+    /// \return The column type declared by `Codec<T>`.
+    template<typename T>
+    inline std::string get_sqlite_type() {
+        return Codec<T>::affinity;
+    }
+
+    /// \brief Estimates the number of bytes a value occupies in the database.
+    /// \tparam T The type of the value.
+    /// \param value The value to measure.
+    /// \return The size of the value in bytes.
+    template<typename T>
+    inline std::size_t get_byte_size(const T& value) {
+        (void)value;
+        return Codec<T>::fixed_size ? Codec<T>::fixed_size : sizeof(T);
+    }
+
+    inline std::size_t get_byte_size(const std::string& value) {
+        return value.size();
+    }
+
+    template<typename T>
+    inline std::size_t get_byte_size(const std::vector<T>& value) {
+        return value.size() * sizeof(T);
+    }
+
+    template<typename T>
+    inline std::size_t get_byte_size(const std::deque<T>& value) {
+        return value.size() * sizeof(T);
+    }
+
+}; // namespace sqlite_containers
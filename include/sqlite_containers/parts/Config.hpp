@@ -4,6 +4,7 @@
 /// \brief Contains the declaration of Config class for SQLite database configuration.
 
 #include "Enums.hpp"
+#include "RetryPolicy.hpp"
 
 namespace sqlite_containers {
 
@@ -18,15 +19,33 @@ namespace sqlite_containers {
         bool use_async = false;                 ///< Whether to use asynchronous write.
         int user_version = -1;                  ///< User-defined version number for the database schema.
         int busy_timeout = 1000;                ///< Timeout in milliseconds for busy handler.
+        RetryPolicy busy_retry;                 ///< Backoff of the busy handler and of the restarts of busy statements.
         int page_size = 4096;                   ///< SQLite page size.
         int cache_size = 2000;                  ///< SQLite cache size (in pages).
+        bool cache_spill = true;                ///< Whether dirty pages may be written to the file before the transaction commits.
+        int64_t mmap_size = 0;                  ///< Bytes of the file read through memory-mapped I/O (0 disables it).
         int analysis_limit = 1000;              ///< Maximum number of rows to analyze.
         int wal_autocheckpoint = 1000;          ///< WAL auto-checkpoint threshold.
+        std::size_t async_queue_size = 4096;    ///< Maximum number of pending asynchronous writes before callers block.
+        std::size_t async_batch_size = 256;     ///< Maximum number of asynchronous writes committed in one transaction.
+        std::size_t async_pipeline_size = 64;   ///< Maximum number of queued `async_*` calls run together; consecutive single-row writes among them share one transaction.
+        bool group_commit = false;              ///< Whether consecutive single-row writes share one transaction.
+        std::size_t group_commit_rows = 1000;   ///< Number of rows that triggers a group commit.
+        std::size_t group_commit_bytes = 1 << 20; ///< Number of written bytes that triggers a group commit.
+        int group_commit_latency_ms = 10;       ///< Maximum time in milliseconds a write waits for its group commit.
+        std::size_t read_connections = 0;       ///< Number of read-only connections serving reads in WAL mode (0 disables them).
+        std::size_t read_cache_bytes = 0;       ///< Memory budget in bytes of the cache in front of KeyValueDB::find() (0 disables it).
+        bool write_back = false;                ///< Whether KeyValueDB keeps all pairs in memory and writes changes back in batches.
+        int write_back_interval_ms = 1000;      ///< Interval in milliseconds between background write-back flushes.
+        int value_compression_level = 0;        ///< zlib level (1-9) compressing the values of KeyValueDB, 0 disables it; requires `SQLITE_CONTAINERS_USE_ZLIB`.
+        bool dedup_values = false;              ///< Whether KeyValueDB stores equal values once, addressed by their SHA-256 digest.
         JournalMode     journal_mode        = JournalMode::DELETE_MODE;     ///< SQLite journal mode.
         SynchronousMode synchronous         = SynchronousMode::FULL;        ///< SQLite synchronous mode.
         LockingMode     locking_mode        = LockingMode::NORMAL;          ///< SQLite locking mode.
         AutoVacuumMode  auto_vacuum_mode    = AutoVacuumMode::NONE;         ///< SQLite auto-vacuum mode.
         TransactionMode default_txn_mode    = TransactionMode::IMMEDIATE;   ///< Default transaction mode.
+        TempStore       temp_store          = TempStore::MEMORY;            ///< Storage of temporary tables and indices.
+        TableLayout     table_layout        = TableLayout::ROWID;           ///< Layout of newly created tables; existing tables keep theirs.
         /// \brief Default constructor.
         Config() = default;
     };
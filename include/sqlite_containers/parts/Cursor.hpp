@@ -0,0 +1,150 @@
+#pragma once
+
+/// \file Cursor.hpp
+/// \brief Declaration of the Cursor class for streaming rows of a prepared query.
+
+#include "SqliteStmt.hpp"
+#include <iterator>
+#include <mutex>
+
+namespace sqlite_containers {
+
+    /// \class Cursor
+    /// \brief Single-pass range over the rows of a prepared `SELECT` statement.
+    /// \tparam RowT Type of a decoded row.
+    /// \details Rows are stepped and decoded one at a time, so memory use does not depend on the size of the table
+    /// and the first row is available as soon as SQLite produces it. The cursor owns the lock of the database
+    /// connection until it is destroyed, so other threads using the same container wait for it, and the owning
+    /// thread must not call other methods of the container while the cursor is alive.
+    template<class RowT>
+    class Cursor {
+    public:
+        using DecodeFunc = RowT (*)(SqliteStmt&); ///< Function that decodes the current row of the statement.
+
+        /// \class iterator
+        /// \brief Input iterator over the rows of the cursor.
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type        = RowT;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const RowT*;
+            using reference         = const RowT&;
+
+            iterator() = default;
+
+            explicit iterator(Cursor* cursor) : m_cursor(cursor) {}
+
+            reference operator*() const {
+                return m_cursor->m_row;
+            }
+
+            pointer operator->() const {
+                return &m_cursor->m_row;
+            }
+
+            /// \brief Advances to the next row.
+            /// \throws sqlite_exception if an SQLite error occurs.
+            iterator& operator++() {
+                if (!m_cursor->next()) m_cursor = nullptr;
+                return *this;
+            }
+
+            bool operator==(const iterator& other) const noexcept {
+                return m_cursor == other.m_cursor;
+            }
+
+            bool operator!=(const iterator& other) const noexcept {
+                return m_cursor != other.m_cursor;
+            }
+
+        private:
+            Cursor* m_cursor = nullptr;
+        };
+
+        /// \brief Constructs a cursor over a prepared statement.
+        /// \param locker Lock of the database connection, held for the lifetime of the cursor.
+        /// \param sqlite_db Pointer to the SQLite database.
+        /// \param stmt Prepared statement with all parameters bound.
+        /// \param decode Function that decodes the current row.
+        Cursor(std::unique_lock<std::mutex> locker, sqlite3* sqlite_db, SqliteStmt& stmt, DecodeFunc decode) :
+            m_locker(std::move(locker)), m_sqlite_db(sqlite_db), m_stmt(&stmt), m_decode(decode) {}
+
+        Cursor(const Cursor&) = delete;
+        Cursor& operator=(const Cursor&) = delete;
+
+        /// \brief Move constructor.
+        Cursor(Cursor&& other) noexcept :
+                m_locker(std::move(other.m_locker)),
+                m_sqlite_db(other.m_sqlite_db),
+                m_stmt(other.m_stmt),
+                m_decode(other.m_decode),
+                m_row(std::move(other.m_row)),
+                m_started(other.m_started),
+                m_done(other.m_done) {
+            other.m_stmt = nullptr;
+        }
+
+        /// \brief Destructor. Resets the statement and releases the connection.
+        ~Cursor() {
+            if (!m_stmt) return;
+            sqlite3_reset(m_stmt->get_stmt());
+            sqlite3_clear_bindings(m_stmt->get_stmt());
+        }
+
+        /// \brief Returns an iterator to the current row, stepping to the first row on the first call.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        iterator begin() {
+            if (!m_started) next();
+            return iterator(m_done ? nullptr : this);
+        }
+
+        /// \brief Returns the past-the-end iterator.
+        iterator end() noexcept {
+            return iterator();
+        }
+
+        /// \brief Steps to the next row.
+        /// \return True if a row was decoded, false once all rows have been read.
+        /// \throws sqlite_exception if an SQLite error occurs.
+        bool next() {
+            if (m_done) return false;
+            BusyRetry busy_retry(m_sqlite_db);
+            int err;
+            for (;;) {
+                err = m_stmt->step();
+                if (err == SQLITE_ROW) {
+                    m_started = true;
+                    m_row = m_decode(*m_stmt);
+                    return true;
+                }
+                if (err == SQLITE_BUSY && !m_started) {
+                    // Nothing has been read yet, so the query can be restarted
+                    sqlite3_reset(m_stmt->get_stmt());
+                    busy_retry.wait();
+                    continue;
+                }
+                break;
+            }
+            m_started = true;
+            m_done = true;
+            sqlite3_reset(m_stmt->get_stmt());
+            if (err == SQLITE_DONE) return false;
+            std::string err_msg = "SQLite error: ";
+            err_msg += std::to_string(err);
+            err_msg += ", ";
+            err_msg += sqlite3_errmsg(m_sqlite_db);
+            throw sqlite_exception(err_msg, err);
+        }
+
+    private:
+        std::unique_lock<std::mutex> m_locker;  ///< Lock of the database connection.
+        sqlite3*    m_sqlite_db = nullptr;      ///< Pointer to the SQLite database.
+        SqliteStmt* m_stmt = nullptr;           ///< Statement producing the rows.
+        DecodeFunc  m_decode = nullptr;         ///< Function that decodes a row.
+        RowT        m_row{};                    ///< The current row.
+        bool        m_started = false;          ///< True once the first step has been made.
+        bool        m_done = false;             ///< True once all rows have been read.
+    }; // Cursor
+
+}; // namespace sqlite_containers
@@ -0,0 +1,367 @@
+#pragma once
+
+/// \file Database.hpp
+/// \brief Declaration of the Database class, a connection shared by several containers.
+
+#include "Config.hpp"
+#include "Utils.hpp"
+#include "SqliteStmt.hpp"
+#include "StmtCache.hpp"
+#include "MemoryConfig.hpp"
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace sqlite_containers {
+
+    class BaseDB;
+
+    /// \brief Creates the parent directories of a file.
+    /// \param path Path to the file.
+    /// \throws sqlite_exception If the directories cannot be created.
+    inline void create_parent_directories(const std::string &path) {
+        std::filesystem::path parent_dir = std::filesystem::path(path).parent_path();
+        if (parent_dir.empty()) return;
+        if (!std::filesystem::exists(parent_dir)) {
+            if (!std::filesystem::create_directories(parent_dir)) {
+                throw sqlite_exception("Failed to create directories for path: " + parent_dir.string());
+            }
+        }
+    }
+
+    /// \brief Creates the parent directories of a database file.
+    /// \param config Configuration settings, including the path to the database file.
+    /// \throws sqlite_exception If the directories cannot be created.
+    inline void create_database_directories(const Config &config) {
+        if (config.in_memory) return;
+        create_parent_directories(config.db_path);
+    }
+
+    /// \brief Opens a database connection with the specified configuration.
+    /// Installs the busy handler of `Config::busy_retry`, which is removed with clear_busy_policy() before the
+    /// connection is closed.
+    /// \param config Configuration settings.
+    /// \return The open connection.
+    /// \throws sqlite_exception if the database fails to open.
+    inline sqlite3* open_database(const Config &config) {
+        int flags = 0;
+        flags |= config.read_only ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+        flags |= config.use_uri ? SQLITE_OPEN_URI : 0;
+        flags |= config.in_memory ? SQLITE_OPEN_MEMORY : 0;
+        flags |= SQLITE_OPEN_FULLMUTEX;
+        sqlite3* sqlite_db = nullptr;
+        int err = 0;
+        const char* db_name = config.in_memory ? ":memory:" : config.db_path.c_str();
+        if ((err = sqlite3_open_v2(db_name, &sqlite_db, flags, nullptr)) != SQLITE_OK) {
+            std::string error_message = "Cannot open database: ";
+            error_message += sqlite3_errmsg(sqlite_db);
+            error_message += " (Error code: ";
+            error_message += std::to_string(err);
+            error_message += ")";
+            sqlite3_close_v2(sqlite_db);
+            throw sqlite_exception(error_message);
+        }
+        try {
+            set_busy_policy(sqlite_db, config.busy_retry, config.busy_timeout);
+        } catch (...) {
+            sqlite3_close_v2(sqlite_db);
+            throw;
+        }
+        return sqlite_db;
+    }
+
+    /// \brief Sets the connection parameters of the configuration.
+    /// Sets page size, cache size, memory-mapped I/O, journal mode, and the other PRAGMA settings.
+    /// \param sqlite_db The connection.
+    /// \param config Configuration settings.
+    /// \throws sqlite_exception if a PRAGMA fails.
+    inline void init_database(sqlite3* sqlite_db, const Config &config) {
+        execute(sqlite_db, "PRAGMA page_size = " + std::to_string(config.page_size) + ";");
+        execute(sqlite_db, "PRAGMA cache_size = " + std::to_string(config.cache_size) + ";");
+        execute(sqlite_db, std::string("PRAGMA cache_spill = ") + (config.cache_spill ? "ON" : "OFF") + ";");
+        execute(sqlite_db, "PRAGMA mmap_size = " + std::to_string(config.mmap_size) + ";");
+        execute(sqlite_db, "PRAGMA temp_store = " + to_string(config.temp_store) + ";");
+        execute(sqlite_db, "PRAGMA analysis_limit = " + std::to_string(config.analysis_limit) + ";");
+        execute(sqlite_db, "PRAGMA wal_autocheckpoint = " + std::to_string(config.wal_autocheckpoint) + ";");
+        execute(sqlite_db, "PRAGMA journal_mode = " + to_string(config.journal_mode) + ";");
+        execute(sqlite_db, "PRAGMA synchronous = " + to_string(config.synchronous) + ";");
+        execute(sqlite_db, "PRAGMA locking_mode = " + to_string(config.locking_mode) + ";");
+        execute(sqlite_db, "PRAGMA auto_vacuum = " + to_string(config.auto_vacuum_mode) + ";");
+        if (config.user_version > 0) {
+            execute(sqlite_db, "PRAGMA user_version = " + std::to_string(config.user_version) + ";");
+        }
+    }
+
+    /// \class Database
+    /// \brief One connection to a database file, shared by the containers attached to it.
+    /// \details Containers constructed with a Database (e.g. `KeyValueDB(database, config)`) use its connection
+    /// and its lock instead of opening their own: the PRAGMA sequence runs once, all tables share one page cache,
+    /// and the containers no longer wait for each other on the write lock of the file. A transaction opened by
+    /// begin() covers the writes of all attached containers and is committed at once. Only the table settings
+    /// of the container configuration are used (table name, layout, caches, write-back, read connections);
+    /// the connection settings come from the configuration of the Database. Attached containers must be
+    /// disconnected before the Database, and the Database must outlive them.
+    class Database {
+    public:
+
+        /// \brief Default constructor. Call set_config() before connect().
+        Database() = default;
+
+        /// \brief Constructor with configuration.
+        /// \param config Connection settings; the table settings are ignored.
+        explicit Database(const Config& config) : m_config(config) {}
+
+        Database(const Database&) = delete;
+        Database& operator=(const Database&) = delete;
+
+        /// \brief Destructor. Closes the connection.
+        ~Database() {
+            if (!m_sqlite_db) return;
+            sqlite3_rollback_hook(m_sqlite_db, nullptr, nullptr);
+            m_stmt_cache.clear();
+            clear_busy_policy(m_sqlite_db);
+            sqlite3_close_v2(m_sqlite_db);
+        }
+
+        /// \brief Sets the configuration used by the next connect().
+        /// \param config Connection settings.
+        void set_config(const Config& config) {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            m_config = config;
+        }
+
+        /// \brief Gets the configuration of the database.
+        Config get_config() const {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            return m_config;
+        }
+
+        /// \brief Opens the connection and applies the connection settings.
+        /// Does nothing if the connection is already open.
+        /// \throws sqlite_exception if the database fails to open.
+        void connect() {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            if (m_sqlite_db) return;
+            try {
+                create_database_directories(m_config);
+                m_sqlite_db = open_database(m_config);
+                init_database(m_sqlite_db, m_config);
+                for (size_t i = 0; i < m_stmt_begin.size(); ++i) {
+                    m_stmt_begin[i].defer(m_sqlite_db, "BEGIN " + to_string(static_cast<TransactionMode>(i)) + " TRANSACTION", true);
+                }
+                m_stmt_commit.init(m_sqlite_db, "COMMIT", true);
+                m_stmt_rollback.init(m_sqlite_db, "ROLLBACK", true);
+                m_stmt_cache.init(m_sqlite_db);
+            } catch (...) {
+                m_stmt_cache.clear();
+                clear_busy_policy(m_sqlite_db);
+                if (m_sqlite_db) sqlite3_close_v2(m_sqlite_db);
+                m_sqlite_db = nullptr;
+                throw;
+            }
+            m_user_txn = false;
+            sqlite3_rollback_hook(m_sqlite_db, [](void* ptr) {
+                Database* database = static_cast<Database*>(ptr);
+                database->m_user_txn = false;
+                for (auto& attachment : database->m_attachments) {
+                    attachment.rollback();
+                }
+            }, this);
+        }
+
+        /// \brief Opens the connection with the given configuration.
+        /// \param config Connection settings.
+        /// \throws sqlite_exception if the database fails to open.
+        void connect(const Config& config) {
+            set_config(config);
+            connect();
+        }
+
+        /// \brief Returns the time the connection has spent waiting for a busy database.
+        /// \return Counters of the waits since the connection was opened.
+        BusyStats busy_stats() const {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            return get_busy_stats(m_sqlite_db);
+        }
+
+        /// \brief Closes the connection.
+        /// \throws sqlite_exception if containers attached to the database are still connected.
+        void disconnect() {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            if (!m_sqlite_db) return;
+            if (!m_attachments.empty()) {
+                throw sqlite_exception("Containers attached to the database are still connected.");
+            }
+            sqlite3_rollback_hook(m_sqlite_db, nullptr, nullptr);
+            m_stmt_cache.clear();
+            clear_busy_policy(m_sqlite_db);
+            sqlite3_close_v2(m_sqlite_db);
+            m_sqlite_db = nullptr;
+        }
+
+        /// \brief Checks if the connection is open.
+        bool is_connected() const {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            return m_sqlite_db != nullptr;
+        }
+
+        /// \brief Begins a transaction covering all attached containers.
+        /// Queued asynchronous writes of the containers are written first. Until the transaction is committed or
+        /// rolled back, reads of the containers use the shared connection so that they see its writes.
+        /// \param mode Transaction mode (default: DEFERRED).
+        /// \throws sqlite_exception if the transaction fails.
+        void begin(const TransactionMode &mode = TransactionMode::DEFERRED) {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_begin(mode);
+        }
+
+        /// \brief Commits the current transaction for all attached containers with one commit.
+        /// \throws sqlite_exception if the commit fails.
+        void commit() {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_commit();
+        }
+
+        /// \brief Rolls back the current transaction of all attached containers.
+        /// \throws sqlite_exception if the rollback fails.
+        void rollback() {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_rollback();
+        }
+
+        /// \brief Executes an operation on several containers inside one transaction.
+        /// The operation runs while the connection lock is held, so it must not call methods of the attached
+        /// containers; use begin() and commit() for that. It receives the connection for direct SQL.
+        /// \tparam Func Callable `void(sqlite3*)`.
+        /// \param operation The operation to execute.
+        /// \param mode The transaction mode.
+        /// \throws sqlite_exception if an error occurs during execution.
+        template<typename Func>
+        void execute_in_transaction(Func operation, const TransactionMode& mode = TransactionMode::IMMEDIATE) {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            db_begin(mode);
+            try {
+                operation(m_sqlite_db);
+                db_commit();
+            } catch (...) {
+                if (!sqlite3_get_autocommit(m_sqlite_db)) {
+                    try {
+                        db_rollback();
+                    } catch (...) {}
+                }
+                throw;
+            }
+        }
+
+        /// \brief Executes SQL on the shared connection, preparing each distinct statement once.
+        /// The statements are kept in a cache of `SQLITE_CONTAINERS_STMT_CACHE_SIZE` entries keyed by their text,
+        /// so SQL run repeatedly is parsed on the first call only (see StmtCache).
+        /// \param query SQL text to execute.
+        /// \throws sqlite_exception if the connection is not open or an error occurs during execution.
+        void execute(const std::string& query) {
+            std::lock_guard<std::mutex> locker(m_sqlite_mutex);
+            if (!m_sqlite_db) throw sqlite_exception("Database is not connected.");
+            m_stmt_cache.execute(query);
+        }
+
+        /// \brief Returns the connection, or null if it is not open.
+        sqlite3* handle() const noexcept {
+            return m_sqlite_db;
+        }
+
+    private:
+        friend class BaseDB;
+
+        /// \brief Callbacks of an attached container.
+        struct Attachment {
+            const BaseDB*         owner;    ///< The container.
+            std::function<void()> flush;    ///< Writes the queued writes of the container before a transaction begins.
+            std::function<void()> commit;   ///< Called after a transaction has been committed.
+            std::function<void()> rollback; ///< Called from the rollback hook; must not use the connection.
+        };
+
+        sqlite3*                m_sqlite_db = nullptr;  ///< The shared connection.
+        mutable std::mutex      m_sqlite_mutex;         ///< Lock of the connection, shared with the attached containers.
+        Config                  m_config;               ///< Connection settings.
+        std::vector<Attachment> m_attachments;          ///< Connected containers.
+        std::atomic<bool>       m_user_txn = ATOMIC_VAR_INIT(false); ///< True while a transaction opened by the user is active.
+        std::array<SqliteStmt, 3> m_stmt_begin;
+        SqliteStmt              m_stmt_commit;
+        SqliteStmt              m_stmt_rollback;
+        StmtCache               m_stmt_cache;           ///< Statements of execute(), keyed by their SQL text.
+
+        /// \brief Registers a connected container. Called with `m_sqlite_mutex` held.
+        void db_attach(Attachment attachment) {
+            db_detach(attachment.owner);
+            m_attachments.push_back(std::move(attachment));
+        }
+
+        /// \brief Unregisters a container. Called with `m_sqlite_mutex` held.
+        void db_detach(const BaseDB* owner) {
+            for (auto it = m_attachments.begin(); it != m_attachments.end(); ++it) {
+                if (it->owner != owner) continue;
+                m_attachments.erase(it);
+                return;
+            }
+        }
+
+        /// \brief Begins a user transaction. Called with `m_sqlite_mutex` held.
+        void db_begin(const TransactionMode &mode) {
+            if (!m_sqlite_db) throw sqlite_exception("Database is not connected.");
+            for (auto& attachment : m_attachments) {
+                attachment.flush();
+            }
+            m_stmt_begin[static_cast<size_t>(mode)].execute(m_sqlite_db);
+            m_user_txn = true;
+        }
+
+        /// \brief Commits the current transaction. Called with `m_sqlite_mutex` held.
+        void db_commit() {
+            if (!m_sqlite_db) throw sqlite_exception("Database is not connected.");
+            m_stmt_commit.execute(m_sqlite_db);
+            m_user_txn = false;
+            db_committed();
+        }
+
+        /// \brief Rolls back the current transaction. Called with `m_sqlite_mutex` held.
+        void db_rollback() {
+            if (!m_sqlite_db) throw sqlite_exception("Database is not connected.");
+            m_stmt_rollback.execute(m_sqlite_db);
+            m_user_txn = false;
+        }
+
+        /// \brief Notifies the attached containers that a transaction has been committed.
+        void db_committed() {
+            for (auto& attachment : m_attachments) {
+                attachment.commit();
+            }
+        }
+
+        /// \brief Copies the connection settings into the configuration of an attached container.
+        /// \param config Configuration of the container.
+        void db_connection_config(Config& config) const {
+            config.db_path = m_config.db_path;
+            config.read_only = m_config.read_only;
+            config.use_uri = m_config.use_uri;
+            config.in_memory = m_config.in_memory;
+            config.user_version = m_config.user_version;
+            config.busy_timeout = m_config.busy_timeout;
+            config.busy_retry = m_config.busy_retry;
+            config.page_size = m_config.page_size;
+            config.cache_size = m_config.cache_size;
+            config.cache_spill = m_config.cache_spill;
+            config.mmap_size = m_config.mmap_size;
+            config.temp_store = m_config.temp_store;
+            config.analysis_limit = m_config.analysis_limit;
+            config.wal_autocheckpoint = m_config.wal_autocheckpoint;
+            config.journal_mode = m_config.journal_mode;
+            config.synchronous = m_config.synchronous;
+            config.locking_mode = m_config.locking_mode;
+            config.auto_vacuum_mode = m_config.auto_vacuum_mode;
+        }
+    }; // Database
+
+}; // namespace sqlite_containers
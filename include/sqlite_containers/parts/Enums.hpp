@@ -59,6 +59,13 @@ namespace sqlite_containers {
         EXCLUSIVE   ///< Locks the database for both reading and writing, blocking other transactions.
     };
 
+    /// \enum TableLayout
+    /// \brief Storage layout of the tables created by the containers.
+    enum class TableLayout {
+        ROWID,          ///< Rowid tables with a separate index on the primary key.
+        WITHOUT_ROWID   ///< `WITHOUT ROWID` tables clustered by their primary key.
+    };
+
     /// \brief Converts JournalMode enum to string representation.
     /// \param mode The JournalMode enum value.
     /// \return String representation of the JournalMode.
@@ -110,6 +117,18 @@ namespace sqlite_containers {
         return data[static_cast<size_t>(mode)];
     }
 
+    /// \brief Converts TempStore enum to string representation.
+    /// \param mode The TempStore enum value.
+    /// \return String representation of the TempStore.
+    inline std::string to_string(const TempStore &mode) {
+        static const std::array<std::string, 3> data = {
+            "DEFAULT",
+            "FILE",
+            "MEMORY"
+        };
+        return data[static_cast<size_t>(mode)];
+    }
+
     /// \brief Converts TransactionMode enum to string representation.
     /// \param mode The TransactionMode enum value.
     /// \return String representation of the TransactionMode.
@@ -122,4 +141,11 @@ namespace sqlite_containers {
         return data[static_cast<size_t>(mode)];
     }
 
+    /// \brief Returns the table options that select a table layout.
+    /// \param layout Table layout.
+    /// \return `" WITHOUT ROWID"` or an empty string.
+    inline std::string to_table_options(const TableLayout &layout) {
+        return layout == TableLayout::WITHOUT_ROWID ? " WITHOUT ROWID" : "";
+    }
+
 }; // namespace sqlite_containers
@@ -0,0 +1,334 @@
+#pragma once
+
+/// \file KeyCodec.hpp
+/// \brief Declaration of the order-preserving key encodings and the OrderedCodec used for composite keys.
+
+#include "Codec.hpp"
+#include <tuple>
+#include <utility>
+
+namespace sqlite_containers {
+
+    /// \brief Order-preserving binary encoding of a key component.
+    /// \details Encoded values compare with `memcmp` (and therefore in the SQLite index of a BLOB column) in the
+    /// same order as the original values. Every specialization provides:
+    /// - `fixed_size`: number of bytes of every encoded value, or 0 if it depends on the value;
+    /// - `encode(value, out)`: appends the encoding of the value to `out`;
+    /// - `decode(data, end, value)`: reads one value from `[data, end)` and advances `data` past it.
+    ///
+    /// Built-in encodings:
+    /// - unsigned integers and `bool`: big-endian;
+    /// - signed integers: big-endian with the sign bit flipped;
+    /// - `float` and `double`: IEEE 754 bits, the sign bit flipped for positive values and all bits inverted for
+    ///   negative values (so `-0.0` sorts before `+0.0`);
+    /// - enums, `std::chrono` durations and time points: through their underlying value;
+    /// - `std::string`, `std::vector<char>` and `std::vector<uint8_t>`: bytes with 0x00 escaped as 0x00 0xFF,
+    ///   terminated by 0x00 0x00, so a shorter value sorts before any longer value it is a prefix of;
+    /// - `std::array`, `std::pair` and `std::tuple`: concatenation of their elements.
+    /// \tparam T The type of the key component.
+    template<typename T, typename Enable = void>
+    struct KeyEncoding;
+
+    /// \brief Throws the exception reported for a truncated or malformed key encoding.
+    inline void throw_invalid_key_encoding() {
+        throw sqlite_exception("Invalid ordered key encoding.");
+    }
+
+    /// \brief Key encoding of unsigned integers and bool.
+    template<typename T>
+    struct KeyEncoding<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type> {
+        static constexpr std::size_t fixed_size = sizeof(T);
+
+        static void encode(const T& value, std::vector<uint8_t>& out) {
+            const uint64_t bits = static_cast<uint64_t>(value);
+            for (std::size_t i = sizeof(T); i > 0; --i) {
+                out.push_back(static_cast<uint8_t>(bits >> (8 * (i - 1))));
+            }
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, T& value) {
+            if (static_cast<std::size_t>(end - data) < sizeof(T)) throw_invalid_key_encoding();
+            uint64_t bits = 0;
+            for (std::size_t i = 0; i < sizeof(T); ++i) {
+                bits = (bits << 8) | *data++;
+            }
+            value = static_cast<T>(bits);
+        }
+    };
+
+    /// \brief Key encoding of signed integers.
+    template<typename T>
+    struct KeyEncoding<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type> {
+        using UnsignedT = typename std::make_unsigned<T>::type;
+
+        static constexpr std::size_t fixed_size = sizeof(T);
+        static constexpr UnsignedT sign_bit = static_cast<UnsignedT>(UnsignedT(1) << (8 * sizeof(T) - 1));
+
+        static void encode(const T& value, std::vector<uint8_t>& out) {
+            KeyEncoding<UnsignedT>::encode(static_cast<UnsignedT>(static_cast<UnsignedT>(value) ^ sign_bit), out);
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, T& value) {
+            UnsignedT bits;
+            KeyEncoding<UnsignedT>::decode(data, end, bits);
+            value = static_cast<T>(static_cast<UnsignedT>(bits ^ sign_bit));
+        }
+    };
+
+    /// \brief Key encoding of float and double.
+    template<typename T>
+    struct KeyEncoding<T, typename std::enable_if<
+            std::is_same<T, float>::value ||
+            std::is_same<T, double>::value>::type> {
+        using BitsT = typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type;
+
+        static_assert(sizeof(T) == sizeof(BitsT), "Unsupported floating-point size.");
+
+        static constexpr std::size_t fixed_size = sizeof(T);
+        static constexpr BitsT sign_bit = BitsT(1) << (8 * sizeof(T) - 1);
+
+        static void encode(const T& value, std::vector<uint8_t>& out) {
+            BitsT bits;
+            std::memcpy(&bits, &value, sizeof(T));
+            bits = (bits & sign_bit) ? static_cast<BitsT>(~bits) : static_cast<BitsT>(bits | sign_bit);
+            KeyEncoding<BitsT>::encode(bits, out);
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, T& value) {
+            BitsT bits;
+            KeyEncoding<BitsT>::decode(data, end, bits);
+            bits = (bits & sign_bit) ? static_cast<BitsT>(bits ^ sign_bit) : static_cast<BitsT>(~bits);
+            std::memcpy(&value, &bits, sizeof(T));
+        }
+    };
+
+    /// \brief Key encoding of enums, through their underlying type.
+    template<typename T>
+    struct KeyEncoding<T, typename std::enable_if<std::is_enum<T>::value>::type> {
+        using UnderlyingT = typename std::underlying_type<T>::type;
+
+        static constexpr std::size_t fixed_size = sizeof(T);
+
+        static void encode(const T& value, std::vector<uint8_t>& out) {
+            KeyEncoding<UnderlyingT>::encode(static_cast<UnderlyingT>(value), out);
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, T& value) {
+            UnderlyingT underlying;
+            KeyEncoding<UnderlyingT>::decode(data, end, underlying);
+            value = static_cast<T>(underlying);
+        }
+    };
+
+    /// \brief Key encoding of durations, through their tick count.
+    template<typename Rep, typename Period>
+    struct KeyEncoding<std::chrono::duration<Rep, Period>> {
+        static constexpr std::size_t fixed_size = KeyEncoding<Rep>::fixed_size;
+
+        static void encode(const std::chrono::duration<Rep, Period>& value, std::vector<uint8_t>& out) {
+            KeyEncoding<Rep>::encode(value.count(), out);
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, std::chrono::duration<Rep, Period>& value) {
+            Rep count{};
+            KeyEncoding<Rep>::decode(data, end, count);
+            value = std::chrono::duration<Rep, Period>(count);
+        }
+    };
+
+    /// \brief Key encoding of time points, through the duration since the epoch of the clock.
+    template<typename Clock, typename Duration>
+    struct KeyEncoding<std::chrono::time_point<Clock, Duration>> {
+        static constexpr std::size_t fixed_size = KeyEncoding<Duration>::fixed_size;
+
+        static void encode(const std::chrono::time_point<Clock, Duration>& value, std::vector<uint8_t>& out) {
+            KeyEncoding<Duration>::encode(value.time_since_epoch(), out);
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, std::chrono::time_point<Clock, Duration>& value) {
+            Duration duration{};
+            KeyEncoding<Duration>::decode(data, end, duration);
+            value = std::chrono::time_point<Clock, Duration>(duration);
+        }
+    };
+
+    /// \brief Key encoding of strings and byte vectors: escaped bytes followed by a terminator.
+    template<typename T>
+    struct KeyEncoding<T, typename std::enable_if<
+            std::is_same<T, std::string>::value ||
+            std::is_same<T, std::vector<char>>::value ||
+            std::is_same<T, std::vector<uint8_t>>::value>::type> {
+        static constexpr std::size_t fixed_size = 0;
+
+        static void encode(const T& value, std::vector<uint8_t>& out) {
+            for (const auto& item : value) {
+                const uint8_t byte = static_cast<uint8_t>(item);
+                out.push_back(byte);
+                if (byte == 0x00) out.push_back(0xFF);
+            }
+            out.push_back(0x00);
+            out.push_back(0x00);
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, T& value) {
+            value.clear();
+            for (;;) {
+                if (data == end) throw_invalid_key_encoding();
+                const uint8_t byte = *data++;
+                if (byte != 0x00) {
+                    value.push_back(static_cast<typename T::value_type>(byte));
+                    continue;
+                }
+                if (data == end) throw_invalid_key_encoding();
+                const uint8_t next = *data++;
+                if (next == 0x00) return;
+                if (next != 0xFF) throw_invalid_key_encoding();
+                value.push_back(static_cast<typename T::value_type>(0x00));
+            }
+        }
+    };
+
+    /// \brief Key encoding of arrays: concatenation of the elements.
+    template<typename T, std::size_t N>
+    struct KeyEncoding<std::array<T, N>> {
+        static constexpr std::size_t fixed_size = N * KeyEncoding<T>::fixed_size;
+
+        static void encode(const std::array<T, N>& value, std::vector<uint8_t>& out) {
+            for (const auto& item : value) {
+                KeyEncoding<T>::encode(item, out);
+            }
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, std::array<T, N>& value) {
+            for (auto& item : value) {
+                KeyEncoding<T>::decode(data, end, item);
+            }
+        }
+    };
+
+    /// \brief Key encoding of pairs: the first element followed by the second.
+    template<typename T1, typename T2>
+    struct KeyEncoding<std::pair<T1, T2>> {
+        static constexpr std::size_t fixed_size =
+            (KeyEncoding<T1>::fixed_size && KeyEncoding<T2>::fixed_size) ?
+            KeyEncoding<T1>::fixed_size + KeyEncoding<T2>::fixed_size : 0;
+
+        static void encode(const std::pair<T1, T2>& value, std::vector<uint8_t>& out) {
+            KeyEncoding<T1>::encode(value.first, out);
+            KeyEncoding<T2>::encode(value.second, out);
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, std::pair<T1, T2>& value) {
+            KeyEncoding<T1>::decode(data, end, value.first);
+            KeyEncoding<T2>::decode(data, end, value.second);
+        }
+    };
+
+    /// \brief Key encoding of tuples: concatenation of the elements in order.
+    template<typename... Ts>
+    struct KeyEncoding<std::tuple<Ts...>> {
+        static constexpr std::size_t fixed_size =
+            ((KeyEncoding<Ts>::fixed_size != 0) && ...) ? (KeyEncoding<Ts>::fixed_size + ... + 0) : 0;
+
+        static void encode(const std::tuple<Ts...>& value, std::vector<uint8_t>& out) {
+            std::apply([&out](const Ts&... items) {
+                (KeyEncoding<Ts>::encode(items, out), ...);
+            }, value);
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, std::tuple<Ts...>& value) {
+            std::apply([&data, end](Ts&... items) {
+                (KeyEncoding<Ts>::decode(data, end, items), ...);
+            }, value);
+        }
+    };
+
+    /// \brief Key encoding of a structure: concatenation of the listed data members in order.
+    /// \tparam T The structure.
+    /// \tparam Members Pointers to the data members, most significant first.
+    template<typename T, auto... Members>
+    struct MemberKeyEncoding {
+        static constexpr std::size_t fixed_size =
+            ((KeyEncoding<std::decay_t<decltype(std::declval<T&>().*Members)>>::fixed_size != 0) && ...) ?
+            (KeyEncoding<std::decay_t<decltype(std::declval<T&>().*Members)>>::fixed_size + ... + 0) : 0;
+
+        static void encode(const T& value, std::vector<uint8_t>& out) {
+            (KeyEncoding<std::decay_t<decltype(value.*Members)>>::encode(value.*Members, out), ...);
+        }
+
+        static void decode(const uint8_t*& data, const uint8_t* end, T& value) {
+            (KeyEncoding<std::decay_t<decltype(value.*Members)>>::decode(data, end, value.*Members), ...);
+        }
+    };
+
+    /// \brief Codec that stores a key as a BLOB in its order-preserving encoding.
+    /// \details With this codec the index order of the key column matches the order of the keys, which makes
+    /// ordered seeks and range scans over composite keys meaningful. Pairs and tuples use it by default. For a
+    /// structure, list its members from the most to the least significant:
+    /// \code
+    /// struct Tick { int32_t instrument_id; int64_t timestamp; };
+    /// template<>
+    /// struct sqlite_containers::Codec<Tick> : sqlite_containers::OrderedCodec<Tick, &Tick::instrument_id, &Tick::timestamp> {};
+    /// \endcode
+    /// Without members the codec uses `KeyEncoding<T>`.
+    /// \tparam T The type of the key.
+    /// \tparam Members Pointers to the data members of a structure, most significant first.
+    template<typename T, auto... Members>
+    struct OrderedCodec {
+        using EncodingT = typename std::conditional<
+            sizeof...(Members) == 0, KeyEncoding<T>, MemberKeyEncoding<T, Members...>>::type;
+
+        static constexpr const char* affinity = "BLOB";
+        static constexpr std::size_t fixed_size = EncodingT::fixed_size;
+
+        /// \brief Encodes the key into a per-thread buffer and binds a copy of it.
+        static int bind(sqlite3_stmt* stmt, const int& index, const T& value) {
+            thread_local std::vector<uint8_t> buffer;
+            buffer.clear();
+            EncodingT::encode(value, buffer);
+            return sqlite3_bind_blob(stmt, index, buffer.data(), static_cast<int>(buffer.size()), SQLITE_TRANSIENT);
+        }
+
+        /// \throws sqlite_exception if the column does not hold a valid encoding.
+        static void extract(sqlite3_stmt* stmt, const int& index, T& value) {
+            const uint8_t* data = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, index));
+            const uint8_t* end = data + sqlite3_column_bytes(stmt, index);
+            EncodingT::decode(data, end, value);
+            if (data != end) throw_invalid_key_encoding();
+        }
+    };
+
+    /// \brief Codec for pairs, stored in their order-preserving encoding.
+    template<typename T1, typename T2>
+    struct Codec<std::pair<T1, T2>> : OrderedCodec<std::pair<T1, T2>> {};
+
+    /// \brief Codec for tuples, stored in their order-preserving encoding.
+    template<typename... Ts>
+    struct Codec<std::tuple<Ts...>> : OrderedCodec<std::tuple<Ts...>> {};
+
+    /// \brief Combines the hashes of the elements of a pair or tuple.
+    inline std::size_t hash_combine(const std::size_t& seed, const std::size_t& hash) noexcept {
+        return seed ^ (hash + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    }
+
+    /// \brief Hash function for pairs, combining the hashes of the elements.
+    template<typename T1, typename T2>
+    struct Hash<std::pair<T1, T2>> {
+        std::size_t operator()(const std::pair<T1, T2>& value) const noexcept {
+            return hash_combine(Hash<T1>()(value.first), Hash<T2>()(value.second));
+        }
+    };
+
+    /// \brief Hash function for tuples, combining the hashes of the elements.
+    template<typename... Ts>
+    struct Hash<std::tuple<Ts...>> {
+        std::size_t operator()(const std::tuple<Ts...>& value) const noexcept {
+            return std::apply([](const Ts&... items) {
+                std::size_t seed = 0;
+                ((seed = hash_combine(seed, Hash<Ts>()(items))), ...);
+                return seed;
+            }, value);
+        }
+    };
+
+}; // namespace sqlite_containers
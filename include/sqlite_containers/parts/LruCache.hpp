@@ -0,0 +1,182 @@
+#pragma once
+
+/// \file LruCache.hpp
+/// \brief Declaration of the LruCache class, a bounded read-through cache of found values.
+
+#include "Codec.hpp"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace sqlite_containers {
+
+    /// \brief Counters of a read cache.
+    struct CacheStats {
+        std::uint64_t hits = 0;     ///< Lookups served from the cache.
+        std::uint64_t misses = 0;   ///< Lookups that went to the database.
+        std::size_t   entries = 0;  ///< Number of cached entries.
+        std::size_t   bytes = 0;    ///< Estimated memory used by the cached entries.
+    };
+
+    /// \class LruCache
+    /// \brief Thread-safe least recently used cache bounded by an estimated memory budget.
+    /// \tparam KeyT Type of the keys.
+    /// \tparam ValueT Type of the values.
+    /// \details Every invalidation advances a generation counter. A value read from the database is only stored if
+    /// no invalidation happened since the lookup started, so a read that raced with a write cannot put a value
+    /// that is already outdated back into the cache.
+    template<class KeyT, class ValueT>
+    class LruCache {
+    public:
+
+        /// \brief Default constructor. The cache is disabled until a capacity is set.
+        LruCache() = default;
+
+        LruCache(const LruCache&) = delete;
+        LruCache& operator=(const LruCache&) = delete;
+
+        /// \brief Sets the memory budget and drops all entries.
+        /// \param capacity_bytes Maximum estimated size of the cached entries in bytes; 0 disables the cache.
+        void set_capacity(const std::size_t& capacity_bytes) {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            m_capacity = capacity_bytes;
+            m_enabled = capacity_bytes > 0;
+            clear_entries();
+            ++m_generation;
+        }
+
+        /// \brief Checks whether the cache is enabled.
+        bool enabled() const noexcept {
+            return m_enabled.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Looks up a value and marks it as recently used.
+        /// \param key The key to search for.
+        /// \param value Receives the cached value.
+        /// \return True on a cache hit.
+        bool get(const KeyT& key, ValueT& value) {
+            if (!enabled()) return false;
+            std::lock_guard<std::mutex> locker(m_mutex);
+            auto it = m_index.find(key);
+            if (it == m_index.end()) {
+                ++m_misses;
+                return false;
+            }
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            value = it->second->value;
+            ++m_hits;
+            return true;
+        }
+
+        /// \brief Returns the current generation, to be passed to put() after reading from the database.
+        std::uint64_t generation() const {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            return m_generation;
+        }
+
+        /// \brief Stores a value read from the database.
+        /// Nothing is stored if the cache was invalidated after `generation` was taken or the value exceeds the budget.
+        /// \param key The key.
+        /// \param value The value.
+        /// \param generation Generation taken before the database was read.
+        void put(const KeyT& key, const ValueT& value, const std::uint64_t& generation) {
+            if (!enabled()) return;
+            const std::size_t bytes = entry_size(key, value);
+            std::lock_guard<std::mutex> locker(m_mutex);
+            if (generation != m_generation || bytes > m_capacity) return;
+            auto it = m_index.find(key);
+            if (it != m_index.end()) {
+                m_bytes -= it->second->bytes;
+                it->second->value = value;
+                it->second->bytes = bytes;
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+            } else {
+                m_entries.push_front(Entry{key, value, bytes});
+                m_index.emplace(key, m_entries.begin());
+            }
+            m_bytes += bytes;
+            while (m_bytes > m_capacity) {
+                Entry& last = m_entries.back();
+                m_bytes -= last.bytes;
+                m_index.erase(last.key);
+                m_entries.pop_back();
+            }
+        }
+
+        /// \brief Drops the entry of a key and advances the generation.
+        /// \param key The key to invalidate.
+        void erase(const KeyT& key) {
+            if (!enabled()) return;
+            std::lock_guard<std::mutex> locker(m_mutex);
+            ++m_generation;
+            auto it = m_index.find(key);
+            if (it == m_index.end()) return;
+            m_bytes -= it->second->bytes;
+            m_entries.erase(it->second);
+            m_index.erase(it);
+        }
+
+        /// \brief Drops all entries and advances the generation.
+        void clear() {
+            if (!enabled()) return;
+            std::lock_guard<std::mutex> locker(m_mutex);
+            ++m_generation;
+            clear_entries();
+        }
+
+        /// \brief Returns the cache counters.
+        CacheStats stats() const {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            CacheStats stats;
+            stats.hits = m_hits;
+            stats.misses = m_misses;
+            stats.entries = m_index.size();
+            stats.bytes = m_bytes;
+            return stats;
+        }
+
+        /// \brief Resets the hit and miss counters.
+        void reset_stats() {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            m_hits = 0;
+            m_misses = 0;
+        }
+
+    private:
+
+        /// \brief Cached value with its estimated size.
+        struct Entry {
+            KeyT        key;
+            ValueT      value;
+            std::size_t bytes;
+        };
+
+        using EntryList = std::list<Entry>;
+        using EntryIndex = std::unordered_map<KeyT, typename EntryList::iterator, Hash<KeyT>, EqualTo<KeyT>>;
+
+        EntryList               m_entries;              ///< Entries ordered from the most to the least recently used.
+        EntryIndex              m_index;                ///< Entries by key.
+        std::size_t             m_capacity = 0;         ///< Memory budget in bytes.
+        std::size_t             m_bytes = 0;            ///< Estimated memory used by the entries.
+        std::uint64_t           m_generation = 0;       ///< Number of invalidations so far.
+        std::uint64_t           m_hits = 0;             ///< Cache hits.
+        std::uint64_t           m_misses = 0;           ///< Cache misses.
+        std::atomic<bool>       m_enabled = ATOMIC_VAR_INIT(false); ///< True if the capacity is not zero.
+        mutable std::mutex      m_mutex;                ///< Protects the cache.
+
+        /// \brief Estimates the memory used by one entry, including the list node and the index node.
+        static std::size_t entry_size(const KeyT& key, const ValueT& value) {
+            return 2 * get_byte_size(key) + get_byte_size(value) + sizeof(Entry) + 4 * sizeof(void*);
+        }
+
+        /// \brief Drops all entries.
+        void clear_entries() {
+            m_index.clear();
+            m_entries.clear();
+            m_bytes = 0;
+        }
+    }; // LruCache
+
+}; // namespace sqlite_containers
@@ -0,0 +1,72 @@
+#pragma once
+
+/// \file MemoryConfig.hpp
+/// \brief Declaration of MemoryConfig, the process-wide memory settings of SQLite shared by all connections.
+
+#include "Utils.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace sqlite_containers {
+
+    /// \brief Process-wide memory settings of SQLite, shared by every connection of every container.
+    /// \details The page cache buffer (`SQLITE_CONFIG_PAGECACHE`) gives all connections one preallocated pool of
+    /// page slots instead of a heap allocation per page; pages that do not fit fall back to the heap. The heap
+    /// buffer (`SQLITE_CONFIG_HEAP`) replaces the general allocator of SQLite with a fixed region and requires a
+    /// build of SQLite with `SQLITE_ENABLE_MEMSYS5`. The soft heap limit bounds the memory of all page caches.
+    struct MemoryConfig {
+        int         page_size = 4096;           ///< Page size the page cache slots are sized for; match `Config::page_size`.
+        int         page_cache_pages = 0;       ///< Number of page slots in the shared page cache buffer (0 keeps the default allocator).
+        std::size_t heap_bytes = 0;             ///< Size of the heap buffer in bytes (0 keeps the default allocator).
+        int         heap_min_alloc = 64;        ///< Smallest allocation from the heap buffer, a power of two.
+        int64_t     soft_heap_limit = 0;        ///< Soft limit in bytes of the memory used by SQLite (0 leaves it unlimited).
+    };
+
+    /// \brief Applies the process-wide memory settings of SQLite.
+    /// Must be called before the first connection is opened, since SQLite reads these settings once when it is
+    /// initialized. The buffers are kept until the process exits; a second call fails.
+    /// \param config Memory settings.
+    /// \throws sqlite_exception if SQLite is already initialized, was built without support for a setting,
+    /// or was configured before.
+    inline void configure_memory(const MemoryConfig &config) {
+        static std::mutex mutex;
+        static std::unique_ptr<unsigned char[]> page_cache_buffer;
+        static std::unique_ptr<unsigned char[]> heap_buffer;
+        static bool configured = false;
+        std::lock_guard<std::mutex> locker(mutex);
+        if (configured) throw sqlite_exception("SQLite memory is already configured.", SQLITE_MISUSE);
+
+        int err = SQLITE_OK;
+        std::unique_ptr<unsigned char[]> page_cache;
+        if (config.page_cache_pages > 0) {
+            int header_size = 0;
+            if ((err = sqlite3_config(SQLITE_CONFIG_PCACHE_HDRSZ, &header_size)) != SQLITE_OK) {
+                throw sqlite_exception("Failed to query the page cache header size. Error code: " + std::to_string(err), err);
+            }
+            // Slots hold a page plus its header and are rounded up to a multiple of 8 bytes
+            const int slot_size = (config.page_size + header_size + 7) & ~7;
+            page_cache.reset(new unsigned char[static_cast<std::size_t>(slot_size) * config.page_cache_pages]);
+            if ((err = sqlite3_config(SQLITE_CONFIG_PAGECACHE, page_cache.get(), slot_size, config.page_cache_pages)) != SQLITE_OK) {
+                throw sqlite_exception("Failed to configure the shared page cache, SQLite may already be initialized. Error code: " + std::to_string(err), err);
+            }
+        }
+
+        std::unique_ptr<unsigned char[]> heap;
+        if (config.heap_bytes > 0) {
+            heap.reset(new unsigned char[config.heap_bytes]);
+            if ((err = sqlite3_config(SQLITE_CONFIG_HEAP, heap.get(), static_cast<int>(config.heap_bytes), config.heap_min_alloc)) != SQLITE_OK) {
+                if (page_cache) sqlite3_config(SQLITE_CONFIG_PAGECACHE, nullptr, 0, 0);
+                throw sqlite_exception("Failed to configure the SQLite heap, SQLite may already be initialized or lack SQLITE_ENABLE_MEMSYS5. Error code: " + std::to_string(err), err);
+            }
+        }
+
+        if (config.soft_heap_limit > 0) {
+            sqlite3_soft_heap_limit64(config.soft_heap_limit);
+        }
+        page_cache_buffer = std::move(page_cache);
+        heap_buffer = std::move(heap);
+        configured = true;
+    }
+
+}; // namespace sqlite_containers
@@ -0,0 +1,177 @@
+#pragma once
+
+/// \file ReaderPool.hpp
+/// \brief Declaration of the ReaderPool class for read-only database connections.
+
+#include "Config.hpp"
+#include "Utils.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace sqlite_containers {
+
+    /// \class ReaderPool
+    /// \brief Pool of read-only connections with their own prepared statements.
+    /// \tparam StmtsT Type holding the prepared statements of one connection.
+    /// \details In WAL mode readers do not block the writer or each other, so every thread can read through its own
+    /// connection instead of waiting for the connection lock of the container. Each thread starts looking for a
+    /// free connection at a slot chosen by its id, so threads tend to keep reusing the same connection and its page
+    /// cache, and it waits on that slot only if every connection is busy. Readers see committed data only.
+    template<class StmtsT>
+    class ReaderPool {
+    public:
+
+        /// \brief Read-only connection and its prepared statements.
+        struct Reader {
+            sqlite3*    sqlite_db = nullptr;    ///< Read-only database connection.
+            std::mutex  mutex;                  ///< Serializes the use of the connection.
+            StmtsT      stmts;                  ///< Prepared statements of the connection.
+
+            /// \brief Destructor. Closes the connection once the statements are finalized.
+            ~Reader() {
+                if (!sqlite_db) return;
+                clear_busy_policy(sqlite_db);
+                sqlite3_close_v2(sqlite_db);
+            }
+        };
+
+        /// \class Lease
+        /// \brief Exclusive use of one reader, released when the lease is destroyed.
+        class Lease {
+        public:
+            Lease() = default;
+
+            /// \brief Constructs a lease over a locked reader.
+            Lease(std::shared_lock<std::shared_mutex> pool_locker, std::unique_lock<std::mutex> locker, Reader* reader) :
+                m_pool_locker(std::move(pool_locker)), m_locker(std::move(locker)), m_reader(reader) {}
+
+            /// \brief Checks whether the lease holds a reader.
+            explicit operator bool() const noexcept {
+                return m_reader != nullptr;
+            }
+
+            Reader* operator->() const noexcept {
+                return m_reader;
+            }
+
+        private:
+            std::shared_lock<std::shared_mutex> m_pool_locker;  ///< Keeps the pool open while the lease is alive.
+            std::unique_lock<std::mutex>        m_locker;       ///< Lock of the reader.
+            Reader*                             m_reader = nullptr; ///< The leased reader.
+        };
+
+        using InitFunc = std::function<void(sqlite3*, StmtsT&)>; ///< Function that prepares the statements of a reader.
+
+        /// \brief Default constructor.
+        ReaderPool() = default;
+
+        ReaderPool(const ReaderPool&) = delete;
+        ReaderPool& operator=(const ReaderPool&) = delete;
+
+        /// \brief Destructor. Closes all readers.
+        ~ReaderPool() {
+            close();
+        }
+
+        /// \brief Checks whether the configuration allows read-only connections.
+        /// Requires `Config::read_connections > 0`, WAL journal mode, normal locking mode and a file database.
+        /// \param config Configuration settings.
+        /// \return True if readers can be opened.
+        static bool is_supported(const Config& config) noexcept {
+            return config.read_connections > 0 &&
+                config.journal_mode == JournalMode::WAL &&
+                config.locking_mode == LockingMode::NORMAL &&
+                !config.in_memory;
+        }
+
+        /// \brief Opens `Config::read_connections` readers if the configuration allows them.
+        /// Must be called after the tables are created and the journal mode is set by the writer connection.
+        /// \param config Configuration settings.
+        /// \param init Function that prepares the statements of each reader.
+        /// \throws sqlite_exception if a connection cannot be opened or a statement cannot be prepared.
+        void open(const Config& config, const InitFunc& init) {
+            close();
+            if (!is_supported(config)) return;
+            std::vector<std::unique_ptr<Reader>> readers;
+            readers.reserve(config.read_connections);
+            int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+            flags |= config.use_uri ? SQLITE_OPEN_URI : 0;
+            for (std::size_t i = 0; i < config.read_connections; ++i) {
+                std::unique_ptr<Reader> reader(new Reader());
+                int err = sqlite3_open_v2(config.db_path.c_str(), &reader->sqlite_db, flags, nullptr);
+                if (err != SQLITE_OK) {
+                    std::string error_message = "Cannot open read-only connection: ";
+                    error_message += sqlite3_errmsg(reader->sqlite_db);
+                    error_message += " (Error code: ";
+                    error_message += std::to_string(err);
+                    error_message += ")";
+                    throw sqlite_exception(error_message, err);
+                }
+                set_busy_policy(reader->sqlite_db, config.busy_retry, config.busy_timeout);
+                execute(reader->sqlite_db, "PRAGMA cache_size = " + std::to_string(config.cache_size) + ";");
+                execute(reader->sqlite_db, "PRAGMA mmap_size = " + std::to_string(config.mmap_size) + ";");
+                init(reader->sqlite_db, reader->stmts);
+                readers.push_back(std::move(reader));
+            }
+            std::unique_lock<std::shared_mutex> locker(m_mutex);
+            m_readers = std::move(readers);
+            m_is_open = true;
+        }
+
+        /// \brief Closes all readers after the current leases are released.
+        void close() {
+            std::vector<std::unique_ptr<Reader>> readers;
+            std::unique_lock<std::shared_mutex> locker(m_mutex);
+            m_is_open = false;
+            readers.swap(m_readers);
+            locker.unlock();
+        }
+
+        /// \brief Returns the number of open readers.
+        std::size_t size() const {
+            std::shared_lock<std::shared_mutex> locker(m_mutex);
+            return m_readers.size();
+        }
+
+        /// \brief Returns the time the readers have spent waiting for a busy database.
+        BusyStats busy_stats() const {
+            std::shared_lock<std::shared_mutex> locker(m_mutex);
+            BusyStats stats;
+            for (const auto& reader : m_readers) {
+                stats += get_busy_stats(reader->sqlite_db);
+            }
+            return stats;
+        }
+
+        /// \brief Leases a reader.
+        /// Tries every reader without blocking, starting at the slot of the calling thread, and waits for that
+        /// slot if all readers are busy.
+        /// \return Lease over a reader, or an empty lease if the pool is closed.
+        Lease acquire() {
+            if (!m_is_open.load(std::memory_order_relaxed)) return Lease();
+            std::shared_lock<std::shared_mutex> pool_locker(m_mutex);
+            const std::size_t size = m_readers.size();
+            if (size == 0) return Lease();
+            const std::size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % size;
+            for (std::size_t i = 0; i < size; ++i) {
+                Reader* reader = m_readers[(start + i) % size].get();
+                std::unique_lock<std::mutex> locker(reader->mutex, std::try_to_lock);
+                if (locker.owns_lock()) return Lease(std::move(pool_locker), std::move(locker), reader);
+            }
+            Reader* reader = m_readers[start].get();
+            std::unique_lock<std::mutex> locker(reader->mutex);
+            return Lease(std::move(pool_locker), std::move(locker), reader);
+        }
+
+    private:
+        std::vector<std::unique_ptr<Reader>> m_readers; ///< Open readers.
+        mutable std::shared_mutex            m_mutex;   ///< Protects the list of readers against close().
+        std::atomic<bool>                    m_is_open = ATOMIC_VAR_INIT(false); ///< True while readers are open.
+    }; // ReaderPool
+
+}; // namespace sqlite_containers
@@ -0,0 +1,36 @@
+#pragma once
+
+/// \file RetryPolicy.hpp
+/// \brief Declaration of RetryPolicy, the settings of the waits on a busy database.
+
+#include <cstdint>
+#include <functional>
+
+namespace sqlite_containers {
+
+    /// \brief How long and how often a connection waits for a database locked by another connection.
+    /// \details The policy drives both the busy handler of every connection (which retries inside SQLite for up
+    /// to `Config::busy_timeout` milliseconds) and the loops that restart a statement once SQLite gives up. Waits
+    /// first yield the thread `spin_count` times, then sleep for a delay growing by `multiplier` from
+    /// `initial_delay_us` up to `max_delay_us`, shortened by a random part of up to `jitter` so that waiting
+    /// connections do not retry in lockstep.
+    struct RetryPolicy {
+        using DelayFunc = std::function<int64_t(int attempt)>; ///< Returns the delay in microseconds before a retry, or a negative value to stop.
+
+        int         spin_count = 0;             ///< Number of first retries that only yield the thread.
+        int64_t     initial_delay_us = 100;     ///< Delay in microseconds before the first sleeping retry.
+        int64_t     max_delay_us = 50000;       ///< Largest delay in microseconds between two retries.
+        double      multiplier = 2.0;           ///< Growth factor of the delay after each retry.
+        double      jitter = 0.5;               ///< Largest random part of a delay, as a fraction of it (0 to 1).
+        int         deadline_ms = -1;           ///< Time in milliseconds a statement is restarted before failing with SQLITE_BUSY; -1 waits forever.
+        DelayFunc   delay_func;                 ///< Custom delay replacing the exponential backoff, may be empty.
+    };
+
+    /// \brief Time spent waiting for a busy database.
+    struct BusyStats {
+        uint64_t    retries = 0;                ///< Number of waits before a retry.
+        uint64_t    wait_us = 0;                ///< Total time in microseconds spent waiting.
+        uint64_t    timeouts = 0;               ///< Number of times a wait gave up.
+    };
+
+}; // namespace sqlite_containers
@@ -0,0 +1,267 @@
+#pragma once
+
+/// \file ShardedDB.hpp
+/// \brief Declaration of the ShardedDB class template, the common part of the sharded containers.
+
+#include "BaseDB.hpp"
+#include "ThreadPool.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace sqlite_containers {
+
+    /// \brief Checks whether the codec of a type stores it in an order-preserving encoding (see OrderedCodec).
+    template<typename T, typename Enable = void>
+    struct has_key_encoding : std::false_type {};
+
+    template<typename T>
+    struct has_key_encoding<T, std::void_t<typename Codec<T>::EncodingT>> : std::true_type {};
+
+    /// \brief Hash function that maps keys to shards.
+    /// Unlike `std::hash`, the result is fixed (64-bit FNV-1a over the bytes of the key), so a key is found in the
+    /// same shard by every run of the program. Strings and BLOBs are hashed by their content, integers and enums by
+    /// their bytes in little-endian order, floating-point values by the little-endian bytes of their IEEE 754 bits
+    /// with -0.0 taken as 0.0; these hashes are the same on every platform. Structures without padding or pointers
+    /// are hashed by their object representation, which depends on the byte order of the host. Other keys, such as
+    /// pairs and tuples holding strings, are hashed by the bytes of their `KeyEncoding`, and any other key type
+    /// needs an OrderedCodec or a specialization of ShardHash.
+    /// \tparam T The type of the key.
+    template<typename T, typename Enable = void>
+    struct ShardHash {
+        std::uint64_t operator()(const T& value) const {
+            if constexpr (std::is_enum<T>::value) {
+                using UnderlyingT = typename std::underlying_type<T>::type;
+                return ShardHash<UnderlyingT>()(static_cast<UnderlyingT>(value));
+            } else if constexpr (std::is_integral<T>::value) {
+                return fnv1a_le(static_cast<std::uint64_t>(value), sizeof(T));
+            } else if constexpr (std::is_floating_point<T>::value) {
+                // SQLite finds -0.0 and 0.0 as the same key, so both must select the same shard
+                using FloatT = typename std::conditional<sizeof(T) == sizeof(float), float, double>::type;
+                using BitsT = typename std::conditional<sizeof(FloatT) == 4, std::uint32_t, std::uint64_t>::type;
+                const FloatT number = value == 0 ? FloatT(0) : static_cast<FloatT>(value);
+                BitsT bits;
+                std::memcpy(&bits, &number, sizeof(bits));
+                return fnv1a_le(bits, sizeof(bits));
+            } else if constexpr (std::has_unique_object_representations<T>::value) {
+                return fnv1a(&value, sizeof(T));
+            } else {
+                static_assert(has_key_encoding<T>::value,
+                    "ShardHash needs a key without padding or pointers, an OrderedCodec or a ShardHash specialization.");
+                thread_local std::vector<uint8_t> buffer;
+                buffer.clear();
+                Codec<T>::EncodingT::encode(value, buffer);
+                return fnv1a(buffer.data(), buffer.size());
+            }
+        }
+
+        /// \brief Computes the 64-bit FNV-1a hash of a byte range.
+        static std::uint64_t fnv1a(const void* data, const std::size_t& size) noexcept {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            std::uint64_t hash = 14695981039346656037ULL;
+            for (std::size_t i = 0; i < size; ++i) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        /// \brief Computes the 64-bit FNV-1a hash of the low bytes of an integer in little-endian order.
+        /// \param bits The integer.
+        /// \param size Number of bytes to hash.
+        static std::uint64_t fnv1a_le(const std::uint64_t& bits, const std::size_t& size) noexcept {
+            std::uint64_t hash = 14695981039346656037ULL;
+            for (std::size_t i = 0; i < size; ++i) {
+                hash ^= (bits >> (8 * i)) & 0xFF;
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+    };
+
+    /// \brief Shard hash function for strings and BLOB values (std::vector<char> or std::vector<uint8_t>).
+    template<typename T>
+    struct ShardHash<T, typename std::enable_if<
+            std::is_same<T, std::string>::value ||
+            std::is_same<T, std::vector<char>>::value ||
+            std::is_same<T, std::vector<uint8_t>>::value>::type> {
+        std::uint64_t operator()(const T& value) const noexcept {
+            return ShardHash<char>::fnv1a(value.data(), value.size());
+        }
+    };
+
+    /// \class ShardedDB
+    /// \brief Spreads keys across several containers, each on its own database file and connection.
+    /// \tparam KeyT Type of the keys.
+    /// \tparam ShardT Type of the container of one shard (e.g., KeyValueDB or KeyDB).
+    /// \tparam HashT Hash function that selects the shard of a key.
+    /// \details SQLite allows one writer per database file, so writes to different shards run in parallel. Bulk
+    /// operations are split by shard and run on a thread pool. Every shard commits on its own: an operation
+    /// that touches several shards is not atomic across them.
+    template<class KeyT, class ShardT, class HashT = ShardHash<KeyT>>
+    class ShardedDB {
+    public:
+
+        /// \brief Default constructor. Call set_config() before connect().
+        ShardedDB() = default;
+
+        /// \brief Constructor with configuration.
+        /// \param config Configuration shared by the shards; `Config::db_path` gets a shard suffix.
+        /// \param shard_count Number of shards.
+        /// \param threads Number of threads running bulk operations; 0 uses one thread per shard.
+        /// \throws sqlite_exception if `shard_count` is 0.
+        ShardedDB(const Config& config, const std::size_t& shard_count, const std::size_t& threads = 0) {
+            set_config(config, shard_count, threads);
+        }
+
+        ShardedDB(const ShardedDB&) = delete;
+        ShardedDB& operator=(const ShardedDB&) = delete;
+
+        virtual ~ShardedDB() = default;
+
+        /// \brief Creates the shards.
+        /// The number of shards must not change once data is written, since it decides which file holds a key.
+        /// \param config Configuration shared by the shards; `Config::db_path` gets a shard suffix.
+        /// \param shard_count Number of shards.
+        /// \param threads Number of threads running bulk operations; 0 uses one thread per shard.
+        /// \throws sqlite_exception if `shard_count` is 0.
+        void set_config(const Config& config, const std::size_t& shard_count, const std::size_t& threads = 0) {
+            if (shard_count == 0) throw sqlite_exception("Shard count must be greater than zero.");
+            std::vector<std::unique_ptr<ShardT>> shards;
+            shards.reserve(shard_count);
+            for (std::size_t i = 0; i < shard_count; ++i) {
+                Config shard_config = config;
+                shard_config.db_path = shard_path(config.db_path, i);
+                shards.emplace_back(new ShardT(shard_config));
+            }
+            m_shards = std::move(shards);
+            m_pool.reset(shard_count > 1 ? new ThreadPool(threads ? threads : shard_count) : nullptr);
+        }
+
+        /// \brief Returns the path of the database file of a shard.
+        /// The shard index is inserted before the extension: `data/kv.db` becomes `data/kv.0.db`, `data/kv.1.db`, ...
+        /// \param db_path Path from the configuration.
+        /// \param index Index of the shard.
+        /// \return Path of the shard.
+        static std::string shard_path(const std::string& db_path, const std::size_t& index) {
+            if (db_path.empty()) return db_path;
+            fs::path path(db_path);
+            fs::path file_name = path.stem();
+            file_name += "." + std::to_string(index);
+            file_name += path.extension();
+            return (path.parent_path() / file_name).string();
+        }
+
+        /// \brief Connects all shards in parallel.
+        /// \throws sqlite_exception if a shard fails to connect.
+        void connect() {
+            for_each_shard([](ShardT& shard, std::size_t) {
+                shard.connect();
+            });
+        }
+
+        /// \brief Disconnects all shards.
+        /// \throws sqlite_exception if a shard fails to disconnect.
+        void disconnect() {
+            for_each_shard([](ShardT& shard, std::size_t) {
+                shard.disconnect();
+            });
+        }
+
+        /// \brief Waits until the pending writes of all shards are committed.
+        /// \throws sqlite_exception if a write of a shard failed.
+        void flush() {
+            for_each_shard([](ShardT& shard, std::size_t) {
+                shard.flush();
+            });
+        }
+
+        /// \brief Returns the number of shards.
+        std::size_t shard_count() const noexcept {
+            return m_shards.size();
+        }
+
+        /// \brief Returns the index of the shard holding a key.
+        /// \param key The key.
+        std::size_t shard_index(const KeyT& key) const {
+            return static_cast<std::size_t>(HashT()(key) % m_shards.size());
+        }
+
+        /// \brief Returns a shard by index.
+        /// \param index Index of the shard.
+        ShardT& shard(const std::size_t& index) {
+            return *m_shards[index];
+        }
+
+        /// \brief Returns the shard holding a key.
+        /// \param key The key.
+        ShardT& shard_of(const KeyT& key) {
+            return *m_shards[shard_index(key)];
+        }
+
+    protected:
+        std::vector<std::unique_ptr<ShardT>> m_shards;  ///< Containers of the shards.
+        std::unique_ptr<ThreadPool>          m_pool;    ///< Threads running bulk operations; null with one shard.
+
+        /// \brief Runs a function for every shard on the thread pool and waits for all of them.
+        /// If several calls throw, the first exception by shard index is rethrown once all calls are done.
+        /// \tparam Func Callable `void(ShardT&, std::size_t index)`.
+        /// \param func Function to run.
+        template<typename Func>
+        void for_each_shard(Func func) {
+            if (!m_pool) {
+                for (std::size_t i = 0; i < m_shards.size(); ++i) {
+                    func(*m_shards[i], i);
+                }
+                return;
+            }
+            m_pool->parallel_for(m_shards.size(), [this, &func](std::size_t i) {
+                func(*m_shards[i], i);
+            });
+        }
+
+        /// \brief Creates one empty container per shard, each using the allocator of the given container.
+        /// Copying an empty container would not do, since a `std::pmr` container copy takes the default resource.
+        /// \param container Container whose allocator the parts use.
+        /// \return One empty container of the same type per shard.
+        template<class ContainerT>
+        std::vector<ContainerT> make_parts(const ContainerT& container) const {
+            std::vector<ContainerT> parts;
+            parts.reserve(m_shards.size());
+            for (std::size_t i = 0; i < m_shards.size(); ++i) {
+                parts.emplace_back(container.get_allocator());
+            }
+            return parts;
+        }
+
+        /// \brief Splits the elements of a container by shard.
+        /// \tparam ContainerT Type of the container.
+        /// \tparam KeyFunc Callable returning the key of an element.
+        /// \param container Container to split.
+        /// \param get_key Function returning the key of an element.
+        /// \return One container of the same type per shard.
+        template<class ContainerT, typename KeyFunc>
+        std::vector<ContainerT> split(const ContainerT& container, KeyFunc get_key) const {
+            std::vector<ContainerT> parts = make_parts(container);
+            for (const auto& item : container) {
+                ContainerT& part = parts[shard_index(get_key(item))];
+                part.insert(part.end(), item);
+            }
+            return parts;
+        }
+
+        /// \brief Sums the reconcile counts of the shards.
+        static ReconcileStats sum_stats(const std::vector<ReconcileStats>& stats) {
+            ReconcileStats total;
+            for (const auto& item : stats) {
+                total.inserted += item.inserted;
+                total.updated += item.updated;
+                total.removed += item.removed;
+            }
+            return total;
+        }
+    }; // ShardedDB
+
+}; // namespace sqlite_containers
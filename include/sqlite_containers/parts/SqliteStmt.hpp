@@ -3,11 +3,14 @@
 /// \file SqliteStmt.hpp
 /// \brief Declaration of the SqliteStmt class for managing SQLite prepared statements.
 
-#include "Utils.hpp"
+#include "Codec.hpp"
 
 namespace sqlite_containers {
 
     /// \brief Class for managing SQLite prepared statements.
+    /// \details A statement is either prepared at once by init() or deferred by defer(), in which case it is
+    /// prepared on first use. Long-lived statements can be prepared with `SQLITE_PREPARE_PERSISTENT` (SQLite 3.20
+    /// and later), which keeps them out of the lookaside memory meant for short-lived allocations.
     class SqliteStmt {
     public:
 
@@ -17,64 +20,112 @@ namespace sqlite_containers {
         /// \brief Constructs a SqliteStmt and prepares the statement.
         /// \param sqlite_db Pointer to the SQLite database.
         /// \param query SQL query to prepare.
+        /// \param persistent True if the statement is kept and reused for a long time.
         /// \throws sqlite_exception if the query preparation fails.
-        SqliteStmt(sqlite3 *sqlite_db, const char *query) {
-            init(sqlite_db, query);
+        SqliteStmt(sqlite3 *sqlite_db, const char *query, const bool &persistent = false) {
+            init(sqlite_db, query, persistent);
         }
 
         /// \brief Constructs a SqliteStmt and prepares the statement.
         /// \param sqlite_db Pointer to the SQLite database.
         /// \param query SQL query to prepare.
+        /// \param persistent True if the statement is kept and reused for a long time.
         /// \throws sqlite_exception if the query preparation fails.
-        SqliteStmt(sqlite3 *sqlite_db, const std::string &query) {
-            init(sqlite_db, query);
+        SqliteStmt(sqlite3 *sqlite_db, const std::string &query, const bool &persistent = false) {
+            init(sqlite_db, query, persistent);
+        }
+
+        SqliteStmt(const SqliteStmt&) = delete;
+        SqliteStmt& operator=(const SqliteStmt&) = delete;
+
+        /// \brief Move constructor.
+        SqliteStmt(SqliteStmt&& other) noexcept :
+                m_stmt(other.m_stmt),
+                m_sqlite_db(other.m_sqlite_db),
+                m_query(std::move(other.m_query)),
+                m_persistent(other.m_persistent) {
+            other.m_stmt = nullptr;
+            other.m_sqlite_db = nullptr;
+        }
+
+        /// \brief Move assignment. Finalizes the current statement first.
+        SqliteStmt& operator=(SqliteStmt&& other) noexcept {
+            if (this != &other) {
+                finalize();
+                m_stmt = other.m_stmt;
+                m_sqlite_db = other.m_sqlite_db;
+                m_query = std::move(other.m_query);
+                m_persistent = other.m_persistent;
+                other.m_stmt = nullptr;
+                other.m_sqlite_db = nullptr;
+            }
+            return *this;
         }
 
         /// \brief Destructor.
         ~SqliteStmt() {
-            if (!m_stmt) return;
-            sqlite3_finalize(m_stmt);
-            m_stmt = nullptr;
+            finalize();
         }
 
         /// \brief Initializes the statement.
+        /// Finalizes the statement prepared before, if any.
         /// \param sqlite_db Pointer to the SQLite database.
         /// \param query SQL query to prepare.
+        /// \param persistent True if the statement is kept and reused for a long time.
         /// \throws sqlite_exception if the query preparation fails.
-        void init(sqlite3 *sqlite_db, const char *query) {
-            int err;
-            do {
-                err = sqlite3_prepare_v2(sqlite_db, query, -1, &m_stmt, nullptr);
-                if (err == SQLITE_BUSY) {
-                    sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
-                } else
-                if (err != SQLITE_OK) {
-                    std::string err_msg = "Failed to prepare SQL statement: ";
-                    err_msg += std::string(query);
-                    err_msg += ". Error code: ";
-                    err_msg += std::to_string(err);
-                    throw sqlite_exception(err_msg, err);
-                }
-            } while (err == SQLITE_BUSY);
+        void init(sqlite3 *sqlite_db, const char *query, const bool &persistent = false) {
+            finalize();
+            prepare(sqlite_db, query, persistent);
         }
 
         /// \brief Initializes the statement.
+        /// Finalizes the statement prepared before, if any.
         /// \param sqlite_db Pointer to the SQLite database.
         /// \param query SQL query to prepare.
+        /// \param persistent True if the statement is kept and reused for a long time.
         /// \throws sqlite_exception if the query preparation fails.
-        void init(sqlite3 *sqlite_db, const std::string &query) {
-            init(sqlite_db, query.c_str());
+        void init(sqlite3 *sqlite_db, const std::string &query, const bool &persistent = false) {
+            init(sqlite_db, query.c_str(), persistent);
+        }
+
+        /// \brief Initializes the statement without preparing it.
+        /// The statement is prepared on its first use, so statements that are rarely needed cost nothing
+        /// until then. Finalizes the statement prepared before, if any.
+        /// \param sqlite_db Pointer to the SQLite database.
+        /// \param query SQL query to prepare.
+        /// \param persistent True if the statement is kept and reused for a long time.
+        void defer(sqlite3 *sqlite_db, const std::string &query, const bool &persistent = false) {
+            finalize();
+            m_sqlite_db = sqlite_db;
+            m_query = query;
+            m_persistent = persistent;
         }
 
-        /// \brief Gets the prepared SQLite statement.
+        /// \brief Finalizes the statement.
+        void finalize() noexcept {
+            if (m_stmt) sqlite3_finalize(m_stmt);
+            m_stmt = nullptr;
+            m_sqlite_db = nullptr;
+            m_query.clear();
+        }
+
+        /// \brief Checks whether the statement is prepared.
+        bool is_prepared() const noexcept {
+            return m_stmt != nullptr;
+        }
+
+        /// \brief Gets the prepared SQLite statement, preparing a deferred statement first.
         /// \return Pointer to the prepared SQLite statement.
-        sqlite3_stmt *get_stmt() noexcept {
+        /// \throws sqlite_exception if the preparation of a deferred statement fails.
+        sqlite3_stmt *get_stmt() {
+            if (!m_stmt && m_sqlite_db) prepare(m_sqlite_db, m_query.c_str(), m_persistent);
             return m_stmt;
         }
 
         /// \brief Resets the prepared statement.
         /// \throws sqlite_exception if the reset operation fails.
         void reset() {
+            if (!m_stmt) return;
             const int err = sqlite3_reset(m_stmt);
             if (err == SQLITE_OK) return;
             throw sqlite_exception("Failed to reset SQL statement. Error code: " + std::to_string(err), err);
@@ -83,6 +134,7 @@ namespace sqlite_containers {
         /// \brief Clears all bindings on the prepared statement.
         /// \throws sqlite_exception if the clear bindings operation fails.
         void clear_bindings() {
+            if (!m_stmt) return;
             const int err = sqlite3_clear_bindings(m_stmt);
             if (err == SQLITE_OK) return;
             throw sqlite_exception("Failed to clear bindings on SQL statement. Error code: " + std::to_string(err), err);
@@ -92,132 +144,86 @@ namespace sqlite_containers {
         /// \param sqlite_db Pointer to the SQLite database.
         /// \throws sqlite_exception if the execution fails.
         void execute(sqlite3 *sqlite_db) {
-            sqlite_containers::execute(sqlite_db, m_stmt);
+            sqlite_containers::execute(sqlite_db, get_stmt());
         }
 
         /// \brief Executes the prepared statement.
         /// \throws sqlite_exception if the execution fails.
         void execute() {
-            sqlite_containers::execute(m_stmt);
+            sqlite_containers::execute(get_stmt());
         }
 
         /// brief Advances the prepared statement to the next result row or completion.
         /// return Result code: SQLITE_ROW for a new row, SQLITE_DONE for completion, or an error code.
         int step() {
-            return sqlite3_step(m_stmt);
+            return sqlite3_step(get_stmt());
         }
 
         /// \brief Extracts a value from a SQLite statement column.
+        /// The column is decoded by `Codec<T>`.
         /// \param index Index of the column to extract.
         /// \return The extracted value.
         template<typename T>
-        inline T extract_column(const int &index,
-                typename std::enable_if<std::is_integral<T>::value>::type* = 0) {
-            return static_cast<T>(sqlite3_column_int64(m_stmt, index));
-        }
-
-        template<typename T>
-        inline T extract_column(const int &index,
-                typename std::enable_if<std::is_floating_point<T>::value>::type* = 0) {
-            return static_cast<T>(sqlite3_column_double(m_stmt, index));
-        }
-
-        template<typename T>
-        inline T extract_column(const int &index,
-                typename std::enable_if<std::is_same<T, std::string>::value>::type* = 0) {
-            const unsigned char *text = sqlite3_column_text(m_stmt, index);
-            if (text) {
-                return std::string(reinterpret_cast<const char*>(text));
-            }
-            return std::string();
-        }
-
-        template<typename T>
-        inline T extract_column(const int &index,
-                typename std::enable_if<std::is_same<T, std::vector<char>>::value>::type* = 0) {
-            const void* blob = sqlite3_column_blob(m_stmt, index);
-            const int blob_size = sqlite3_column_bytes(m_stmt, index);
-            return std::vector<char>(static_cast<const char*>(blob), static_cast<const char*>(blob) + blob_size);
-        }
-
-        template<typename T>
-        inline T extract_column(const int &index,
-                typename std::enable_if<std::is_same<T, std::vector<uint8_t>>::value>::type* = 0) {
-            const void* blob = sqlite3_column_blob(m_stmt, index);
-            const int blob_size = sqlite3_column_bytes(m_stmt, index);
-            return std::vector<uint8_t>(static_cast<const uint8_t*>(blob), static_cast<const uint8_t*>(blob) + blob_size);
+        inline T extract_column(const int &index) {
+            T value;
+            Codec<T>::extract(m_stmt, index, value);
+            return value;
         }
 
+        /// \brief Extracts a column into an existing object.
+        /// Strings and vectors reuse their storage.
+        /// \param index Index of the column to extract.
+        /// \param value Object receiving the value.
         template<typename T>
-        inline T extract_column(const int &index,
-                typename std::enable_if<
-                    !std::is_integral<T>::value &&
-                    !std::is_floating_point<T>::value &&
-                    !std::is_same<T, std::string>::value &&
-                    !std::is_same<T, std::vector<char>>::value &&
-                    !std::is_same<T, std::vector<uint8_t>>::value &&
-                    std::is_trivially_copyable<T>::value
-                >::type* = 0) {
-            T value;
-            const void* blob = sqlite3_column_blob(m_stmt, index);
-            const int blob_size = sqlite3_column_bytes(m_stmt, index);
-            if (blob_size == sizeof(T)) {
-                std::memcpy(&value, blob, sizeof(T));
-            } else {
-                throw sqlite_exception("Blob size does not match POD size.");
-            }
-            return value;
+        inline void extract_column(const int &index, T& value) {
+            Codec<T>::extract(m_stmt, index, value);
         }
 
         /// \brief Binds a value to a SQLite statement.
+        /// The value is encoded by `Codec<T>`; text and BLOB values are not copied and must stay alive until
+        /// the statement is reset.
         /// \param index Index of the parameter to bind.
         /// \param value The value to bind.
         /// \return True if the value was successfully bound, otherwise false.
         template<typename T>
-        inline bool bind_value(const int &index, const T& value,
-                typename std::enable_if<std::is_integral<T>::value>::type* = 0) {
-            return (sqlite3_bind_int64(m_stmt, index, static_cast<int64_t>(value)) == SQLITE_OK);
-        }
-
-        template<typename T>
-        inline bool bind_value(const int &index, const T& value,
-                typename std::enable_if<std::is_floating_point<T>::value>::type* = 0) {
-            return (sqlite3_bind_double(m_stmt, index, static_cast<double>(value)) == SQLITE_OK);
+        inline bool bind_value(const int &index, const T& value) {
+            return Codec<T>::bind(get_stmt(), index, value) == SQLITE_OK;
         }
 
-        template<typename T>
-        inline bool bind_value(const int &index, const T& value,
-                typename std::enable_if<std::is_same<T, std::string>::value>::type* = 0) {
-            return (sqlite3_bind_text(m_stmt, index, value.c_str(), -1, SQLITE_STATIC) == SQLITE_OK);
-        }
-
-        template<typename T>
-        inline bool bind_value(const int &index, const T& value,
-                typename std::enable_if<std::is_same<T, std::vector<char>>::value>::type* = 0) {
-            return (sqlite3_bind_blob(m_stmt, index, value.data(), value.size(), SQLITE_STATIC) == SQLITE_OK);
-        }
-
-        template<typename T>
-        inline bool bind_value(const int &index, const T& value,
-                typename std::enable_if<std::is_same<T, std::vector<uint8_t>>::value>::type* = 0) {
-            return (sqlite3_bind_blob(m_stmt, index, value.data(), value.size(), SQLITE_STATIC) == SQLITE_OK);
-        }
+    private:
+        sqlite3_stmt *m_stmt = nullptr;     ///< Pointer to the prepared SQLite statement.
+        sqlite3     *m_sqlite_db = nullptr; ///< Database of a deferred statement.
+        std::string  m_query;               ///< SQL query of a deferred statement.
+        bool         m_persistent = false;  ///< Whether the statement is prepared with `SQLITE_PREPARE_PERSISTENT`.
 
-        template<typename T>
-        inline bool bind_value(const int &index, const T& value,
-                typename std::enable_if<
-                    !std::is_integral<T>::value &&
-                    !std::is_floating_point<T>::value &&
-                    !std::is_same<T, std::string>::value &&
-                    !std::is_same<T, std::vector<char>>::value &&
-                    !std::is_same<T, std::vector<uint8_t>>::value &&
-                    std::is_trivially_copyable<T>::value
-                >::type* = 0) {
-            return (sqlite3_bind_blob(m_stmt, index, &value, sizeof(T), SQLITE_STATIC) == SQLITE_OK);
+        /// \brief Prepares the statement, retrying while the database is busy.
+        /// \param sqlite_db Pointer to the SQLite database.
+        /// \param query SQL query to prepare.
+        /// \param persistent True if the statement is kept and reused for a long time.
+        /// \throws sqlite_exception if the query preparation fails.
+        void prepare(sqlite3 *sqlite_db, const char *query, const bool &persistent) {
+            BusyRetry busy_retry(sqlite_db);
+            int err;
+            do {
+#               if SQLITE_VERSION_NUMBER >= 3020000
+                const unsigned int flags = persistent ? SQLITE_PREPARE_PERSISTENT : 0;
+                err = sqlite3_prepare_v3(sqlite_db, query, -1, flags, &m_stmt, nullptr);
+#               else
+                (void)persistent;
+                err = sqlite3_prepare_v2(sqlite_db, query, -1, &m_stmt, nullptr);
+#               endif
+                if (err == SQLITE_BUSY) {
+                    busy_retry.wait();
+                } else
+                if (err != SQLITE_OK) {
+                    std::string err_msg = "Failed to prepare SQL statement: ";
+                    err_msg += std::string(query);
+                    err_msg += ". Error code: ";
+                    err_msg += std::to_string(err);
+                    throw sqlite_exception(err_msg, err);
+                }
+            } while (err == SQLITE_BUSY);
         }
-
-    private:
-        sqlite3_stmt *m_stmt = nullptr; ///< Pointer to the prepared SQLite statement.
     }; // SqliteStmt
 
 }; // namespace sqlite_containers
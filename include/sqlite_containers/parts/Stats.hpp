@@ -0,0 +1,300 @@
+#pragma once
+
+/// \file Stats.hpp
+/// \brief Operation latency histograms and snapshots of the SQLite counters of a connection.
+
+#include "Utils.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace sqlite_containers {
+
+    /// \enum StatsOperation
+    /// \brief Container operations timed when `SQLITE_CONTAINERS_ENABLE_STATS` is defined.
+    enum class StatsOperation {
+        INSERT,     ///< Single-row writes.
+        FIND,       ///< Lookups of one key.
+        LOAD,       ///< Reads of the whole table.
+        RECONCILE,  ///< Reconciles of the table with a container.
+        COMMIT,     ///< Commits of transactions.
+        COUNT       ///< Number of operations, not an operation.
+    };
+
+    /// \brief Converts StatsOperation enum to string representation.
+    /// \param operation The StatsOperation enum value.
+    /// \return Lower-case name of the operation.
+    inline std::string to_string(const StatsOperation &operation) {
+        static const std::array<std::string, 5> data = {
+            "insert",
+            "find",
+            "load",
+            "reconcile",
+            "commit"
+        };
+        return data[static_cast<size_t>(operation)];
+    }
+
+    /// \brief Number of buckets of a latency histogram.
+    /// Bucket `i` counts latencies below `2^i` microseconds; the last bucket counts all longer ones.
+    constexpr std::size_t STATS_HISTOGRAM_BUCKETS = 26;
+
+    /// \brief Latencies of one operation.
+    struct OperationStats {
+        uint64_t count = 0;     ///< Number of timed calls.
+        uint64_t total_ns = 0;  ///< Total time of the calls in nanoseconds.
+        std::array<uint64_t, STATS_HISTOGRAM_BUCKETS> buckets{}; ///< Calls per latency bucket (not cumulative).
+    };
+
+    /// \class LatencyHistogram
+    /// \brief Lock-free histogram of the latencies of one operation.
+    class LatencyHistogram {
+    public:
+
+        /// \brief Records one call.
+        /// \param ns Time of the call in nanoseconds.
+        void record(const uint64_t &ns) noexcept {
+            uint64_t us = ns / 1000;
+            std::size_t bucket = 0;
+            while (us && bucket + 1 < STATS_HISTOGRAM_BUCKETS) {
+                us >>= 1;
+                ++bucket;
+            }
+            m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_total_ns.fetch_add(ns, std::memory_order_relaxed);
+        }
+
+        /// \brief Returns the recorded latencies.
+        OperationStats snapshot() const noexcept {
+            OperationStats stats;
+            stats.count = m_count.load(std::memory_order_relaxed);
+            stats.total_ns = m_total_ns.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < STATS_HISTOGRAM_BUCKETS; ++i) {
+                stats.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+            }
+            return stats;
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, STATS_HISTOGRAM_BUCKETS> m_buckets{}; ///< Calls per latency bucket.
+        std::atomic<uint64_t> m_count = ATOMIC_VAR_INIT(0);     ///< Number of calls.
+        std::atomic<uint64_t> m_total_ns = ATOMIC_VAR_INIT(0);  ///< Total time of the calls.
+    }; // LatencyHistogram
+
+    /// \brief Latency histograms of all timed operations of a container.
+    using OperationHistograms = std::array<LatencyHistogram, static_cast<std::size_t>(StatsOperation::COUNT)>;
+
+    /// \class LatencyTimer
+    /// \brief Records the time from its construction to its destruction into a histogram.
+    class LatencyTimer {
+    public:
+
+        /// \brief Starts timing an operation.
+        /// \param histograms Histograms of the container.
+        /// \param operation The timed operation.
+        LatencyTimer(OperationHistograms &histograms, const StatsOperation &operation) noexcept :
+            m_histogram(histograms[static_cast<std::size_t>(operation)]),
+            m_start(std::chrono::steady_clock::now()) {}
+
+        LatencyTimer(const LatencyTimer&) = delete;
+        LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+        /// \brief Records the time of the operation, including the time of a failed one.
+        ~LatencyTimer() {
+            const auto elapsed = std::chrono::steady_clock::now() - m_start;
+            m_histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+    private:
+        LatencyHistogram&                       m_histogram;    ///< Histogram of the operation.
+        std::chrono::steady_clock::time_point   m_start;        ///< Start of the operation.
+    }; // LatencyTimer
+
+/// \brief Times the rest of the enclosing scope as `operation` in `histograms` (an OperationHistograms).
+/// Expands to nothing unless `SQLITE_CONTAINERS_ENABLE_STATS` is defined.
+#ifdef SQLITE_CONTAINERS_ENABLE_STATS
+#define SQLITE_CONTAINERS_STATS_TIMER(histograms, operation) \
+    ::sqlite_containers::LatencyTimer sqlite_containers_latency_timer(histograms, operation)
+#else
+#define SQLITE_CONTAINERS_STATS_TIMER(histograms, operation) ((void)0)
+#endif
+
+    /// \brief Page cache and memory counters of a connection, from `sqlite3_db_status()`.
+    struct DbStatusStats {
+        int64_t cache_hits = 0;         ///< Page cache hits.
+        int64_t cache_misses = 0;       ///< Page cache misses.
+        int64_t cache_writes = 0;       ///< Dirty pages written to the file.
+        int64_t cache_used_bytes = 0;   ///< Heap memory used by the page cache.
+        int64_t schema_used_bytes = 0;  ///< Heap memory used by the schema.
+        int64_t stmt_used_bytes = 0;    ///< Heap memory used by the prepared statements.
+        int64_t lookaside_used = 0;     ///< Lookaside memory slots in use.
+    };
+
+    /// \brief Counters of one prepared statement, from `sqlite3_stmt_status()`.
+    struct StmtStats {
+        std::string sql;                ///< SQL text of the statement.
+        int64_t     fullscan_steps = 0; ///< Steps of full table scans.
+        int64_t     sorts = 0;          ///< Sort operations.
+        int64_t     autoindexes = 0;    ///< Rows inserted into automatic indexes.
+        int64_t     vm_steps = 0;       ///< Virtual machine operations.
+        int64_t     reprepares = 0;     ///< Automatic re-preparations after schema changes.
+        int64_t     runs = 0;           ///< Completed runs (SQLite 3.20 and later).
+    };
+
+    /// \brief Snapshot of the statistics of a container.
+    struct StatsSnapshot {
+        bool            timed = false;  ///< Whether the operations were timed (`SQLITE_CONTAINERS_ENABLE_STATS`).
+        std::array<OperationStats, static_cast<std::size_t>(StatsOperation::COUNT)> operations{}; ///< Latencies indexed by StatsOperation.
+        BusyStats       busy;           ///< Waits for a busy database.
+        DbStatusStats   db;             ///< Counters of the main connection.
+        std::vector<StmtStats> statements; ///< Counters of the statements prepared on the main connection.
+
+        /// \brief Returns the latencies of one operation.
+        const OperationStats &operation(const StatsOperation &operation) const {
+            return operations[static_cast<std::size_t>(operation)];
+        }
+
+        /// \brief Formats the snapshot in the Prometheus text exposition format.
+        /// \param labels Labels added to every sample, e.g. `table="orders"`; may be empty.
+        /// \param prefix Prefix of the metric names.
+        /// \return The metrics, one sample per line.
+        std::string to_prometheus(const std::string &labels = std::string(), const std::string &prefix = "sqlite_containers") const {
+            std::ostringstream out;
+            const auto label_set = [&labels](const std::string &extra) {
+                if (labels.empty() && extra.empty()) return std::string();
+                std::string text = "{" + labels;
+                if (!labels.empty() && !extra.empty()) text += ",";
+                return text + extra + "}";
+            };
+            const auto counter = [&](const std::string &name, const std::string &type, const std::string &help, const int64_t &value) {
+                out << "# HELP " << prefix << "_" << name << " " << help << "\n";
+                out << "# TYPE " << prefix << "_" << name << " " << type << "\n";
+                out << prefix << "_" << name << label_set(std::string()) << " " << value << "\n";
+            };
+
+            if (timed) {
+                const std::string name = prefix + "_operation_seconds";
+                out << "# HELP " << name << " Latency of container operations.\n";
+                out << "# TYPE " << name << " histogram\n";
+                for (std::size_t i = 0; i < operations.size(); ++i) {
+                    const OperationStats &stats = operations[i];
+                    const std::string op = "operation=\"" + to_string(static_cast<StatsOperation>(i)) + "\"";
+                    uint64_t cumulative = 0;
+                    for (std::size_t j = 0; j + 1 < STATS_HISTOGRAM_BUCKETS; ++j) {
+                        cumulative += stats.buckets[j];
+                        std::ostringstream bound;
+                        bound << static_cast<double>(uint64_t(1) << j) * 1e-6;
+                        out << name << "_bucket" << label_set(op + ",le=\"" + bound.str() + "\"") << " " << cumulative << "\n";
+                    }
+                    out << name << "_bucket" << label_set(op + ",le=\"+Inf\"") << " " << stats.count << "\n";
+                    out << name << "_sum" << label_set(op) << " " << static_cast<double>(stats.total_ns) * 1e-9 << "\n";
+                    out << name << "_count" << label_set(op) << " " << stats.count << "\n";
+                }
+            }
+
+            counter("busy_retries_total", "counter", "Waits for a busy database.", static_cast<int64_t>(busy.retries));
+            out << "# HELP " << prefix << "_busy_wait_seconds_total Time spent waiting for a busy database.\n";
+            out << "# TYPE " << prefix << "_busy_wait_seconds_total counter\n";
+            out << prefix << "_busy_wait_seconds_total" << label_set(std::string()) << " " << static_cast<double>(busy.wait_us) * 1e-6 << "\n";
+            counter("busy_timeouts_total", "counter", "Waits that gave up.", static_cast<int64_t>(busy.timeouts));
+
+            counter("cache_hits_total", "counter", "Page cache hits.", db.cache_hits);
+            counter("cache_misses_total", "counter", "Page cache misses.", db.cache_misses);
+            counter("cache_writes_total", "counter", "Dirty pages written to the file.", db.cache_writes);
+            counter("cache_used_bytes", "gauge", "Heap memory used by the page cache.", db.cache_used_bytes);
+            counter("schema_used_bytes", "gauge", "Heap memory used by the schema.", db.schema_used_bytes);
+            counter("stmt_used_bytes", "gauge", "Heap memory used by prepared statements.", db.stmt_used_bytes);
+            counter("lookaside_used", "gauge", "Lookaside memory slots in use.", db.lookaside_used);
+
+            const std::array<std::pair<const char*, const char*>, 6> stmt_metrics = {{
+                {"stmt_fullscan_steps_total", "Steps of full table scans per statement."},
+                {"stmt_sorts_total", "Sort operations per statement."},
+                {"stmt_autoindexes_total", "Rows inserted into automatic indexes per statement."},
+                {"stmt_vm_steps_total", "Virtual machine operations per statement."},
+                {"stmt_reprepares_total", "Re-preparations per statement."},
+                {"stmt_runs_total", "Completed runs per statement."}
+            }};
+            for (std::size_t i = 0; i < stmt_metrics.size(); ++i) {
+                if (statements.empty()) break;
+                out << "# HELP " << prefix << "_" << stmt_metrics[i].first << " " << stmt_metrics[i].second << "\n";
+                out << "# TYPE " << prefix << "_" << stmt_metrics[i].first << " counter\n";
+                for (const auto &stmt : statements) {
+                    const int64_t values[] = {stmt.fullscan_steps, stmt.sorts, stmt.autoindexes, stmt.vm_steps, stmt.reprepares, stmt.runs};
+                    out << prefix << "_" << stmt_metrics[i].first << label_set("sql=\"" + escape_label(stmt.sql) + "\"") << " " << values[i] << "\n";
+                }
+            }
+            return out.str();
+        }
+
+    private:
+
+        /// \brief Escapes a Prometheus label value.
+        static std::string escape_label(const std::string &value) {
+            std::string text;
+            text.reserve(value.size());
+            for (const char c : value) {
+                if (c == '\\' || c == '"') {
+                    text += '\\';
+                    text += c;
+                } else
+                if (c == '\n') {
+                    text += "\\n";
+                } else {
+                    text += c;
+                }
+            }
+            return text;
+        }
+    };
+
+    /// \brief Reads the page cache and memory counters of a connection.
+    /// \param sqlite_db Pointer to the SQLite database.
+    inline DbStatusStats get_db_status(sqlite3 *sqlite_db) {
+        DbStatusStats stats;
+        if (!sqlite_db) return stats;
+        const auto read = [sqlite_db](const int &op) -> int64_t {
+            int current = 0;
+            int highwater = 0;
+            if (sqlite3_db_status(sqlite_db, op, &current, &highwater, 0) != SQLITE_OK) return 0;
+            return current;
+        };
+        stats.cache_hits = read(SQLITE_DBSTATUS_CACHE_HIT);
+        stats.cache_misses = read(SQLITE_DBSTATUS_CACHE_MISS);
+        stats.cache_writes = read(SQLITE_DBSTATUS_CACHE_WRITE);
+        stats.cache_used_bytes = read(SQLITE_DBSTATUS_CACHE_USED);
+        stats.schema_used_bytes = read(SQLITE_DBSTATUS_SCHEMA_USED);
+        stats.stmt_used_bytes = read(SQLITE_DBSTATUS_STMT_USED);
+        stats.lookaside_used = read(SQLITE_DBSTATUS_LOOKASIDE_USED);
+        return stats;
+    }
+
+    /// \brief Reads the counters of every statement prepared on a connection.
+    /// Statements that never ran are skipped.
+    /// \param sqlite_db Pointer to the SQLite database.
+    inline std::vector<StmtStats> get_stmt_status(sqlite3 *sqlite_db) {
+        std::vector<StmtStats> result;
+        if (!sqlite_db) return result;
+        for (sqlite3_stmt *stmt = sqlite3_next_stmt(sqlite_db, nullptr); stmt; stmt = sqlite3_next_stmt(sqlite_db, stmt)) {
+            StmtStats stats;
+            stats.vm_steps = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_VM_STEP, 0);
+            if (stats.vm_steps == 0) continue;
+            const char *sql = sqlite3_sql(stmt);
+            stats.sql = sql ? sql : "";
+            stats.fullscan_steps = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 0);
+            stats.sorts = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 0);
+            stats.autoindexes = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 0);
+            stats.reprepares = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_REPREPARE, 0);
+#           if SQLITE_VERSION_NUMBER >= 3020000
+            stats.runs = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_RUN, 0);
+#           endif
+            result.push_back(std::move(stats));
+        }
+        return result;
+    }
+
+}; // namespace sqlite_containers
@@ -0,0 +1,137 @@
+#pragma once
+
+/// \file StmtCache.hpp
+/// \brief Declaration of the StmtCache class, prepared statements of one connection keyed by their SQL text.
+
+#include "SqliteStmt.hpp"
+#include <cctype>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/// \brief Default number of statements kept by a StmtCache.
+#ifndef SQLITE_CONTAINERS_STMT_CACHE_SIZE
+#define SQLITE_CONTAINERS_STMT_CACHE_SIZE 64
+#endif
+
+namespace sqlite_containers {
+
+    /// \class StmtCache
+    /// \brief Least recently used cache of the prepared statements of one connection, keyed by SQL text.
+    /// \details SQL run again and again is prepared once and then only reset, instead of being parsed and planned
+    /// on every call. Statements are prepared with `SQLITE_PREPARE_PERSISTENT`. Text holding more than one statement
+    /// cannot be kept as a single prepared statement, so execute() runs it with `sqlite3_exec()` every time.
+    /// The cache is not thread-safe; it is used under the lock of its connection.
+    class StmtCache {
+    public:
+
+        /// \brief Default constructor.
+        StmtCache() = default;
+
+        StmtCache(const StmtCache&) = delete;
+        StmtCache& operator=(const StmtCache&) = delete;
+
+        /// \brief Binds the cache to a connection and drops the statements prepared before.
+        /// \param sqlite_db Pointer to the SQLite database.
+        /// \param capacity Maximum number of statements kept.
+        void init(sqlite3 *sqlite_db, const std::size_t &capacity = SQLITE_CONTAINERS_STMT_CACHE_SIZE) {
+            clear();
+            m_sqlite_db = sqlite_db;
+            m_capacity = std::max<std::size_t>(capacity, 1);
+        }
+
+        /// \brief Returns the prepared statement of a query, preparing it on first use.
+        /// The reference stays valid until the statement is evicted by a later call to get() or execute().
+        /// \param query SQL text of a single statement.
+        /// \return Reference to the statement, reset and without bindings.
+        /// \throws sqlite_exception if the query cannot be prepared or holds more than one statement.
+        SqliteStmt& get(const std::string &query) {
+            Entry& entry = find(query);
+            if (!entry.single) throw sqlite_exception("Query holds more than one statement: " + query);
+            return entry.stmt;
+        }
+
+        /// \brief Executes a query through its cached statement.
+        /// \param query SQL text to execute.
+        /// \throws sqlite_exception if an error occurs during execution.
+        void execute(const std::string &query) {
+            Entry& entry = find(query);
+            if (!entry.single) {
+                sqlite_containers::execute(m_sqlite_db, query);
+                return;
+            }
+            try {
+                entry.stmt.execute();
+                entry.stmt.reset();
+            } catch (...) {
+                sqlite3_reset(entry.stmt.get_stmt());
+                throw;
+            }
+        }
+
+        /// \brief Finalizes all statements.
+        void clear() noexcept {
+            m_index.clear();
+            m_entries.clear();
+        }
+
+        /// \brief Returns the number of cached statements.
+        std::size_t size() const noexcept {
+            return m_entries.size();
+        }
+
+    private:
+
+        /// \brief Cached statement.
+        struct Entry {
+            std::string query;      ///< SQL text, the key of the entry.
+            SqliteStmt  stmt;       ///< Prepared statement; not prepared if `single` is false.
+            bool        single = true; ///< Whether the text holds exactly one statement.
+        };
+
+        using EntryList = std::list<Entry>;
+
+        sqlite3*    m_sqlite_db = nullptr;  ///< Pointer to the SQLite database.
+        std::size_t m_capacity = SQLITE_CONTAINERS_STMT_CACHE_SIZE; ///< Maximum number of statements kept.
+        EntryList   m_entries;              ///< Entries, most recently used first.
+        std::unordered_map<std::string_view, EntryList::iterator> m_index; ///< Entries indexed by their SQL text.
+
+        /// \brief Returns the entry of a query, preparing it and evicting the least recently used entry if needed.
+        /// \throws sqlite_exception if the query cannot be prepared.
+        Entry& find(const std::string &query) {
+            if (!m_sqlite_db) throw sqlite_exception("Statement cache is not bound to a connection.");
+            auto it = m_index.find(query);
+            if (it != m_index.end()) {
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+                return *it->second;
+            }
+            Entry entry;
+            entry.query = query;
+            entry.stmt.init(m_sqlite_db, query, true);
+            entry.single = is_single(entry);
+            if (!entry.single) entry.stmt.finalize();
+            while (m_entries.size() >= m_capacity) {
+                m_index.erase(m_entries.back().query);
+                m_entries.pop_back();
+            }
+            m_entries.push_front(std::move(entry));
+            m_index.emplace(m_entries.front().query, m_entries.begin());
+            return m_entries.front();
+        }
+
+        /// \brief Checks whether the prepared statement covers the whole text of its query.
+        static bool is_single(Entry &entry) {
+            sqlite3_stmt *stmt = entry.stmt.get_stmt();
+            if (!stmt) return false;
+            const char *sql = sqlite3_sql(stmt);
+            const std::size_t pos = sql ? entry.query.find(sql) : std::string::npos;
+            if (pos == std::string::npos) return false;
+            for (std::size_t i = pos + std::strlen(sql); i < entry.query.size(); ++i) {
+                if (!std::isspace(static_cast<unsigned char>(entry.query[i]))) return false;
+            }
+            return true;
+        }
+    }; // StmtCache
+
+}; // namespace sqlite_containers
@@ -0,0 +1,127 @@
+#pragma once
+
+/// \file ThreadPool.hpp
+/// \brief Declaration of the ThreadPool class used to fan work out across shards.
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sqlite_containers {
+
+    /// \class ThreadPool
+    /// \brief Fixed-size pool of worker threads running submitted tasks in FIFO order.
+    class ThreadPool {
+    public:
+
+        /// \brief Starts the worker threads.
+        /// \param threads Number of worker threads; 0 uses `std::thread::hardware_concurrency()`.
+        explicit ThreadPool(std::size_t threads = 0) {
+            if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1u);
+            m_workers.reserve(threads);
+            for (std::size_t i = 0; i < threads; ++i) {
+                m_workers.emplace_back([this] {
+                    run();
+                });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /// \brief Destructor. Finishes the queued tasks and joins the worker threads.
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> locker(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            for (auto& worker : m_workers) {
+                worker.join();
+            }
+        }
+
+        /// \brief Returns the number of worker threads.
+        std::size_t size() const noexcept {
+            return m_workers.size();
+        }
+
+        /// \brief Queues a task.
+        /// \tparam Func Callable without arguments.
+        /// \param task The task to run.
+        /// \return Future receiving the result or the exception of the task.
+        template<typename Func>
+        std::future<typename std::invoke_result<Func>::type> submit(Func task) {
+            using ResultT = typename std::invoke_result<Func>::type;
+            auto packaged = std::make_shared<std::packaged_task<ResultT()>>(std::move(task));
+            std::future<ResultT> future = packaged->get_future();
+            {
+                std::lock_guard<std::mutex> locker(m_mutex);
+                m_tasks.emplace_back([packaged] {
+                    (*packaged)();
+                });
+            }
+            m_cv.notify_one();
+            return future;
+        }
+
+        /// \brief Runs `func(i)` for every `i` in `[0, count)` on the pool and waits for all calls.
+        /// Must not be called from a task of the same pool. If several calls throw, the exception of the lowest
+        /// index is rethrown once all calls are done.
+        /// \tparam Func Callable `void(std::size_t)`.
+        /// \param count Number of calls.
+        /// \param func Function to run.
+        template<typename Func>
+        void parallel_for(const std::size_t& count, Func&& func) {
+            std::vector<std::future<void>> futures;
+            futures.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                futures.push_back(submit([&func, i]() {
+                    func(i);
+                }));
+            }
+            std::exception_ptr error;
+            for (auto& future : futures) {
+                try {
+                    future.get();
+                } catch (...) {
+                    if (!error) error = std::current_exception();
+                }
+            }
+            if (error) std::rethrow_exception(error);
+        }
+
+    private:
+        std::vector<std::thread>            m_workers;      ///< Worker threads.
+        std::deque<std::function<void()>>   m_tasks;        ///< Queued tasks.
+        std::mutex                          m_mutex;        ///< Protects the task queue.
+        std::condition_variable             m_cv;           ///< Signals new tasks and shutdown.
+        bool                                m_stop = false; ///< True once the pool is being destroyed.
+
+        /// \brief Worker loop.
+        void run() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> locker(m_mutex);
+                    m_cv.wait(locker, [this] {
+                        return m_stop || !m_tasks.empty();
+                    });
+                    if (m_tasks.empty()) return;
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+                task();
+            }
+        }
+    }; // ThreadPool
+
+}; // namespace sqlite_containers
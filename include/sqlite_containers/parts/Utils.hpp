@@ -3,9 +3,11 @@
 /// \file Utils.hpp
 /// \brief Utility functions for working with SQLite in sqlite_containers.
 
+#include "RetryPolicy.hpp"
 #include <sqlite3.h>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <chrono>
 #include <vector>
@@ -18,8 +20,13 @@
 #include <string>
 #include <cstring>
 #include <type_traits>
-
-#define SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS 50
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <random>
 
 namespace sqlite_containers {
 
@@ -41,11 +48,211 @@ namespace sqlite_containers {
         int m_error_code; // The SQLite error code
     }; // sqlite_exception
 
+    /// \brief Numbers of rows changed by a reconcile.
+    struct ReconcileStats {
+        std::size_t inserted = 0;   ///< Rows added to the table.
+        std::size_t updated = 0;    ///< Existing rows whose value was changed.
+        std::size_t removed = 0;    ///< Rows removed from the table.
+    };
+
+    /// \class BusyWaiter
+    /// \brief Applies a RetryPolicy to one connection and counts the time the connection spends waiting.
+    class BusyWaiter {
+    public:
+
+        /// \brief Constructs a waiter.
+        /// \param policy Retry policy of the connection.
+        /// \param busy_timeout_ms Time in milliseconds the busy handler retries a step before SQLite gives up.
+        BusyWaiter(const RetryPolicy &policy, const int &busy_timeout_ms) :
+            m_policy(policy), m_busy_timeout_ms(std::max(busy_timeout_ms, 0)) {}
+
+        /// \brief Waits before a retry.
+        /// \param attempt Number of retries already made by the operation.
+        /// \param start Time the operation first found the database busy.
+        /// \param deadline_ms Time limit in milliseconds counted from `start`; negative waits forever.
+        /// \return False, without waiting, once the policy gives up.
+        bool wait(const int &attempt, const std::chrono::steady_clock::time_point &start, const int &deadline_ms) {
+            using namespace std::chrono;
+            const auto now = steady_clock::now();
+            int64_t delay_us = next_delay(attempt);
+            if (delay_us >= 0 && deadline_ms >= 0) {
+                const int64_t left_us = static_cast<int64_t>(deadline_ms) * 1000 - duration_cast<microseconds>(now - start).count();
+                delay_us = left_us > 0 ? std::min(delay_us, left_us) : -1;
+            }
+            if (delay_us < 0) {
+                m_timeouts.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (delay_us == 0) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(microseconds(delay_us));
+            }
+            m_retries.fetch_add(1, std::memory_order_relaxed);
+            m_wait_us.fetch_add(duration_cast<microseconds>(steady_clock::now() - now).count(), std::memory_order_relaxed);
+            return true;
+        }
+
+        /// \brief Busy handler installed with `sqlite3_busy_handler()`.
+        /// \param arg Pointer to the waiter.
+        /// \param count Number of times the handler was called for the current lock.
+        /// \return Nonzero to retry, zero to return SQLITE_BUSY.
+        static int busy_handler(void *arg, int count) {
+            BusyWaiter *waiter = static_cast<BusyWaiter*>(arg);
+            if (count == 0) waiter->m_handler_start = std::chrono::steady_clock::now();
+            try {
+                return waiter->wait(count, waiter->m_handler_start, waiter->m_busy_timeout_ms) ? 1 : 0;
+            } catch (...) {
+                return 0;
+            }
+        }
+
+        /// \brief Returns the retry policy.
+        const RetryPolicy &policy() const noexcept {
+            return m_policy;
+        }
+
+        /// \brief Returns the time spent waiting so far.
+        BusyStats stats() const noexcept {
+            BusyStats stats;
+            stats.retries = m_retries.load(std::memory_order_relaxed);
+            stats.wait_us = m_wait_us.load(std::memory_order_relaxed);
+            stats.timeouts = m_timeouts.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+        RetryPolicy             m_policy;           ///< Retry policy of the connection.
+        int                     m_busy_timeout_ms;  ///< Time limit of the busy handler.
+        std::chrono::steady_clock::time_point m_handler_start; ///< Time the busy handler was first called for the current lock.
+        std::atomic<uint64_t>   m_retries = ATOMIC_VAR_INIT(0);  ///< Number of waits.
+        std::atomic<uint64_t>   m_wait_us = ATOMIC_VAR_INIT(0);  ///< Total time spent waiting.
+        std::atomic<uint64_t>   m_timeouts = ATOMIC_VAR_INIT(0); ///< Number of waits that gave up.
+
+        /// \brief Returns the delay in microseconds before a retry, or a negative value to stop.
+        int64_t next_delay(const int &attempt) const {
+            if (m_policy.delay_func) return m_policy.delay_func(attempt);
+            if (attempt < m_policy.spin_count) return 0;
+            const double exponent = static_cast<double>(attempt - std::max(m_policy.spin_count, 0));
+            double delay = static_cast<double>(m_policy.initial_delay_us) * std::pow(std::max(m_policy.multiplier, 1.0), exponent);
+            delay = std::min(delay, static_cast<double>(m_policy.max_delay_us));
+            const double jitter = std::min(std::max(m_policy.jitter, 0.0), 1.0);
+            if (jitter > 0.0) {
+                thread_local std::minstd_rand engine(std::random_device{}());
+                std::uniform_real_distribution<double> distribution(0.0, jitter);
+                delay *= 1.0 - distribution(engine);
+            }
+            return std::max<int64_t>(static_cast<int64_t>(delay), 1);
+        }
+    }; // BusyWaiter
+
+    /// \brief Returns the waiters of the connections, indexed by connection.
+    inline std::unordered_map<sqlite3*, std::shared_ptr<BusyWaiter>> &busy_waiters(std::unique_lock<std::mutex> &locker) {
+        static std::mutex mutex;
+        static std::unordered_map<sqlite3*, std::shared_ptr<BusyWaiter>> waiters;
+        locker = std::unique_lock<std::mutex>(mutex);
+        return waiters;
+    }
+
+    /// \brief Installs the busy handler of a retry policy on a connection, replacing `PRAGMA busy_timeout`.
+    /// \param sqlite_db Pointer to the SQLite database.
+    /// \param policy Retry policy of the connection.
+    /// \param busy_timeout_ms Time in milliseconds the busy handler retries a step before SQLite gives up.
+    /// \throws sqlite_exception if the handler cannot be installed.
+    inline void set_busy_policy(sqlite3 *sqlite_db, const RetryPolicy &policy, const int &busy_timeout_ms) {
+        auto waiter = std::make_shared<BusyWaiter>(policy, busy_timeout_ms);
+        std::unique_lock<std::mutex> locker;
+        auto &waiters = busy_waiters(locker);
+        const int err = sqlite3_busy_handler(sqlite_db, &BusyWaiter::busy_handler, waiter.get());
+        if (err != SQLITE_OK) {
+            throw sqlite_exception("Failed to install the busy handler. Error code: " + std::to_string(err), err);
+        }
+        waiters[sqlite_db] = std::move(waiter);
+    }
+
+    /// \brief Removes the busy handler of a connection before it is closed.
+    /// \param sqlite_db Pointer to the SQLite database.
+    inline void clear_busy_policy(sqlite3 *sqlite_db) noexcept {
+        if (!sqlite_db) return;
+        std::unique_lock<std::mutex> locker;
+        auto &waiters = busy_waiters(locker);
+        auto it = waiters.find(sqlite_db);
+        if (it == waiters.end()) return;
+        sqlite3_busy_handler(sqlite_db, nullptr, nullptr);
+        waiters.erase(it);
+    }
+
+    /// \brief Returns the waiter of a connection.
+    /// \param sqlite_db Pointer to the SQLite database.
+    /// \return The waiter, or a waiter with the default policy if none was installed.
+    inline std::shared_ptr<BusyWaiter> get_busy_waiter(sqlite3 *sqlite_db) {
+        {
+            std::unique_lock<std::mutex> locker;
+            auto &waiters = busy_waiters(locker);
+            auto it = waiters.find(sqlite_db);
+            if (it != waiters.end()) return it->second;
+        }
+        static const std::shared_ptr<BusyWaiter> default_waiter = std::make_shared<BusyWaiter>(RetryPolicy(), 0);
+        return default_waiter;
+    }
+
+    /// \brief Returns the time a connection has spent waiting for a busy database.
+    /// \param sqlite_db Pointer to the SQLite database.
+    inline BusyStats get_busy_stats(sqlite3 *sqlite_db) {
+        std::unique_lock<std::mutex> locker;
+        auto &waiters = busy_waiters(locker);
+        auto it = waiters.find(sqlite_db);
+        return it == waiters.end() ? BusyStats() : it->second->stats();
+    }
+
+    /// \brief Adds the counters of one BusyStats to another.
+    inline BusyStats &operator+=(BusyStats &stats, const BusyStats &other) noexcept {
+        stats.retries += other.retries;
+        stats.wait_us += other.wait_us;
+        stats.timeouts += other.timeouts;
+        return stats;
+    }
+
+    /// \class BusyRetry
+    /// \brief Waits between the restarts of one operation that found the database busy.
+    /// \details Looks the connection up only once the database is found busy, so operations that never wait
+    /// pay nothing for it.
+    class BusyRetry {
+    public:
+
+        /// \brief Constructs the retry state of an operation.
+        /// \param sqlite_db Pointer to the SQLite database.
+        explicit BusyRetry(sqlite3 *sqlite_db) noexcept : m_sqlite_db(sqlite_db) {}
+
+        /// \brief Waits before the next restart of the operation.
+        /// \throws sqlite_exception with SQLITE_BUSY once `RetryPolicy::deadline_ms` has passed.
+        void wait() {
+            if (!m_waiter) {
+                m_waiter = get_busy_waiter(m_sqlite_db);
+                m_start = std::chrono::steady_clock::now();
+            }
+            if (m_waiter->wait(m_attempt++, m_start, m_waiter->policy().deadline_ms)) return;
+            std::string err_msg = "Database is busy, retry deadline exceeded";
+            if (m_sqlite_db) {
+                err_msg += ": ";
+                err_msg += sqlite3_errmsg(m_sqlite_db);
+            }
+            throw sqlite_exception(err_msg, SQLITE_BUSY);
+        }
+
+    private:
+        sqlite3*                    m_sqlite_db;    ///< Pointer to the SQLite database.
+        std::shared_ptr<BusyWaiter> m_waiter;       ///< Waiter of the connection, looked up on the first wait.
+        std::chrono::steady_clock::time_point m_start; ///< Time of the first wait.
+        int                         m_attempt = 0;  ///< Number of waits so far.
+    }; // BusyRetry
+
     /// \brief Executes a SQLite statement.
     /// \param stmt Pointer to the SQLite statement.
     /// \throws sqlite_exception if statement is null, or if an error occurs during execution.
     inline void execute(sqlite3_stmt *stmt) {
         if (!stmt) throw sqlite_exception("Invalid statement pointer.");
+        BusyRetry busy_retry(sqlite3_db_handle(stmt));
         int err;
         for (;;) {
             while ((err = sqlite3_step(stmt)) == SQLITE_ROW);
@@ -53,14 +260,14 @@ namespace sqlite_containers {
             case SQLITE_DONE:
                 return;
             case SQLITE_BUSY:
-                sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                busy_retry.wait();
                 continue;
             case SQLITE_FULL:
                 throw sqlite_exception("Disk full or IO error.", err);
             case SQLITE_IOERR:
                 throw sqlite_exception("Failed to insert data into database.", err);
             default:
-                throw sqlite_exception("SQLite error.", err);
+                throw sqlite_exception("SQLite error: " + std::string(sqlite3_errmsg(sqlite3_db_handle(stmt))) + ". Error code: " + std::to_string(err), err);
             }
         }
     }
@@ -71,6 +278,7 @@ namespace sqlite_containers {
     /// \throws sqlite_exception if the database or statement is null, or if an error occurs during execution.
     inline void execute(sqlite3 *sqlite_db, sqlite3_stmt *stmt) {
         if (!sqlite_db || !stmt) throw sqlite_exception("Invalid database or statement pointer.");
+        BusyRetry busy_retry(sqlite_db);
         int err;
         for (;;) {
             while ((err = sqlite3_step(stmt)) == SQLITE_ROW);
@@ -78,7 +286,7 @@ namespace sqlite_containers {
             case SQLITE_DONE:
                 return;
             case SQLITE_BUSY:
-                sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                busy_retry.wait();
                 continue;
             case SQLITE_FULL:
                 throw sqlite_exception("Disk full or IO error: " + std::string(sqlite3_errmsg(sqlite_db)) + ". Error code: " + std::to_string(err), err);
@@ -97,11 +305,12 @@ namespace sqlite_containers {
     inline void execute(sqlite3 *sqlite_db, const char *query) {
         if (!sqlite_db) throw sqlite_exception("Invalid database pointer.");
         if (!query || std::strlen(query) == 0) throw sqlite_exception("Empty SQL request.");
+        BusyRetry busy_retry(sqlite_db);
         int err;
         do {
             err = sqlite3_exec(sqlite_db, query, nullptr, nullptr, nullptr);
             if (err == SQLITE_BUSY) {
-                sqlite3_sleep(SQLITE_CONTAINERS_BUSY_RETRY_DELAY_MS);
+                busy_retry.wait();
             } else
             if (err != SQLITE_OK) {
                 std::string err_msg = "SQLite error during prepare: ";
@@ -121,151 +330,119 @@ namespace sqlite_containers {
         execute(sqlite_db, query.c_str());
     }
 
+    /// \brief Checks whether a table has a rowid, i.e. was not created `WITHOUT ROWID`.
+    /// \param sqlite_db Pointer to the SQLite database.
+    /// \param table_name Name of the table.
+    /// \return True if the rowid of the table can be selected.
+    inline bool has_rowid(sqlite3 *sqlite_db, const std::string &table_name) {
+        sqlite3_stmt* stmt = nullptr;
+        const std::string query = "SELECT rowid FROM " + table_name + " LIMIT 0;";
+        const int err = sqlite3_prepare_v2(sqlite_db, query.c_str(), -1, &stmt, nullptr);
+        sqlite3_finalize(stmt);
+        return err == SQLITE_OK;
+    }
+
 //------------------------------------------------------------------------------
 
-    /// \brief Gets the SQLite data type as a string for the given type.
-    /// \tparam T The type for which SQLite data type is queried.
-    /// \return The SQLite data type as a string.
-    template<typename T>
-    inline std::string get_sqlite_type(
-            typename std::enable_if<std::is_integral<T>::value>::type* = 0) {
-        return "INTEGER";
-    }
+    /// \brief Checks whether a container is associative (set, map and their multi and unordered variants).
+    /// Containers without a `key_type`, such as list, vector or deque, are treated as sequences.
+    template<class ContainerT, class = void>
+    struct is_associative_container : std::false_type {};
 
-    template<typename T>
-    inline std::string get_sqlite_type(
-            typename std::enable_if<std::is_floating_point<T>::value>::type* = 0) {
-        return "REAL";
-    }
+    template<class ContainerT>
+    struct is_associative_container<ContainerT, std::void_t<typename ContainerT::key_type>> : std::true_type {};
 
-    template<typename T>
-    inline std::string get_sqlite_type(
-            typename std::enable_if<std::is_same<T, std::string>::value>::type* = 0) {
-        return "TEXT";
-    }
+    /// \brief Checks whether an associative container keeps equal keys (multiset, multimap and their unordered variants).
+    /// These containers return an iterator rather than a pair from `insert()`.
+    template<class ContainerT, class = void>
+    struct is_multi_container : std::false_type {};
 
-    template<typename T>
-    inline std::string get_sqlite_type(
-            typename std::enable_if<
-                !std::is_integral<T>::value &&
-                !std::is_floating_point<T>::value &&
-                std::is_trivially_copyable<T>::value>::type* = 0) {
-        return "BLOB";
-    }
+    template<class ContainerT>
+    struct is_multi_container<ContainerT, std::void_t<typename ContainerT::key_type>> : std::is_same<
+        decltype(std::declval<ContainerT&>().insert(std::declval<const typename ContainerT::value_type&>())),
+        typename ContainerT::iterator> {};
 
-    template<typename T>
-    inline typename std::enable_if<
-        std::is_trivially_copyable<
-            typename T::value_type>::value &&
-            std::is_same<T, std::vector<typename T::value_type>>::value,
-            std::string
-        >::type get_sqlite_type() {
-        return "BLOB";
-    }
+    /// \brief Checks whether a container supports `reserve()` (vector, unordered and flat containers).
+    template<class ContainerT, class = void>
+    struct has_reserve : std::false_type {};
 
-    template<typename T>
-    inline typename std::enable_if<
-        std::is_trivially_copyable<
-            typename T::value_type>::value &&
-            std::is_same<T, std::deque<typename T::value_type>>::value,
-            std::string
-        >::type get_sqlite_type() {
-        return "BLOB";
-    }
+    template<class ContainerT>
+    struct has_reserve<ContainerT, std::void_t<decltype(std::declval<ContainerT&>().reserve(std::size_t()))>> : std::true_type {};
 
-//------------------------------------------------------------------------------
+    /// \brief Checks whether a container hashes its keys (unordered_set, unordered_map and their variants).
+    template<class ContainerT, class = void>
+    struct is_hashed_container : std::false_type {};
 
-    /// \brief Adds a value to a container (set or unordered_set).
-    /// \tparam ContainerT The type of container (set or unordered_set).
-    /// \tparam T The type of value to add.
-    /// \param container The container to which the value will be added.
-    /// \param value The value to add.
-    template<template <class...> class ContainerT, class T>
-    inline void add_value(ContainerT<T> &container, T &value,
-            typename std::enable_if<
-                std::is_same<ContainerT<T>, std::set<T>>::value ||
-                std::is_same<ContainerT<T>, std::unordered_set<T>>::value>::type* = 0) {
-        container.insert(std::move(value));
-    }
+    template<class ContainerT>
+    struct is_hashed_container<ContainerT, std::void_t<typename ContainerT::hasher>> : std::true_type {};
 
-    /// \brief Adds a value to a container (multiset or unordered_multiset).
-    /// \tparam ContainerT The type of container (multiset or unordered_multiset).
-    /// \tparam T The type of value to add.
-    /// \param container The container to which the value will be added.
-    /// \param value The value to add.
-    /// \param value_count Number of times to add the value (default is 0, meaning add once).
-    template<template <class...> class ContainerT, class T>
-    inline void add_value(ContainerT<T> &container, const T &value, const size_t& value_count = 0,
-            typename std::enable_if<
-                std::is_same<ContainerT<T>, std::multiset<T>>::value ||
-                std::is_same<ContainerT<T>, std::unordered_multiset<T>>::value>::type* = 0) {
-        for (size_t i = 0; i < value_count; ++i) {
-            container.insert(value);
-        }
-    }
+    /// \brief Checks whether a container is best filled with rows in key order.
+    /// True for sequences (vector, deque, list), which then hold the rows sorted by key, and for flat sorted
+    /// containers (ordered associative containers with `reserve()`, such as `boost::container::flat_map`),
+    /// which then only append instead of shifting their elements.
+    template<class ContainerT>
+    struct is_sorted_load_target : std::integral_constant<bool,
+        !is_associative_container<ContainerT>::value ||
+        (has_reserve<ContainerT>::value && !is_hashed_container<ContainerT>::value)> {};
 
-    /// \brief Adds a value to a container (list, vector, or deque).
-    /// \tparam ContainerT The type of container (list, vector, or deque).
-    /// \tparam T The type of value to add.
-    /// \param container The container to which the value will be added.
-    /// \param value The value to add.
-    template<template <class...> class ContainerT, class T>
-    inline void add_value(ContainerT<T> &container, T &value,
-            typename std::enable_if<
-                std::is_same<ContainerT<T>, std::list<T>>::value ||
-                std::is_same<ContainerT<T>, std::vector<T>>::value ||
-                std::is_same<ContainerT<T>, std::deque<T>>::value>::type* = 0) {
-        container.emplace(container.end(), std::move(value));
+    /// \brief Adds a row read from the database to a container.
+    /// Sequences append the row and flat sorted containers insert it with a hint at their end, so rows read in key
+    /// order are appended without a search; other containers insert it as usual.
+    /// \param container The container.
+    /// \param args Arguments constructing the element.
+    template<class ContainerT, class... Args>
+    inline void emplace_row(ContainerT& container, Args&&... args) {
+        if constexpr (!is_associative_container<ContainerT>::value) {
+            container.emplace(container.end(), std::forward<Args>(args)...);
+        } else
+        if constexpr (is_sorted_load_target<ContainerT>::value) {
+            container.emplace_hint(container.end(), std::forward<Args>(args)...);
+        } else {
+            container.emplace(std::forward<Args>(args)...);
+        }
     }
 
-    /// \brief Adds a value to a container (list, vector, or deque).
-    /// \tparam ContainerT The type of container (list, vector, or deque).
+    /// \brief Adds a value to a container (set, multiset, list, vector, deque or their variants).
+    /// Any comparator, hash or allocator is accepted, e.g. `std::pmr::set`.
+    /// \tparam ContainerT The type of container.
     /// \tparam T The type of value to add.
     /// \param container The container to which the value will be added.
-    /// \param value The value to add.
-    /// \param value_count Number of times to add the value (default is 0, meaning add once).
-    template<template <class...> class ContainerT, class T>
-    inline void add_value(ContainerT<T> &container, const T &value, const size_t& value_count,
-            typename std::enable_if<
-                std::is_same<ContainerT<T>, std::list<T>>::value ||
-                std::is_same<ContainerT<T>, std::vector<T>>::value ||
-                std::is_same<ContainerT<T>, std::deque<T>>::value>::type* = 0) {
-        for (size_t i = 0; i < value_count; ++i) {
-            container.emplace(container.end(), value);
-        }
+    /// \param value The value to add; it is moved into the container.
+    template<class ContainerT, class T>
+    inline void add_value(ContainerT &container, T &value) {
+        emplace_row(container, std::move(value));
     }
 
-    /// \brief Adds a value to a container (std::set).
-    /// \tparam ContainerT The type of container (std::set).
+    /// \brief Adds a value to a container a number of times (set, multiset, list, vector, deque or their variants).
+    /// Containers with unique keys receive the value once.
+    /// \tparam ContainerT The type of container.
     /// \tparam T The type of value to add.
     /// \param container The container to which the value will be added.
     /// \param value The value to add.
-    /// \param value_count Number of times to add the value (default is 0, meaning add once).
-    template<template <class...> class ContainerT, class T>
-    inline void add_value(ContainerT<T> &container, const T &value, const size_t& value_count,
-            typename std::enable_if<
-                std::is_same<ContainerT<T>, std::set<T>>::value ||
-                std::is_same<ContainerT<T>, std::multiset<T>>::value ||
-                std::is_same<ContainerT<T>, std::unordered_set<T>>::value ||
-                std::is_same<ContainerT<T>, std::unordered_multiset<T>>::value>::type* = 0) {
-        for (size_t i = 0; i < value_count; ++i) {
-            container.emplace(value);
+    /// \param value_count Number of times to add the value.
+    template<class ContainerT, class T>
+    inline void add_value(ContainerT &container, const T &value, const size_t& value_count) {
+        if constexpr (is_associative_container<ContainerT>::value) {
+            const size_t count = is_multi_container<ContainerT>::value ? value_count : std::min<size_t>(value_count, 1);
+            for (size_t i = 0; i < count; ++i) {
+                container.emplace(value);
+            }
+        } else {
+            container.insert(container.end(), value_count, value);
         }
     }
 
-    /// \brief Adds a key-value pair to a container (multimap or unordered_multimap).
-    /// \tparam ContainerT The type of container (multimap or unordered_multimap).
+    /// \brief Adds a key-value pair to a container a number of times (multimap, unordered_multimap or their variants).
+    /// \tparam ContainerT The type of container.
     /// \tparam KeyT The type of key.
     /// \tparam ValueT The type of value.
     /// \param container The container to which the key-value pair will be added.
     /// \param key The key to add.
     /// \param value The value to add.
-    /// \param value_count Number of times to add the key-value pair (default is 0, meaning add once).
-    template <template <class...> class ContainerT, typename KeyT, typename ValueT>
-    inline void add_value(ContainerT<KeyT, ValueT> &container, KeyT& key, ValueT& value, const size_t& value_count,
-        typename std::enable_if<
-            std::is_same<ContainerT<KeyT, ValueT>, std::multimap<KeyT, ValueT>>::value ||
-            std::is_same<ContainerT<KeyT, ValueT>, std::unordered_multimap<KeyT, ValueT>>::value>::type* = 0) {
+    /// \param value_count Number of times to add the key-value pair.
+    template<class ContainerT, typename KeyT, typename ValueT>
+    inline void add_value(ContainerT &container, KeyT& key, ValueT& value, const size_t& value_count) {
+        static_assert(is_multi_container<ContainerT>::value, "Key-value pairs are loaded into a multimap or unordered_multimap.");
         for (size_t i = 0; i < value_count; ++i) {
             container.emplace(key, value);
         }
@@ -333,6 +510,52 @@ namespace sqlite_containers {
         return values;
     }
 
+//------------------------------------------------------------------------------
+
+    /// \brief Calls a visitor that may return void or bool.
+    /// \tparam Func Type of the visitor.
+    /// \tparam Args Types of the arguments.
+    /// \param visitor The visitor to call.
+    /// \param args Arguments passed to the visitor.
+    /// \return The result of the visitor, or true if it returns void.
+    template<typename Func, typename... Args>
+    inline bool invoke_visitor(Func& visitor, const Args&... args) {
+        if constexpr (std::is_void<decltype(visitor(args...))>::value) {
+            visitor(args...);
+            return true;
+        } else {
+            return static_cast<bool>(visitor(args...));
+        }
+    }
+
+    /// \brief Reserves capacity in containers that support it (vector, unordered_map, ...).
+    /// \param container The container.
+    /// \param size Number of elements to reserve room for.
+    template<typename ContainerT>
+    inline auto reserve_capacity(ContainerT& container, const std::size_t& size, int)
+            -> decltype(container.reserve(size), void()) {
+        container.reserve(size);
+    }
+
+    /// \brief Overload for containers without `reserve()`; does nothing.
+    template<typename ContainerT>
+    inline void reserve_capacity(ContainerT&, const std::size_t&, long) {}
+
+    /// \brief Reserves capacity in a container if it supports `reserve()`.
+    /// \param container The container.
+    /// \param size Number of elements to reserve room for.
+    template<typename ContainerT>
+    inline void reserve_capacity(ContainerT& container, const std::size_t& size) {
+        reserve_capacity(container, size, 0);
+    }
+
+    /// \brief Converts a row limit to the value bound to `LIMIT ?`.
+    /// \param limit Maximum number of rows; 0 means no limit.
+    /// \return The limit, or -1 (no limit in SQLite) if `limit` is 0.
+    inline int64_t to_sql_limit(const std::size_t& limit) noexcept {
+        return limit == 0 ? -1 : static_cast<int64_t>(limit);
+    }
+
 //------------------------------------------------------------------------------
 
     template <typename T>
@@ -340,4 +563,47 @@ namespace sqlite_containers {
         return std::memcmp(&a, &b, sizeof(T)) == 0;
     }
 
+    /// \brief Hash function for the key and value types stored by the containers.
+    /// Types without a more specific hash use `std::hash`.
+    /// \tparam T The type of value to hash.
+    template<typename T, typename Enable = void>
+    struct Hash : std::hash<T> {};
+
+    /// \brief Hash function for trivially copyable structures.
+    /// The structure is hashed by its bytes, consistent with `byte_compare`.
+    template<typename T>
+    struct Hash<T, typename std::enable_if<
+            std::is_trivially_copyable<T>::value &&
+            !std::is_arithmetic<T>::value>::type> {
+        std::size_t operator()(const T& value) const noexcept {
+            return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(&value), sizeof(T)));
+        }
+    };
+
+    /// \brief Hash function for BLOB values (vectors of trivially copyable elements), hashed by their bytes.
+    template<typename T>
+    struct Hash<std::vector<T>, typename std::enable_if<
+            std::is_trivially_copyable<T>::value &&
+            !std::is_same<T, bool>::value>::type> {
+        std::size_t operator()(const std::vector<T>& value) const noexcept {
+            return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(T)));
+        }
+    };
+
+    /// \brief Equality predicate matching `Hash`.
+    /// Types without a more specific predicate are compared with `operator==`.
+    /// \tparam T The type of values to compare.
+    template<typename T, typename Enable = void>
+    struct EqualTo : std::equal_to<T> {};
+
+    /// \brief Equality predicate for trivially copyable structures, compared with `byte_compare`.
+    template<typename T>
+    struct EqualTo<T, typename std::enable_if<
+            std::is_trivially_copyable<T>::value &&
+            !std::is_arithmetic<T>::value>::type> {
+        bool operator()(const T& a, const T& b) const noexcept {
+            return byte_compare(a, b);
+        }
+    };
+
 }; // namespace sqlite_containers
@@ -0,0 +1,241 @@
+#pragma once
+
+/// \file ValueStore.hpp
+/// \brief SQL functions that compress and fingerprint stored values (see `Config::value_compression_level`
+/// and `Config::dedup_values`).
+
+#include "Utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#ifdef SQLITE_CONTAINERS_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace sqlite_containers {
+
+    /// \brief Computes the SHA-256 digest of a byte range.
+    /// \param data Pointer to the bytes.
+    /// \param size Number of bytes.
+    /// \return The 32-byte digest.
+    inline std::array<uint8_t, 32> sha256(const void* data, const std::size_t& size) noexcept {
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+        uint32_t h[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+        auto rotr = [](const uint32_t x, const int n) {
+            return (x >> n) | (x << (32 - n));
+        };
+        auto compress = [&](const uint8_t* block) {
+            uint32_t w[64];
+            for (int i = 0; i < 16; ++i) {
+                w[i] = (uint32_t(block[4 * i]) << 24) | (uint32_t(block[4 * i + 1]) << 16) |
+                       (uint32_t(block[4 * i + 2]) << 8) | uint32_t(block[4 * i + 3]);
+            }
+            for (int i = 16; i < 64; ++i) {
+                const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+            uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+            for (int i = 0; i < 64; ++i) {
+                const uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+                const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                hh = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+            h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+            h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+        };
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        std::size_t offset = 0;
+        for (; offset + 64 <= size; offset += 64) {
+            compress(bytes + offset);
+        }
+
+        // Pad the tail with 0x80, zeros and the message length in bits
+        uint8_t tail[128] = {};
+        const std::size_t rest = size - offset;
+        if (rest) std::memcpy(tail, bytes + offset, rest);
+        tail[rest] = 0x80;
+        const std::size_t tail_size = rest < 56 ? 64 : 128;
+        const uint64_t bits = static_cast<uint64_t>(size) * 8;
+        for (int i = 0; i < 8; ++i) {
+            tail[tail_size - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+        compress(tail);
+        if (tail_size == 128) compress(tail + 64);
+
+        std::array<uint8_t, 32> digest;
+        for (int i = 0; i < 8; ++i) {
+            digest[4 * i]     = static_cast<uint8_t>(h[i] >> 24);
+            digest[4 * i + 1] = static_cast<uint8_t>(h[i] >> 16);
+            digest[4 * i + 2] = static_cast<uint8_t>(h[i] >> 8);
+            digest[4 * i + 3] = static_cast<uint8_t>(h[i]);
+        }
+        return digest;
+    }
+
+    /// \brief Storage methods of a compressed value frame.
+    enum class ValueFrameMethod : uint8_t {
+        STORED  = 0,    ///< The payload is the original bytes.
+        ZLIB    = 1,    ///< The payload is a zlib stream.
+    };
+
+    /// \brief Size of the header of a compressed value frame.
+    /// The header holds the storage method, the original SQLite type (`SQLITE_TEXT` or `SQLITE_BLOB`) and the
+    /// original size as a big-endian 32-bit integer.
+    constexpr std::size_t VALUE_FRAME_HEADER_SIZE = 6;
+
+    /// \brief SQL function `sc_deflate(value, level)`.
+    /// Turns TEXT and BLOB values into a frame compressed by zlib at the given level. Values that do not shrink
+    /// are stored as is within the frame. Other values are returned unchanged.
+    inline void sql_deflate_value(sqlite3_context* ctx, int, sqlite3_value** argv) {
+        const int type = sqlite3_value_type(argv[0]);
+        if (type != SQLITE_TEXT && type != SQLITE_BLOB) {
+            sqlite3_result_value(ctx, argv[0]);
+            return;
+        }
+        const void* data = type == SQLITE_TEXT
+            ? static_cast<const void*>(sqlite3_value_text(argv[0]))
+            : sqlite3_value_blob(argv[0]);
+        const std::size_t size = static_cast<std::size_t>(sqlite3_value_bytes(argv[0]));
+        const int level = sqlite3_value_int(argv[1]);
+
+        std::size_t capacity = VALUE_FRAME_HEADER_SIZE + size;
+#       ifdef SQLITE_CONTAINERS_USE_ZLIB
+        const uLong bound = compressBound(static_cast<uLong>(size));
+        if (level > 0) capacity = std::max<std::size_t>(capacity, VALUE_FRAME_HEADER_SIZE + bound);
+#       endif
+        uint8_t* frame = static_cast<uint8_t*>(sqlite3_malloc64(capacity));
+        if (!frame) {
+            sqlite3_result_error_nomem(ctx);
+            return;
+        }
+        frame[0] = static_cast<uint8_t>(ValueFrameMethod::STORED);
+        frame[1] = static_cast<uint8_t>(type);
+        for (int i = 0; i < 4; ++i) {
+            frame[2 + i] = static_cast<uint8_t>(static_cast<uint32_t>(size) >> (24 - 8 * i));
+        }
+        std::size_t frame_size = VALUE_FRAME_HEADER_SIZE + size;
+#       ifdef SQLITE_CONTAINERS_USE_ZLIB
+        if (level > 0 && size > 0) {
+            uLongf packed_size = bound;
+            if (compress2(frame + VALUE_FRAME_HEADER_SIZE, &packed_size,
+                          static_cast<const Bytef*>(data), static_cast<uLong>(size), level) == Z_OK &&
+                packed_size < size) {
+                frame[0] = static_cast<uint8_t>(ValueFrameMethod::ZLIB);
+                frame_size = VALUE_FRAME_HEADER_SIZE + packed_size;
+            }
+        }
+#       else
+        (void)level;
+#       endif
+        if (frame[0] == static_cast<uint8_t>(ValueFrameMethod::STORED) && size) {
+            std::memcpy(frame + VALUE_FRAME_HEADER_SIZE, data, size);
+        }
+        sqlite3_result_blob64(ctx, frame, frame_size, sqlite3_free);
+    }
+
+    /// \brief SQL function `sc_inflate(frame)`.
+    /// Restores the value of a frame made by `sc_deflate()` with its original type. Values that are not
+    /// BLOBs are returned unchanged.
+    inline void sql_inflate_value(sqlite3_context* ctx, int, sqlite3_value** argv) {
+        if (sqlite3_value_type(argv[0]) != SQLITE_BLOB) {
+            sqlite3_result_value(ctx, argv[0]);
+            return;
+        }
+        const uint8_t* frame = static_cast<const uint8_t*>(sqlite3_value_blob(argv[0]));
+        const std::size_t frame_size = static_cast<std::size_t>(sqlite3_value_bytes(argv[0]));
+        if (frame_size < VALUE_FRAME_HEADER_SIZE || (frame[1] != SQLITE_TEXT && frame[1] != SQLITE_BLOB)) {
+            sqlite3_result_error(ctx, "Invalid compressed value.", -1);
+            return;
+        }
+        const std::size_t size =
+            (std::size_t(frame[2]) << 24) | (std::size_t(frame[3]) << 16) |
+            (std::size_t(frame[4]) << 8) | std::size_t(frame[5]);
+        const uint8_t* payload = frame + VALUE_FRAME_HEADER_SIZE;
+        const std::size_t payload_size = frame_size - VALUE_FRAME_HEADER_SIZE;
+
+        // Text results get a terminating zero, which SQLite can then use without a copy
+        uint8_t* value = static_cast<uint8_t*>(sqlite3_malloc64(size + 1));
+        if (!value) {
+            sqlite3_result_error_nomem(ctx);
+            return;
+        }
+        switch (static_cast<ValueFrameMethod>(frame[0])) {
+        case ValueFrameMethod::STORED:
+            if (payload_size != size) {
+                sqlite3_free(value);
+                sqlite3_result_error(ctx, "Invalid compressed value.", -1);
+                return;
+            }
+            if (size) std::memcpy(value, payload, size);
+            break;
+        case ValueFrameMethod::ZLIB: {
+#           ifdef SQLITE_CONTAINERS_USE_ZLIB
+            uLongf unpacked_size = static_cast<uLongf>(size);
+            if (uncompress(value, &unpacked_size, payload, static_cast<uLong>(payload_size)) != Z_OK ||
+                unpacked_size != size) {
+                sqlite3_free(value);
+                sqlite3_result_error(ctx, "Invalid compressed value.", -1);
+                return;
+            }
+            break;
+#           else
+            sqlite3_free(value);
+            sqlite3_result_error(ctx, "The value is compressed by zlib, but SQLITE_CONTAINERS_USE_ZLIB is not defined.", -1);
+            return;
+#           endif
+        }
+        default:
+            sqlite3_free(value);
+            sqlite3_result_error(ctx, "Invalid compressed value.", -1);
+            return;
+        }
+        value[size] = 0;
+        if (frame[1] == SQLITE_TEXT) {
+            sqlite3_result_text64(ctx, reinterpret_cast<const char*>(value), size, sqlite3_free, SQLITE_UTF8);
+        } else {
+            sqlite3_result_blob64(ctx, value, size, sqlite3_free);
+        }
+    }
+
+    /// \brief SQL function `sc_digest(value)`.
+    /// Returns the SHA-256 digest of the bytes of a TEXT or BLOB value as a 32-byte BLOB. Other values are
+    /// hashed by their text representation.
+    inline void sql_digest_value(sqlite3_context* ctx, int, sqlite3_value** argv) {
+        const void* data = sqlite3_value_type(argv[0]) == SQLITE_BLOB
+            ? sqlite3_value_blob(argv[0])
+            : static_cast<const void*>(sqlite3_value_text(argv[0]));
+        const std::size_t size = static_cast<std::size_t>(sqlite3_value_bytes(argv[0]));
+        const std::array<uint8_t, 32> digest = sha256(data, size);
+        sqlite3_result_blob(ctx, digest.data(), static_cast<int>(digest.size()), SQLITE_TRANSIENT);
+    }
+
+    /// \brief Registers `sc_deflate()`, `sc_inflate()` and `sc_digest()` on a connection.
+    /// \param sqlite_db The connection.
+    /// \throws sqlite_exception if a function cannot be registered.
+    inline void register_value_functions(sqlite3* sqlite_db) {
+        const int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC;
+        int err = sqlite3_create_function_v2(sqlite_db, "sc_deflate", 2, flags, nullptr, &sql_deflate_value, nullptr, nullptr, nullptr);
+        if (err == SQLITE_OK) err = sqlite3_create_function_v2(sqlite_db, "sc_inflate", 1, flags, nullptr, &sql_inflate_value, nullptr, nullptr, nullptr);
+        if (err == SQLITE_OK) err = sqlite3_create_function_v2(sqlite_db, "sc_digest", 1, flags, nullptr, &sql_digest_value, nullptr, nullptr, nullptr);
+        if (err != SQLITE_OK) {
+            throw sqlite_exception("Failed to register value functions: " + std::string(sqlite3_errmsg(sqlite_db)), err);
+        }
+    }
+
+}; // namespace sqlite_containers